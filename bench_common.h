@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+// Element counts whose working set is about 16 KiB (L1), 256 KiB (L2),
+// 4 MiB (last level cache) and 64 MiB (DRAM). BYTES is everything one item
+// reads and writes, so every benchmark sweeps the same memory levels.
+template <size_t BYTES>
+void CacheSizes(benchmark::internal::Benchmark* b)
+{
+    for (int64_t bytes : { int64_t(16) << 10, int64_t(256) << 10, int64_t(4) << 20, int64_t(64) << 20 })
+        b->Arg(bytes / int64_t(BYTES));
+}
+
@@ -0,0 +1,202 @@
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "gszauer/Quat.h"
+#include "gszauer/VecStream.h"
+
+namespace {
+
+std::vector<vec3> randomVectors(size_t count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<vec3> v(count);
+    for (auto& p : v)
+        p = vec3(dist(gen), dist(gen), dist(gen));
+    return v;
+}
+
+std::vector<float> randomParams(size_t count)
+{
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    std::vector<float> t(count);
+    for (auto& f : t)
+        f = dist(gen);
+    return t;
+}
+
+std::vector<quat> randomRotations(size_t count, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-3.f, 3.f);
+    std::vector<quat> q(count);
+    for (auto& r : q)
+        r = angleAxis(dist(gen), gszauer::normalized(vec3(dist(gen), dist(gen), 1.f)));
+    return q;
+}
+
+gszauer::Bezier<vec3> testCurve()
+{
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = vec3(-5.f, 0.f, 0.f);
+    curve.C1 = vec3(-2.f, 4.f, 0.f);
+    curve.P2 = vec3(5.f, 0.f, 0.f);
+    curve.C2 = vec3(2.f, -4.f, 1.f);
+    return curve;
+}
+
+} // namespace
+
+// one curve sampled at many parameters, how the app tessellates a plot
+static void BM_Interpolate(benchmark::State& state)
+{
+    const gszauer::Bezier<vec3> curve = testCurve();
+    const std::vector<float> t = randomParams(state.range(0));
+    std::vector<vec3> out(t.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < t.size(); ++i)
+            out[i] = gszauer::interpolate(curve, t[i]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Interpolate)->Apply(CacheSizes<sizeof(float) + sizeof(vec3)>);
+
+static void BM_InterpolateStream(benchmark::State& state)
+{
+    const gszauer::Bezier<vec3> curve = testCurve();
+    const std::vector<float> t = randomParams(state.range(0));
+    gszauer::Vec3Stream out(t.size());
+    for (auto _ : state) {
+        gszauer::interpolate(curve, t, out);
+        benchmark::DoNotOptimize(out.x());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InterpolateStream)->Apply(CacheSizes<sizeof(float) + sizeof(vec3)>);
+
+template <vec3 (*LERP)(const vec3&, const vec3&, float)>
+static void BM_VecLerp(benchmark::State& state)
+{
+    const std::vector<vec3> a = randomVectors(state.range(0), 1);
+    const std::vector<vec3> b = randomVectors(state.range(0), 2);
+    std::vector<vec3> out(a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = LERP(a[i], b[i], 0.3f);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_VecLerp, gszauer::slerp<float>)->Apply(CacheSizes<3 * sizeof(vec3)>);
+BENCHMARK_TEMPLATE(BM_VecLerp, gszauer::nlerp<float>)->Apply(CacheSizes<3 * sizeof(vec3)>);
+
+static void BM_QuatMultiply(benchmark::State& state)
+{
+    const std::vector<quat> a = randomRotations(state.range(0), 1);
+    const std::vector<quat> b = randomRotations(state.range(0), 2);
+    std::vector<quat> out(a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = a[i] * b[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuatMultiply)->Apply(CacheSizes<3 * sizeof(quat)>);
+
+static void BM_QuatRotate(benchmark::State& state)
+{
+    const quat q = randomRotations(1, 3)[0];
+    const std::vector<vec3> v = randomVectors(state.range(0), 1);
+    std::vector<vec3> out(v.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < v.size(); ++i)
+            out[i] = q * v[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuatRotate)->Apply(CacheSizes<2 * sizeof(vec3)>);
+
+static void BM_Normalized(benchmark::State& state)
+{
+    const std::vector<vec3> v = randomVectors(state.range(0), 1);
+    std::vector<vec3> out(v.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < v.size(); ++i)
+            out[i] = gszauer::normalized(v[i]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Normalized)->Apply(CacheSizes<2 * sizeof(vec3)>);
+
+// in place, so every pass after the first sees unit vectors; the kernels
+// have no data dependent branches and run at the same speed
+template <gszauer::NormalizePolicy POLICY>
+static void BM_NormalizeStream(benchmark::State& state)
+{
+    const std::vector<vec3> v = randomVectors(state.range(0), 1);
+    gszauer::Vec3Stream s;
+    gszauer::fromAoS(v, s);
+    for (auto _ : state) {
+        gszauer::normalize(s, POLICY);
+        benchmark::DoNotOptimize(s.x());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_NormalizeStream, gszauer::NormalizePolicy::Precise)->Apply(CacheSizes<2 * sizeof(vec3)>);
+BENCHMARK_TEMPLATE(BM_NormalizeStream, gszauer::NormalizePolicy::Fast)->Apply(CacheSizes<2 * sizeof(vec3)>);
+
+static void BM_Mat4Multiply(benchmark::State& state)
+{
+    const std::vector<quat> q = randomRotations(state.range(0), 1);
+    std::vector<mat4> a(q.size()), out(q.size());
+    for (size_t i = 0; i < q.size(); ++i) {
+        const vec3 x = q[i] * vec3(1.f, 0.f, 0.f);
+        const vec3 y = q[i] * vec3(0.f, 1.f, 0.f);
+        const vec3 z = q[i] * vec3(0.f, 0.f, 1.f);
+        a[i] = mat4(x.x, x.y, x.z, 0.f, y.x, y.y, y.z, 0.f, z.x, z.y, z.z, 0.f,
+            float(i), 1.f, 2.f, 1.f);
+    }
+    const std::vector<mat4> b(a.rbegin(), a.rend());
+    for (auto _ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = a[i] * b[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4Multiply)->Apply(CacheSizes<3 * sizeof(mat4)>);
+
+static void BM_Mat4MulVec4(benchmark::State& state)
+{
+    const mat4 m(
+        0.f, 2.f, 0.f, 0.f,
+        -1.f, 0.f, 0.f, 0.f,
+        0.f, 0.f, 3.f, 0.f,
+        1.f, -2.f, 3.f, 1.f);
+    std::vector<vec4> v(state.range(0)), out(v.size());
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = vec4(float(i), 1.f, -float(i), 1.f);
+    for (auto _ : state) {
+        for (size_t i = 0; i < v.size(); ++i)
+            out[i] = m * v[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat4MulVec4)->Apply(CacheSizes<2 * sizeof(vec4)>);
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "math/el_vec4.h"
+#include "math/el_transform.h"
+
+using namespace el;
+
+namespace {
+
+// rotations about z plus a translation, valid input for all three inverses
+std::vector<mat4f> randomMatrices(size_t count)
+{
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<mat4f> m(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float c = dist(gen), s = std::sqrt(1.f - c * c);
+        m[i] = mat4f::translation(float3(dist(gen), dist(gen), dist(gen))) * mat4f(
+            c, s, 0.f, 0.f,
+            -s, c, 0.f, 0.f,
+            0.f, 0.f, 1.f, 0.f,
+            0.f, 0.f, 0.f, 1.f);
+    }
+    return m;
+}
+
+std::vector<float3> randomPoints(size_t count)
+{
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    std::vector<float3> p(count);
+    for (auto& v : p)
+        v = float3(dist(gen), dist(gen), dist(gen));
+    return p;
+}
+
+} // namespace
+
+static void BM_Mat44Multiply(benchmark::State& state)
+{
+    const std::vector<mat4f> a = randomMatrices(state.range(0));
+    std::vector<mat4f> b(a.rbegin(), a.rend()), out(a.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = a[i] * b[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat44Multiply)->Apply(CacheSizes<3 * sizeof(mat4f)>);
+
+static void BM_Mat44MulVec4(benchmark::State& state)
+{
+    const mat4f m = randomMatrices(1)[0];
+    std::vector<float4> v(state.range(0)), out(v.size());
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = float4(float(i), 1.f, -float(i), 1.f);
+    for (auto _ : state) {
+        for (size_t i = 0; i < v.size(); ++i)
+            out[i] = m * v[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Mat44MulVec4)->Apply(CacheSizes<2 * sizeof(float4)>);
+
+// the batch kernel through el::dispatch, AoS in and out
+static void BM_TransformPoints(benchmark::State& state)
+{
+    const mat4f m = randomMatrices(1)[0];
+    const std::vector<float3> in = randomPoints(state.range(0));
+    std::vector<float3> out(in.size());
+    for (auto _ : state) {
+        transformPoints(m, in.data(), out.data(), in.size());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformPoints)->Apply(CacheSizes<2 * sizeof(float3)>);
+
+static void BM_TransformPointsSoA(benchmark::State& state)
+{
+    const mat4f m = randomMatrices(1)[0];
+    const std::vector<float3> p = randomPoints(state.range(0));
+    std::vector<float> x(p.size()), y(p.size()), z(p.size());
+    for (size_t i = 0; i < p.size(); ++i) {
+        x[i] = p[i].x;
+        y[i] = p[i].y;
+        z[i] = p[i].z;
+    }
+    std::vector<float> ox(x.size()), oy(x.size()), oz(x.size());
+    for (auto _ : state) {
+        transformPoints(m, { x.data(), y.data(), z.data() },
+            { ox.data(), oy.data(), oz.data() }, x.size());
+        benchmark::DoNotOptimize(ox.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformPointsSoA)->Apply(CacheSizes<6 * sizeof(float)>);
+
+template <mat4f (*INVERSE)(const mat4f&)>
+static void BM_Mat44Inverse(benchmark::State& state)
+{
+    const std::vector<mat4f> in = randomMatrices(state.range(0));
+    std::vector<mat4f> out(in.size());
+    for (auto _ : state) {
+        for (size_t i = 0; i < in.size(); ++i)
+            out[i] = INVERSE(in[i]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_Mat44Inverse, details::inverse<float>)->Apply(CacheSizes<2 * sizeof(mat4f)>);
+BENCHMARK_TEMPLATE(BM_Mat44Inverse, details::affineInverse<float>)->Apply(CacheSizes<2 * sizeof(mat4f)>);
+BENCHMARK_TEMPLATE(BM_Mat44Inverse, details::rigidInverse<float>)->Apply(CacheSizes<2 * sizeof(mat4f)>);
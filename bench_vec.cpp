@@ -0,0 +1,141 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "bench_common.h"
+#include "math/el_vec4.h"
+
+using namespace el;
+
+namespace {
+
+struct Curves
+{
+    std::vector<float3> p0, p1, p2;
+    std::vector<float> t;
+    std::vector<float3> out;
+
+    explicit Curves(size_t count)
+        : p0(count), p1(count), p2(count), t(count), out(count)
+    {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (size_t i = 0; i < count; ++i) {
+            p0[i] = float3(dist(gen), dist(gen), dist(gen));
+            p1[i] = float3(dist(gen), dist(gen), dist(gen));
+            p2[i] = float3(dist(gen), dist(gen), dist(gen));
+            t[i] = dist(gen) * 0.5f + 0.5f;
+        }
+    }
+};
+
+} // namespace
+
+// the vector operators, one float3 per operator
+static void BM_QuadraticBezierEager(benchmark::State& state)
+{
+    Curves c(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < c.t.size(); ++i) {
+            const float t = c.t[i], q = 1.f - t;
+            c.out[i] = q * q * c.p0[i] + 2 * t * q * c.p1[i] + t * t * c.p2[i];
+        }
+        benchmark::DoNotOptimize(c.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadraticBezierEager)->Apply(CacheSizes<4 * sizeof(float3) + sizeof(float)>);
+
+// What an expression template would evaluate to: the whole chain in one
+// loop over the components, with no float3 in between.
+static void BM_QuadraticBezierFused(benchmark::State& state)
+{
+    Curves c(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < c.t.size(); ++i) {
+            const float t = c.t[i], q = 1.f - t;
+            const float a = q * q, b = 2 * t * q, d = t * t;
+            for (size_t k = 0; k < 3; ++k)
+                c.out[i][k] = a * c.p0[i][k] + b * c.p1[i][k] + d * c.p2[i][k];
+        }
+        benchmark::DoNotOptimize(c.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadraticBezierFused)->Apply(CacheSizes<4 * sizeof(float3) + sizeof(float)>);
+
+// the same with each a * b + c as one fused multiply-add
+static void BM_QuadraticBezierFma(benchmark::State& state)
+{
+    Curves c(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < c.t.size(); ++i) {
+            const float t = c.t[i], q = 1.f - t;
+            const float a = q * q, b = 2 * t * q, d = t * t;
+            for (size_t k = 0; k < 3; ++k)
+                c.out[i][k] = std::fma(d, c.p2[i][k], std::fma(b, c.p1[i][k], a * c.p0[i][k]));
+        }
+        benchmark::DoNotOptimize(c.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadraticBezierFma)->Apply(CacheSizes<4 * sizeof(float3) + sizeof(float)>);
+
+// homogeneous control points, the float4 flavour of the curve above
+struct Curves4
+{
+    std::vector<float4> p0, p1, p2;
+    std::vector<float> t;
+    std::vector<float4> out;
+
+    explicit Curves4(size_t count)
+        : p0(count), p1(count), p2(count), t(count), out(count)
+    {
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        for (size_t i = 0; i < count; ++i) {
+            p0[i] = float4(dist(gen), dist(gen), dist(gen), 1.f);
+            p1[i] = float4(dist(gen), dist(gen), dist(gen), 1.f);
+            p2[i] = float4(dist(gen), dist(gen), dist(gen), 1.f);
+            t[i] = dist(gen) * 0.5f + 0.5f;
+        }
+    }
+};
+
+// the component loop the generic TVec4<T> operators run
+static void BM_QuadraticBezier4Scalar(benchmark::State& state)
+{
+    Curves4 c(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < c.t.size(); ++i) {
+            const float t = c.t[i], q = 1.f - t;
+            for (size_t k = 0; k < 4; ++k)
+                c.out[i][k] = q * q * c.p0[i][k] + 2 * t * q * c.p1[i][k] + t * t * c.p2[i][k];
+        }
+        benchmark::DoNotOptimize(c.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadraticBezier4Scalar)->Apply(CacheSizes<4 * sizeof(float4) + sizeof(float)>);
+
+static void BM_QuadraticBezier4Simd(benchmark::State& state)
+{
+    Curves4 c(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < c.t.size(); ++i) {
+            const float t = c.t[i], q = 1.f - t;
+            c.out[i] = q * q * c.p0[i] + 2 * t * q * c.p1[i] + t * t * c.p2[i];
+        }
+        benchmark::DoNotOptimize(c.out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuadraticBezier4Simd)->Apply(CacheSizes<4 * sizeof(float4) + sizeof(float)>);
+
+BENCHMARK_MAIN();
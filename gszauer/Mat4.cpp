@@ -1,6 +1,13 @@
 #include "Mat4.h"
 #include <cmath>
 
+// mat4 shares TMat44's column-major layout, so the batch paths and the
+// inverses reuse the el kernels rather than carrying a second copy.
+#include "../math/el_dispatch.h"
+#include "../math/el_simd.h"
+#include "../math/el_parallel.h"
+#include "../math/el_transform.h"
+
 namespace gszauer {
 
 bool operator==(const mat4& a, const mat4& b) 
@@ -19,14 +26,190 @@ bool operator!=(const mat4& a, const mat4& b)
     return !(a == b);
 }
 
-inline constexpr 
+mat4 mul(const mat4& a, const mat4& b) noexcept
+{
+    mat4 res;
+#if EL_SIMD_SSE2
+    el::simd::mat44_mul(res.v, a.v, b.v);
+#else
+    for (size_t c = 0; c < 4; c++)
+        res[c] = mul(a, b[c]);
+#endif
+    return res;
+}
+
+vec4 mul(const mat4& m, const vec4& v) noexcept
+{
+#if EL_SIMD_SSE2
+    vec4 res;
+    el::simd::mat44_mul_vec4(res.v, m.v, v.v);
+    return res;
+#else
+    return vec4(
+        m.v[0] * v.x + m.v[4] * v.y + m.v[8]  * v.z + m.v[12] * v.w,
+        m.v[1] * v.x + m.v[5] * v.y + m.v[9]  * v.z + m.v[13] * v.w,
+        m.v[2] * v.x + m.v[6] * v.y + m.v[10] * v.z + m.v[14] * v.w,
+        m.v[3] * v.x + m.v[7] * v.y + m.v[11] * v.z + m.v[15] * v.w);
+#endif
+}
+
+static void transformAoS(const mat4& m, float w, const vec3* in, vec3* out, size_t count, size_t threads)
+{
+    static_assert(sizeof(vec3) == sizeof(float) * 3, "vec3 must be tightly packed");
+
+    const float* src = reinterpret_cast<const float*>(in);
+    float* dst = reinterpret_cast<float*>(out);
+    const auto kernel = el::dispatch::kernels().transform3_aos;
+    el::parallel_for(count, threads, el::details::TRANSFORM_GRAIN, [&](size_t begin, size_t end) {
+        kernel(m.v, w, src + begin * 3, dst + begin * 3, end - begin);
+    });
+}
+
+static void transformSoA(const mat4& m, float w,
+    const float* x, const float* y, const float* z,
+    float* outX, float* outY, float* outZ, size_t count, size_t threads)
+{
+    const auto kernel = el::dispatch::kernels().transform3_soa;
+    el::parallel_for(count, threads, el::details::TRANSFORM_GRAIN, [&](size_t begin, size_t end) {
+        kernel(m.v, w, x + begin, y + begin, z + begin,
+            outX + begin, outY + begin, outZ + begin, end - begin);
+    });
+}
+
+void transformPoints(const mat4& m, const vec3* in, vec3* out, size_t count, size_t threads)
+{
+    transformAoS(m, 1.f, in, out, count, threads);
+}
+
+void transformVectors(const mat4& m, const vec3* in, vec3* out, size_t count, size_t threads)
+{
+    transformAoS(m, 0.f, in, out, count, threads);
+}
+
+void transformPoints(const mat4& m,
+    const float* x, const float* y, const float* z,
+    float* outX, float* outY, float* outZ, size_t count, size_t threads)
+{
+    transformSoA(m, 1.f, x, y, z, outX, outY, outZ, count, threads);
+}
+
+void transformVectors(const mat4& m,
+    const float* x, const float* y, const float* z,
+    float* outX, float* outY, float* outZ, size_t count, size_t threads)
+{
+    transformSoA(m, 0.f, x, y, z, outX, outY, outZ, count, threads);
+}
+
+// determinant of the 3x3 made of columns c0..c2 and rows r0..r2
+static inline constexpr
 float minor(const mat4& m, size_t c0, size_t c1, size_t c2, size_t r0, size_t r1, size_t r2)
 {
     float ret = 0;
     ret += m[c0][r0] * (m[c1][r1] * m[c2][r2] - m[c2][r1] * m[c1][r2]);
-    ret -= m[c1][r0] * (m[c1][r1] * m[c2][r2] - m[c2][r1] * m[c1][r2]);
-    ret += m[c0][r0] * (m[c1][r1] * m[c2][r2] - m[c2][r1] * m[c1][r2]);
+    ret -= m[c1][r0] * (m[c0][r1] * m[c2][r2] - m[c2][r1] * m[c0][r2]);
+    ret += m[c2][r0] * (m[c0][r1] * m[c1][r2] - m[c1][r1] * m[c0][r2]);
     return ret;
 }
 
+// signed minor of element (c, r)
+static inline float cofactor(const mat4& m, size_t c, size_t r)
+{
+    static constexpr size_t others[4][3] = {
+        { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+    const size_t* oc = others[c];
+    const size_t* or_ = others[r];
+    const float sign = ((c + r) & 1) ? -1.f : 1.f;
+    return sign * minor(m, oc[0], oc[1], oc[2], or_[0], or_[1], or_[2]);
+}
+
+float determinant(const mat4& m)
+{
+    float det = 0;
+    for (size_t c = 0; c < 4; c++)
+        det += m[c][0] * cofactor(m, c, 0);
+    return det;
+}
+
+mat4 inverse(const mat4& m)
+{
+    mat4 res;
+#if EL_SIMD_SSE2
+    el::simd::mat44_inverse(res.v, m.v);
+#else
+    // adjugate / determinant
+    const float rdet = 1.f / determinant(m);
+    for (size_t c = 0; c < 4; c++)
+        for (size_t r = 0; r < 4; r++)
+            res[c][r] = cofactor(m, r, c) * rdet;
+#endif
+    return res;
+}
+
+mat4 affineInverse(const mat4& m)
+{
+    mat4 res;
+#if EL_SIMD_SSE2
+    el::simd::mat44_affine_inverse(res.v, m.v);
+#else
+    const vec3 c0(m.v[0], m.v[1], m.v[2]);
+    const vec3 c1(m.v[4], m.v[5], m.v[6]);
+    const vec3 c2(m.v[8], m.v[9], m.v[10]);
+    const vec3 t(m.v[12], m.v[13], m.v[14]);
+    const float rdet = 1.f / dot(c0, cross(c1, c2));
+    // rows of the inverted 3x3
+    const vec3 r0 = cross(c1, c2) * rdet;
+    const vec3 r1 = cross(c2, c0) * rdet;
+    const vec3 r2 = cross(c0, c1) * rdet;
+    res = mat4(
+        r0.x, r1.x, r2.x, 0.f,
+        r0.y, r1.y, r2.y, 0.f,
+        r0.z, r1.z, r2.z, 0.f,
+        -dot(r0, t), -dot(r1, t), -dot(r2, t), 1.f);
+#endif
+    return res;
+}
+
+mat4 rigidInverse(const mat4& m)
+{
+    mat4 res;
+#if EL_SIMD_SSE2
+    el::simd::mat44_rigid_inverse(res.v, m.v);
+#else
+    const vec3 c0(m.v[0], m.v[1], m.v[2]);
+    const vec3 c1(m.v[4], m.v[5], m.v[6]);
+    const vec3 c2(m.v[8], m.v[9], m.v[10]);
+    const vec3 t(m.v[12], m.v[13], m.v[14]);
+    res = mat4(
+        c0.x, c1.x, c2.x, 0.f,
+        c0.y, c1.y, c2.y, 0.f,
+        c0.z, c1.z, c2.z, 0.f,
+        -dot(c0, t), -dot(c1, t), -dot(c2, t), 1.f);
+#endif
+    return res;
+}
+
+template <typename F>
+static void invertBatch(const mat4* in, mat4* out, size_t count, size_t threads, F invert)
+{
+    el::parallel_for(count, threads, el::details::INVERSE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = invert(in[i]);
+    });
+}
+
+void inverse(const mat4* in, mat4* out, size_t count, size_t threads)
+{
+    invertBatch(in, out, count, threads, [](const mat4& m) { return inverse(m); });
+}
+
+void affineInverse(const mat4* in, mat4* out, size_t count, size_t threads)
+{
+    invertBatch(in, out, count, threads, [](const mat4& m) { return affineInverse(m); });
+}
+
+void rigidInverse(const mat4* in, mat4* out, size_t count, size_t threads)
+{
+    invertBatch(in, out, count, threads, [](const mat4& m) { return rigidInverse(m); });
+}
+
 } // namespace gszauer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include <type_traits>
 
 #include "Vec3.h"
 #include "Vec4.h"
@@ -9,16 +10,23 @@
 
 namespace gszauer {
 
+struct mat4;
+
+// SSE/AVX kernels, see Mat4.cpp
+mat4 mul(const mat4& a, const mat4& b) noexcept;
+vec4 mul(const mat4& m, const vec4& v) noexcept;
+
 struct mat4 
 {
     static constexpr size_t cols = 4;
     static constexpr size_t rows = 4;
 
     constexpr mat4() noexcept :
-        x(1.f, 0.f, 0.f, 0.f),
-        y(0.f, 1.f, 0.f, 0.f),
-        z(0.f, 0.f, 1.f, 0.f),
-        w(0.f, 0.f, 0.f, 1.f)
+        col{
+        vec4(1.f, 0.f, 0.f, 0.f),
+        vec4(0.f, 1.f, 0.f, 0.f),
+        vec4(0.f, 0.f, 1.f, 0.f),
+        vec4(0.f, 0.f, 0.f, 1.f) }
     {
     }
 
@@ -27,10 +35,11 @@ struct mat4
         float yx, float yy, float yz, float yw,
         float zx, float zy, float zz, float zw,
         float wx, float wy, float wz, float ww) :
-        x(xx, xy, xz, xw),
-        y(yx, yy, yz, yw),
-        z(zx, zy, zz, zw),
-        w(wx, wy, wz, ww)
+        col{
+        vec4(xx, xy, xz, xw),
+        vec4(yx, yy, yz, yw),
+        vec4(zx, zy, zz, zw),
+        vec4(wx, wy, wz, ww) }
     {
     }
 
@@ -52,11 +61,12 @@ struct mat4
         vec4(0, 0, 0, v[3]) } {
     }
 
-    mat4(float* v) :
-        x(v[ 0], v[ 1], v[ 2], v[ 3]),
-        y(v[ 4], v[ 5], v[ 6], v[ 7]),
-        z(v[ 8], v[ 9], v[10], v[11]),
-        w(v[12], v[13], v[14], v[15])
+    constexpr mat4(float* v) :
+        col{
+        vec4(v[ 0], v[ 1], v[ 2], v[ 3]),
+        vec4(v[ 4], v[ 5], v[ 6], v[ 7]),
+        vec4(v[ 8], v[ 9], v[10], v[11]),
+        vec4(v[12], v[13], v[14], v[15]) }
     {
     }
 
@@ -88,9 +98,22 @@ struct mat4
 
     }
 
+    // column-major product, res[c] = lhs * rhs[c]. Runtime calls go to the
+    // SIMD kernels; the loop only runs in constant evaluation.
     template <typename R, typename A, typename B>
-    constexpr R multiply(A lhs, B rhs) {
-        R res{};
+    static constexpr R multiply(const A& lhs, const B& rhs) {
+        if (!std::is_constant_evaluated())
+            return mul(lhs, rhs);
+        R res(0.f);
+        for (size_t c = 0; c < cols; c++) {
+            for (size_t r = 0; r < rows; r++) {
+                res[c][r] =
+                    lhs[0][r] * rhs[c][0] +
+                    lhs[1][r] * rhs[c][1] +
+                    lhs[2][r] * rhs[c][2] +
+                    lhs[3][r] * rhs[c][3];
+            }
+        }
         return res;
     }
 
@@ -103,12 +126,24 @@ struct mat4
 
     // matrix * vector
     constexpr vec4 operator*=(const vec4& rhs) const {
+        if (!std::is_constant_evaluated())
+            return mul(*this, rhs);
         vec4 res{};
+        for (size_t r = 0; r < rows; r++) {
+            res[r] =
+                col[0][r] * rhs[0] +
+                col[1][r] * rhs[1] +
+                col[2][r] * rhs[2] +
+                col[3][r] * rhs[3];
+        }
         return res;
     }
 
     union {
+#if defined(_MSC_VER)
+        // GCC and Clang reject members with constructors in anonymous structs
         struct { vec4 x, y, z, w; };
+#endif
         float v[16];
         vec4 col[4];
     };
@@ -124,6 +159,43 @@ inline constexpr mat4 operator+(const mat4& a, const mat4& b)
     return c;
 }
 
+inline constexpr mat4 operator*(const mat4& a, const mat4& b)
+{
+    return mat4::multiply<mat4>(a, b);
+}
+
+inline constexpr vec4 operator*(const mat4& m, const vec4& v)
+{
+    return m *= v;
+}
+
+float determinant(const mat4& m);
+
+// General inverse, a singular matrix yields inf/nan.
+mat4 inverse(const mat4& m);
+// Inverse of a matrix whose last row is (0, 0, 0, 1).
+mat4 affineInverse(const mat4& m);
+// Inverse of rotation + translation.
+mat4 rigidInverse(const mat4& m);
+
+// Batch inverses, out may be in.
+void inverse(const mat4* in, mat4* out, size_t count, size_t threads = 1);
+void affineInverse(const mat4* in, mat4* out, size_t count, size_t threads = 1);
+void rigidInverse(const mat4* in, mat4* out, size_t count, size_t threads = 1);
+
+// Batch transforms of vec3 arrays, w = 1 for points and w = 0 for vectors.
+// Only the upper 3x4 of m is used. out may be in, SoA outputs may be their
+// inputs. threads > 1 splits the work, 0 uses every hardware thread.
+void transformPoints(const mat4& m, const vec3* in, vec3* out, size_t count, size_t threads = 1);
+void transformVectors(const mat4& m, const vec3* in, vec3* out, size_t count, size_t threads = 1);
+
+void transformPoints(const mat4& m,
+    const float* x, const float* y, const float* z,
+    float* outX, float* outY, float* outZ, size_t count, size_t threads = 1);
+void transformVectors(const mat4& m,
+    const float* x, const float* y, const float* z,
+    float* outX, float* outY, float* outZ, size_t count, size_t threads = 1);
+
 } // namespace gszauer
 
 using mat4 = gszauer::mat4;
@@ -11,19 +11,63 @@ struct quat {
         vec4 xyzw;
         vec3 xyz;
         vec2 xy;
+#if defined(_MSC_VER)
+        // GCC and Clang reject members with constructors in anonymous
+        // structs; xyz and w alias the same storage.
         struct {
             vec3 vector;
             float scalar;
         };
+#endif
         float v[4];
     };
-    quat();
-    quat(const vec3& v, float w);
-    quat(float x, float y, float z, float w);
+    // constructors set x, y, z and w; constant expressions read only those
+    constexpr quat()
+        : x(0), y(0), z(0), w(1)
+    {
+    }
+
+    constexpr quat(const vec3& v, float w)
+        : x(v.x), y(v.y), z(v.z), w(w)
+    {
+    }
+
+    constexpr quat(float x, float y, float z, float w)
+        : x(x), y(y), z(z), w(w)
+    {
+    }
 };
 
-quat operator*(const quat& q, const quat& r);
-vec3 operator*(const quat& q, const vec3& v);
+/*
+ * quat s(vec3(0, 0, 1), 3.14f / 4);
+ * quat r(vec3(0, 1, 0), 3.14f / 4);
+ * vec3 p(0, -1, 0);
+ * auto r0 = s * (r * p);
+ * auto r1 = (r * s) * p;
+ */
+constexpr quat operator*(const quat& q, const quat& r)
+{
+    // 
+    // q * (r * vec3) = (r * q) * vec3
+    // 
+    // return quat(
+    //          q.xyz*r.w + r.xyz*q.w + cross(r.xyz, q.xyz),
+    //          r.w*q.w - dot(r.xyz, q.xyz));
+    return quat(
+         r.x * q.w + r.y * q.z - r.z * q.y + r.w * q.x,
+        -r.x * q.z + r.y * q.w + r.z * q.x + r.w * q.y,
+         r.x * q.y - r.y * q.x + r.z * q.w + r.w * q.z,
+        -r.x * q.x - r.y * q.y - r.z * q.z + r.w * q.w
+    );
+}
+
+constexpr vec3 operator*(const quat& q, const vec3& v)
+{
+    const vec3 u(q.x, q.y, q.z);
+    return u * 2.0f * dot(u, v)
+        + v * (q.w * q.w - dot(u, u))
+        + cross(u, v) * 2.0f * q.w;
+}
 
 quat angleAxis(float angle, const vec3& axis);
 
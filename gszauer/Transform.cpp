@@ -0,0 +1,125 @@
+#include "Transform.h"
+#include <algorithm>
+#include <atomic>
+
+#include "../math/el_parallel.h"
+
+namespace gszauer {
+
+mat4 transformToMat4(const Transform& t)
+{
+    // basis vectors rotated then scaled
+    vec3 x = t.rotation * vec3(1.f, 0.f, 0.f) * t.scale.x;
+    vec3 y = t.rotation * vec3(0.f, 1.f, 0.f) * t.scale.y;
+    vec3 z = t.rotation * vec3(0.f, 0.f, 1.f) * t.scale.z;
+    const vec3& p = t.position;
+
+    return mat4(
+        x.x, x.y, x.z, 0.f,
+        y.x, y.y, y.z, 0.f,
+        z.x, z.y, z.z, 0.f,
+        p.x, p.y, p.z, 1.f);
+}
+
+int TransformHierarchy::add(int parent, const Transform& local)
+{
+    assert(parent == NO_PARENT || (parent >= 0 && parent < (int)size()));
+
+    const int node = (int)size();
+    mParents.push_back(parent);
+    mLocal.push_back(local);
+    mWorld.push_back(mat4());
+    mDirty.push_back(1);
+    mAnyDirty = true;
+    mSubtreesValid = false;
+    return node;
+}
+
+void TransformHierarchy::setLocal(int node, const Transform& local)
+{
+    mLocal[node] = local;
+    mDirty[node] = 1;
+    mAnyDirty = true;
+}
+
+const mat4& TransformHierarchy::getWorld(int node)
+{
+    if (mAnyDirty)
+        update();
+    return mWorld[node];
+}
+
+// A node is rebuilt when it or its parent is dirty; the flag is left set so
+// its own children see it later in the same pass.
+bool TransformHierarchy::updateNode(int node)
+{
+    const int parent = mParents[node];
+    if (parent != NO_PARENT && mDirty[parent])
+        mDirty[node] = 1;
+    if (!mDirty[node])
+        return false;
+
+    const mat4 local = transformToMat4(mLocal[node]);
+    mWorld[node] = parent == NO_PARENT ? local : mWorld[parent] * local;
+    return true;
+}
+
+void TransformHierarchy::buildSubtrees()
+{
+    // counting sort by root keeps the parent-first order inside each group
+    const size_t count = size();
+    std::vector<int> roots(count);
+    std::vector<size_t> rootSlot(count);
+    size_t numRoots = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int parent = mParents[i];
+        roots[i] = parent == NO_PARENT ? (int)i : roots[parent];
+        if (parent == NO_PARENT)
+            rootSlot[i] = numRoots++;
+    }
+
+    mSubtreeStart.assign(numRoots + 1, 0);
+    for (size_t i = 0; i < count; i++)
+        mSubtreeStart[rootSlot[roots[i]] + 1]++;
+    for (size_t r = 0; r < numRoots; r++)
+        mSubtreeStart[r + 1] += mSubtreeStart[r];
+
+    std::vector<size_t> cursor(mSubtreeStart.begin(), mSubtreeStart.end() - 1);
+    mSubtreeNodes.resize(count);
+    for (size_t i = 0; i < count; i++)
+        mSubtreeNodes[cursor[rootSlot[roots[i]]]++] = (int)i;
+
+    mSubtreesValid = true;
+}
+
+size_t TransformHierarchy::update(size_t threads)
+{
+    if (!mAnyDirty)
+        return 0;
+
+    size_t rebuilt = 0;
+    if (threads == 1) {
+        for (size_t i = 0; i < size(); i++)
+            rebuilt += updateNode((int)i);
+    } else {
+        if (!mSubtreesValid)
+            buildSubtrees();
+
+        // subtrees share no nodes, so each one can run on its own thread
+        std::atomic<size_t> total(0);
+        const size_t numRoots = mSubtreeStart.size() - 1;
+        el::parallel_for(numRoots, threads, 1, [&](size_t begin, size_t end) {
+            size_t local = 0;
+            for (size_t n = mSubtreeStart[begin]; n < mSubtreeStart[end]; n++)
+                local += updateNode(mSubtreeNodes[n]);
+            total += local;
+        });
+        rebuilt = total;
+    }
+
+    std::fill(mDirty.begin(), mDirty.end(), uint8_t(0));
+    mAnyDirty = false;
+    return rebuilt;
+}
+
+} // namespace gszauer
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Vec3.h"
+#include "Quat.h"
+#include "Mat4.h"
+
+namespace gszauer {
+
+struct Transform
+{
+    vec3 position;
+    quat rotation;
+    vec3 scale;
+
+    Transform() : position(0.f), rotation(), scale(1.f) {}
+    Transform(const vec3& p, const quat& r, const vec3& s)
+        : position(p), rotation(r), scale(s) {}
+};
+
+// scale, then rotate, then translate
+mat4 transformToMat4(const Transform& t);
+
+// Flat scene graph: nodes live in parent-index arrays where a parent always
+// comes before its children, so world matrices resolve in one forward pass.
+// Editing a local transform only marks the node dirty; world matrices of
+// dirty nodes and their descendants are rebuilt on the next update().
+class TransformHierarchy
+{
+public:
+    static constexpr int NO_PARENT = -1;
+
+    // parent must be NO_PARENT or an existing node, returns the new index
+    int add(int parent, const Transform& local = Transform());
+
+    size_t size() const { return mParents.size(); }
+    int getParent(int node) const { return mParents[node]; }
+
+    const Transform& getLocal(int node) const { return mLocal[node]; }
+    void setLocal(int node, const Transform& local);
+
+    // brings dirty world matrices up to date first
+    const mat4& getWorld(int node);
+
+    // Rebuilds the world matrix of every dirty node and of everything below
+    // it. threads != 1 splits the pass across independent root subtrees,
+    // 0 uses every hardware thread. Returns the number of nodes rebuilt.
+    size_t update(size_t threads = 1);
+
+    bool isDirty() const { return mAnyDirty; }
+
+private:
+    void buildSubtrees();
+    bool updateNode(int node);
+
+    std::vector<int> mParents;
+    std::vector<Transform> mLocal;
+    std::vector<mat4> mWorld;
+    std::vector<uint8_t> mDirty;
+    bool mAnyDirty = false;
+
+    // nodes grouped by root, each group in parent-first order
+    std::vector<int> mSubtreeNodes;
+    std::vector<size_t> mSubtreeStart;
+    bool mSubtreesValid = false;
+};
+
+} // namespace gszauer
+
+using Transform = gszauer::Transform;
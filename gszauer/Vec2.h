@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #define VEC3_EPSILON 0.000001f
@@ -15,18 +16,19 @@ template <typename T>
 struct TVec2 {
     union {
         struct {
-            float x;
-            float y;
+            T x;
+            T y;
         };
         T v[2]{};
     };
 
+    // constructors set x and y, the members constant evaluation reads
     constexpr TVec2() : x(T(0)), y(T(0)) {}
-    TVec2(T x) : x(x), y(x) {}
-    TVec2(T x, T y) : x(x), y(y) {}
-    TVec2(T* fv) : x(fv[0]), y(fv[1]) {}
-    TVec2(const TVec3<T>& vec) 
-        : v { vec[0], vec[1] }
+    constexpr TVec2(T x) : x(x), y(x) {}
+    constexpr TVec2(T x, T y) : x(x), y(y) {}
+    constexpr TVec2(T* fv) : x(fv[0]), y(fv[1]) {}
+    constexpr TVec2(const TVec3<T>& vec) 
+        : x(vec[0]), y(vec[1])
     {}
 };
         
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <numbers>
+#include <type_traits>
 #include <utility>
 
 #include "Vec2.h"
@@ -21,21 +26,28 @@ struct TVec3
             T x, y, z;
         };
     };
-    constexpr TVec3() : v{ T(0.0), T(0.0), T(0.0) } {}
+    // Constructors set x, y and z. Constant evaluation may only read the
+    // union member that was initialized, so operator[] picks the named
+    // member there instead of indexing v.
+    constexpr TVec3() : x(T(0.0)), y(T(0.0)), z(T(0.0)) {}
     template <typename A>
-    constexpr TVec3(A a) : v{ T(a), T(a), T(a) } {}
-    TVec3(T x, T y, T z) :
+    constexpr TVec3(A a) : x(T(a)), y(T(a)), z(T(a)) {}
+    constexpr TVec3(T x, T y, T z) :
         x(x), y(y), z(z) {}
-    TVec3(T * fv) :
+    constexpr TVec3(T * fv) :
         x(fv[0]), y(fv[1]), z(fv[2]) {}
 
     inline constexpr T& operator[](size_t i) noexcept {
         assert(i < SIZE);
+        if (std::is_constant_evaluated())
+            return i == 0 ? x : i == 1 ? y : z;
         return v[i];
     }
 
     inline constexpr const T& operator[](size_t i) const noexcept {
         assert(i < SIZE);
+        if (std::is_constant_evaluated())
+            return i == 0 ? x : i == 1 ? y : z;
         return v[i];
     }
 
@@ -43,49 +55,50 @@ struct TVec3
 };
 
 template <typename T>
-TVec3<T> operator+(const TVec3<T>& l, const TVec3<T>& r)
+constexpr TVec3<T> operator+(const TVec3<T>& l, const TVec3<T>& r)
 {
     return TVec3<T>(l.x + r.x, l.y + r.y, l.z + r.z);
 }
 
 template <typename T>
-TVec3<T> operator-(const TVec3<T>& l, const TVec3<T>& r)
+constexpr TVec3<T> operator-(const TVec3<T>& l, const TVec3<T>& r)
 {
     return TVec3<T>(l.x - r.x, l.y - r.y, l.z - r.z);
 }
 
-template <typename T>
-TVec3<T> operator*(const TVec3<T>& l, float f)
+// scalars keep their own precision, TVec3<double> is not scaled through float
+template <typename T, typename U> requires std::is_arithmetic_v<U>
+constexpr TVec3<T> operator*(const TVec3<T>& l, U f)
 {
     return TVec3<T>(l.x * f, l.y * f, l.z * f);
 }
 
 template <typename T>
-TVec3<T> operator*(const TVec3<T>& l, const TVec3<T>& r)
+constexpr TVec3<T> operator*(const TVec3<T>& l, const TVec3<T>& r)
 {
     return TVec3<T>(l.x * r.x, l.y * r.y, l.z * r.z);
 }
 
 template <typename T>
-TVec3<T> operator/(const TVec3<T>& l, const TVec3<T>& r)
+constexpr TVec3<T> operator/(const TVec3<T>& l, const TVec3<T>& r)
 {
-    return TVec3<T>(l.x / r.x, l.y / r.x, l.z / r.x);
+    return TVec3<T>(l.x / r.x, l.y / r.y, l.z / r.z);
 }
 
-template <typename T>
-TVec3<T> operator/(const TVec3<T>& l, float f)
+template <typename T, typename U> requires std::is_arithmetic_v<U>
+constexpr TVec3<T> operator/(const TVec3<T>& l, U f)
 {
     return TVec3<T>(l.x / f, l.y / f, l.z / f);
 }
 
-template <typename T>
-TVec3<T> operator*(float f, const TVec3<T>& l)
+template <typename T, typename U> requires std::is_arithmetic_v<U>
+constexpr TVec3<T> operator*(U f, const TVec3<T>& l)
 {
     return l * f;
 }
 
 template <typename T>
-TVec3<T> lerp(const TVec3<T>& s, const TVec3<T>& e, float t)
+constexpr TVec3<T> lerp(const TVec3<T>& s, const TVec3<T>& e, float t)
 {
     return e * t + s * (1 - t);
 }
@@ -94,10 +107,25 @@ template <typename T>
 TVec3<T> slerp(const TVec3<T>& s, const TVec3<T>& e, float t) {
     TVec3<T> from = normalized(s);
     TVec3<T> to = normalized(e);
-    float theta = angle(from, to);
-    float sin_theta = sinf(theta);
-    float a = sinf((1.0f - t) * theta) / sin_theta;
-    float b = sinf(t * theta) / sin_theta;
+    // atan2 keeps theta accurate for nearly parallel inputs, where acos of
+    // the dot product loses half the digits. Inputs along one line have no
+    // rotation plane: parallel ones fall back to nlerp, opposite ones turn
+    // half way round through the axis `from` is least aligned with.
+    T sin_theta = std::sqrt(lenSq(cross(from, to)));
+    if (sin_theta < std::numeric_limits<T>::epsilon()) {
+        if (dot(from, to) > T(0))
+            return nlerp(from, to, t);
+        const T ax = std::fabs(from.x), ay = std::fabs(from.y), az = std::fabs(from.z);
+        const TVec3<T> axis = ax <= ay && ax <= az ? TVec3<T>(1, 0, 0)
+            : ay <= az ? TVec3<T>(0, 1, 0) : TVec3<T>(0, 0, 1);
+        const TVec3<T> perpendicular = normalized(cross(from, axis));
+        const T angle = t * std::numbers::pi_v<T>;
+        return from * std::cos(angle) + perpendicular * std::sin(angle);
+    }
+    T theta = std::atan2(sin_theta, dot(from, to));
+    sin_theta = std::sin(theta);
+    T a = std::sin((T(1) - t) * theta) / sin_theta;
+    T b = std::sin(t * theta) / sin_theta;
 
     return from * a + to * b;
 }
@@ -108,23 +136,23 @@ TVec3<T> nlerp(const TVec3<T>& s, const TVec3<T>& e, float t) {
 }
 
 template <typename T>
-T dot(const TVec3<T>& l, const TVec3<T>& r)
+constexpr T dot(const TVec3<T>& l, const TVec3<T>& r)
 {
     return l.x * r.x + l.y * r.y + l.z * r.z;
 }
 
 template <typename T>
-T lenSq(const TVec3<T>& v) {
+constexpr T lenSq(const TVec3<T>& v) {
     return dot(v, v);
 }
 
 template <typename T>
 T len(const TVec3<T>& v) {
-    float sq = lenSq(v);
+    T sq = lenSq(v);
     if (sq < VEC3_EPSILON) {
-        return 0.0f;
+        return T(0);
     }
-    return sqrtf(sq);
+    return std::sqrt(sq);
 }
 
 template <typename T>
@@ -146,39 +174,39 @@ T angle(const TVec3<T>& l, const TVec3<T>& r)
     if (lenL < VEC3_EPSILON || lenR < VEC3_EPSILON)
         return 0.f;
     T o = dot(l, r);
-    return acosf(o / lenL / lenR);
+    return std::acos(o / lenL / lenR);
 }
 
 template <typename T>
-TVec3<T> project(const TVec3<T>& a, const TVec3<T>& b)
+constexpr TVec3<T> project(const TVec3<T>& a, const TVec3<T>& b)
 {
-    float magBSq = lenSq(b);
+    T magBSq = lenSq(b);
     if (magBSq < VEC3_EPSILON) {
         return TVec3<T>();
     }
-    float scale = dot(a, b) / magBSq;
+    T scale = dot(a, b) / magBSq;
     return b * scale;
 }
 
 template <typename T>
-TVec3<T> reject(const TVec3<T>& a, const TVec3<T>& b) {
+constexpr TVec3<T> reject(const TVec3<T>& a, const TVec3<T>& b) {
     TVec3<T> projection = project(a, b);
     return a - projection;
 }
 
 template <typename T>
-TVec3<T> reflect(const TVec3<T>& a, const TVec3<T>& b) {
-    float magBSq = lenSq(b);
+constexpr TVec3<T> reflect(const TVec3<T>& a, const TVec3<T>& b) {
+    T magBSq = lenSq(b);
     if (magBSq < VEC3_EPSILON) {
         return TVec3<T>();
     }
-    float scale = dot(a, b) / magBSq;
+    T scale = dot(a, b) / magBSq;
     TVec3<T> proj2 = b * (scale * 2);
     return a - proj2;
 }
 
 template <typename T>
-TVec3<T> cross(const TVec3<T>& l, const TVec3<T>& r) {
+constexpr TVec3<T> cross(const TVec3<T>& l, const TVec3<T>& r) {
     return TVec3<T>(
         l.y * r.z - l.z * r.y,
         l.z * r.x - l.x * r.z,
@@ -186,14 +214,14 @@ TVec3<T> cross(const TVec3<T>& l, const TVec3<T>& r) {
 }
 
 template <typename T>
-bool operator==(const TVec3<T>& l, const TVec3<T>& r)
+constexpr bool operator==(const TVec3<T>& l, const TVec3<T>& r)
 {
     TVec3<T> diff(l - r);
     return lenSq(diff) < VEC3_EPSILON;
 }
 
 template <typename T>
-bool operator!=(const TVec3<T>& l, const TVec3<T>& r)
+constexpr bool operator!=(const TVec3<T>& l, const TVec3<T>& r)
 {
     return !(l == r);
 }
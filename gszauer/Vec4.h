@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #include "Vec2.h"
@@ -90,10 +91,12 @@ struct TVec4 :
         };
     };
 
+    // Constructors set x, y, z and w, see TVec3 for why operator[] reads
+    // them in constant evaluation.
     constexpr TVec4() : x(0.0), y(0.0), z(0.0), w(0.0) {}
     template <typename A>
     constexpr TVec4(A x) 
-        : v{ T(x), T(x), T(x), T(x) } {}
+        : x(T(x)), y(T(x)), z(T(x)), w(T(x)) {}
     template <typename A, typename B, typename C, typename D>
     constexpr TVec4(A x, B y, C z, D w) 
         : x(T(x)), y(T(y)), z(T(z)), w(T(w)) {}
@@ -103,11 +106,15 @@ struct TVec4 :
 
     inline constexpr const T& operator[](size_t i) const noexcept {
         assert(i < SIZE);
+        if (std::is_constant_evaluated())
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         return v[i];
     }
 
     inline constexpr T& operator[](size_t i) noexcept {
         assert(i < SIZE);
+        if (std::is_constant_evaluated())
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         return v[i];
     }
 
@@ -142,7 +149,7 @@ public:
 };
 
 template <typename T>
-inline T interpolate(const Bezier<T>& curve, float t) {
+inline constexpr T interpolate(const Bezier<T>& curve, float t) {
     T A = lerp(curve.P1, curve.C1, t);
     T B = lerp(curve.C2, curve.P2, t);
     T C = lerp(curve.C1, curve.C2, t);
@@ -0,0 +1,341 @@
+#include "VecStream.h"
+#include <cmath>
+
+#include "../math/el_dispatch.h"
+#include "../math/el_simd.h"
+#include "../math/el_parallel.h"
+
+namespace gszauer {
+
+// Component arrays start 32-byte aligned, so the SSE loops below use
+// aligned loads and stores and finish the last size() % 4 elements with
+// scalar code.
+
+static constexpr size_t STREAM_GRAIN = 16 * 1024;
+
+template <size_t N>
+static size_t prepare(const TVecStream<N>& a, TVecStream<N>& out)
+{
+    if (&out != &a)
+        out.resize(a.size());
+    return a.size();
+}
+
+template <size_t N>
+static size_t prepare(const TVecStream<N>& a, [[maybe_unused]] const TVecStream<N>& b, TVecStream<N>& out)
+{
+    assert(a.size() == b.size());
+    return prepare(a, out);
+}
+
+static void addArray(const float* a, const float* b, float* out, size_t n)
+{
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    for (; i + 4 <= n; i += 4)
+        _mm_store_ps(out + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+#endif
+    for (; i < n; ++i)
+        out[i] = a[i] + b[i];
+}
+
+static void scaleArray(const float* a, float s, float* out, size_t n)
+{
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    const __m128 vs = _mm_set1_ps(s);
+    for (; i + 4 <= n; i += 4)
+        _mm_store_ps(out + i, _mm_mul_ps(_mm_load_ps(a + i), vs));
+#endif
+    for (; i < n; ++i)
+        out[i] = a[i] * s;
+}
+
+// b * t + a * (1 - t), the same formula as lerp() in Vec3.h
+static void lerpArray(const float* a, const float* b, float t, float* out, size_t n)
+{
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 vs = _mm_set1_ps(1.f - t);
+    for (; i + 4 <= n; i += 4)
+        _mm_store_ps(out + i, _mm_add_ps(
+            _mm_mul_ps(_mm_load_ps(b + i), vt), _mm_mul_ps(_mm_load_ps(a + i), vs)));
+#endif
+    for (; i < n; ++i)
+        out[i] = b[i] * t + a[i] * (1.f - t);
+}
+
+template <size_t N>
+static void addStream(const TVecStream<N>& a, const TVecStream<N>& b, TVecStream<N>& out)
+{
+    const size_t n = prepare(a, b, out);
+    for (size_t c = 0; c < N; ++c)
+        addArray(a.component(c), b.component(c), out.component(c), n);
+}
+
+template <size_t N>
+static void scaleStream(const TVecStream<N>& a, float s, TVecStream<N>& out)
+{
+    const size_t n = prepare(a, out);
+    for (size_t c = 0; c < N; ++c)
+        scaleArray(a.component(c), s, out.component(c), n);
+}
+
+template <size_t N>
+static void lerpStream(const TVecStream<N>& a, const TVecStream<N>& b, float t, TVecStream<N>& out)
+{
+    const size_t n = prepare(a, b, out);
+    for (size_t c = 0; c < N; ++c)
+        lerpArray(a.component(c), b.component(c), t, out.component(c), n);
+}
+
+template <size_t N>
+static void dotStream(const TVecStream<N>& a, const TVecStream<N>& b, float* out)
+{
+    assert(a.size() == b.size());
+    const size_t n = a.size();
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) {
+        __m128 r = _mm_mul_ps(_mm_load_ps(a.component(0) + i), _mm_load_ps(b.component(0) + i));
+        for (size_t c = 1; c < N; ++c)
+            r = el::simd::madd(_mm_load_ps(a.component(c) + i), _mm_load_ps(b.component(c) + i), r);
+        _mm_storeu_ps(out + i, r);
+    }
+#endif
+    for (; i < n; ++i) {
+        float r = a.component(0)[i] * b.component(0)[i];
+        for (size_t c = 1; c < N; ++c)
+            r += a.component(c)[i] * b.component(c)[i];
+        out[i] = r;
+    }
+}
+
+template <size_t N>
+static void normalizeStream(TVecStream<N>& v)
+{
+    const size_t n = v.size();
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 eps = _mm_set1_ps(VEC3_EPSILON);
+    for (; i + 4 <= n; i += 4) {
+        __m128 comp[N];
+        __m128 sq = _mm_setzero_ps();
+        for (size_t c = 0; c < N; ++c) {
+            comp[c] = _mm_load_ps(v.component(c) + i);
+            sq = el::simd::madd(comp[c], comp[c], sq);
+        }
+        // 1 / |v| where the length is usable, 1 elsewhere
+        const __m128 keep = _mm_cmpge_ps(sq, eps);
+        const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(sq));
+        const __m128 s = _mm_or_ps(_mm_and_ps(keep, inv), _mm_andnot_ps(keep, one));
+        for (size_t c = 0; c < N; ++c)
+            _mm_store_ps(v.component(c) + i, _mm_mul_ps(comp[c], s));
+    }
+#endif
+    for (; i < n; ++i) {
+        float sq = 0.f;
+        for (size_t c = 0; c < N; ++c)
+            sq += v.component(c)[i] * v.component(c)[i];
+        if (sq < VEC3_EPSILON)
+            continue;
+        const float inv = 1.f / sqrtf(sq);
+        for (size_t c = 0; c < N; ++c)
+            v.component(c)[i] *= inv;
+    }
+}
+
+vec3 get(const Vec3Stream& s, size_t i)
+{
+    assert(i < s.size());
+    return vec3(s.x()[i], s.y()[i], s.z()[i]);
+}
+
+vec4 get(const Vec4Stream& s, size_t i)
+{
+    assert(i < s.size());
+    return vec4(s.x()[i], s.y()[i], s.z()[i], s.w()[i]);
+}
+
+void set(Vec3Stream& s, size_t i, const vec3& v)
+{
+    assert(i < s.size());
+    s.x()[i] = v.x;
+    s.y()[i] = v.y;
+    s.z()[i] = v.z;
+}
+
+void set(Vec4Stream& s, size_t i, const vec4& v)
+{
+    assert(i < s.size());
+    s.x()[i] = v.x;
+    s.y()[i] = v.y;
+    s.z()[i] = v.z;
+    s.w()[i] = v.w;
+}
+
+void fromAoS(std::span<const vec3> in, Vec3Stream& out)
+{
+    out.resize(in.size());
+    float* x = out.x();
+    float* y = out.y();
+    float* z = out.z();
+    for (size_t i = 0; i < in.size(); ++i) {
+        x[i] = in[i].x;
+        y[i] = in[i].y;
+        z[i] = in[i].z;
+    }
+}
+
+void fromAoS(std::span<const vec4> in, Vec4Stream& out)
+{
+    out.resize(in.size());
+    float* x = out.x();
+    float* y = out.y();
+    float* z = out.z();
+    float* w = out.w();
+    for (size_t i = 0; i < in.size(); ++i) {
+        x[i] = in[i].x;
+        y[i] = in[i].y;
+        z[i] = in[i].z;
+        w[i] = in[i].w;
+    }
+}
+
+void toAoS(const Vec3Stream& in, std::span<vec3> out)
+{
+    assert(out.size() == in.size());
+    const float* x = in.x();
+    const float* y = in.y();
+    const float* z = in.z();
+    for (size_t i = 0; i < out.size(); ++i)
+        out[i] = vec3(x[i], y[i], z[i]);
+}
+
+void toAoS(const Vec4Stream& in, std::span<vec4> out)
+{
+    assert(out.size() == in.size());
+    const float* x = in.x();
+    const float* y = in.y();
+    const float* z = in.z();
+    const float* w = in.w();
+    for (size_t i = 0; i < out.size(); ++i)
+        out[i] = vec4(x[i], y[i], z[i], w[i]);
+}
+
+void add(const Vec3Stream& a, const Vec3Stream& b, Vec3Stream& out) { addStream(a, b, out); }
+void add(const Vec4Stream& a, const Vec4Stream& b, Vec4Stream& out) { addStream(a, b, out); }
+void scale(const Vec3Stream& a, float s, Vec3Stream& out) { scaleStream(a, s, out); }
+void scale(const Vec4Stream& a, float s, Vec4Stream& out) { scaleStream(a, s, out); }
+
+void lerp(const Vec3Stream& a, const Vec3Stream& b, float t, Vec3Stream& out)
+{
+    lerpStream(a, b, t, out);
+}
+
+void lerp(const Vec4Stream& a, const Vec4Stream& b, float t, Vec4Stream& out)
+{
+    lerpStream(a, b, t, out);
+}
+
+void cross(const Vec3Stream& a, const Vec3Stream& b, Vec3Stream& out)
+{
+    const size_t n = prepare(a, b, out);
+    const float* ax = a.x(); const float* ay = a.y(); const float* az = a.z();
+    const float* bx = b.x(); const float* by = b.y(); const float* bz = b.z();
+    float* ox = out.x(); float* oy = out.y(); float* oz = out.z();
+
+    // every input is loaded before the first store, out may alias a or b
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    for (; i + 4 <= n; i += 4) {
+        const __m128 lx = _mm_load_ps(ax + i), ly = _mm_load_ps(ay + i), lz = _mm_load_ps(az + i);
+        const __m128 rx = _mm_load_ps(bx + i), ry = _mm_load_ps(by + i), rz = _mm_load_ps(bz + i);
+        _mm_store_ps(ox + i, _mm_sub_ps(_mm_mul_ps(ly, rz), _mm_mul_ps(lz, ry)));
+        _mm_store_ps(oy + i, _mm_sub_ps(_mm_mul_ps(lz, rx), _mm_mul_ps(lx, rz)));
+        _mm_store_ps(oz + i, _mm_sub_ps(_mm_mul_ps(lx, ry), _mm_mul_ps(ly, rx)));
+    }
+#endif
+    for (; i < n; ++i) {
+        const vec3 r = gszauer::cross(vec3(ax[i], ay[i], az[i]), vec3(bx[i], by[i], bz[i]));
+        ox[i] = r.x;
+        oy[i] = r.y;
+        oz[i] = r.z;
+    }
+}
+
+void dot(const Vec3Stream& a, const Vec3Stream& b, float* out) { dotStream(a, b, out); }
+void dot(const Vec4Stream& a, const Vec4Stream& b, float* out) { dotStream(a, b, out); }
+
+void normalize(Vec3Stream& v, NormalizePolicy policy)
+{
+    const el::dispatch::Kernels& k = el::dispatch::kernels();
+    const auto kernel = policy == NormalizePolicy::Fast ? k.normalize3_soa_fast : k.normalize3_soa;
+    kernel(v.x(), v.y(), v.z(), v.size(), VEC3_EPSILON);
+}
+
+void normalize(Vec4Stream& v) { normalizeStream(v); }
+
+void interpolate(const Bezier<vec3>& curve, std::span<const float> t, Vec3Stream& out)
+{
+    out.resize(t.size());
+    interpolate(curve, t, out.x(), out.y(), out.z());
+}
+
+void interpolate(const Bezier<vec3>& curve, std::span<const float> t, float* x, float* y, float* z)
+{
+    // curve order, not the P1, C1, P2, C2 member order of Bezier
+    const float p[12] = {
+        curve.P1.x, curve.P1.y, curve.P1.z,
+        curve.C1.x, curve.C1.y, curve.C1.z,
+        curve.C2.x, curve.C2.y, curve.C2.z,
+        curve.P2.x, curve.P2.y, curve.P2.z };
+    el::dispatch::kernels().bezier3_soa(p, t.data(), x, y, z, t.size());
+}
+
+void transformPoints(const mat4& m, const Vec3Stream& in, Vec3Stream& out, size_t threads)
+{
+    const size_t n = prepare(in, out);
+    transformPoints(m, in.x(), in.y(), in.z(), out.x(), out.y(), out.z(), n, threads);
+}
+
+void transformVectors(const mat4& m, const Vec3Stream& in, Vec3Stream& out, size_t threads)
+{
+    const size_t n = prepare(in, out);
+    transformVectors(m, in.x(), in.y(), in.z(), out.x(), out.y(), out.z(), n, threads);
+}
+
+void transform(const mat4& m, const Vec4Stream& in, Vec4Stream& out, size_t threads)
+{
+    const size_t n = prepare(in, out);
+    const float* src[4] = { in.x(), in.y(), in.z(), in.w() };
+    float* dst[4] = { out.x(), out.y(), out.z(), out.w() };
+
+    // the grain keeps every range start a multiple of 4, so the aligned
+    // loads stay valid on each thread
+    el::parallel_for(n, threads, STREAM_GRAIN, [&](size_t begin, size_t end) {
+        size_t i = begin;
+#if EL_SIMD_SSE2
+        for (; i + 4 <= end; i += 4) {
+            __m128 c[4];
+            for (size_t k = 0; k < 4; ++k)
+                c[k] = _mm_load_ps(src[k] + i);
+            for (size_t r = 0; r < 4; ++r) {
+                __m128 acc = _mm_mul_ps(_mm_set1_ps(m.v[r]), c[0]);
+                for (size_t k = 1; k < 4; ++k)
+                    acc = el::simd::madd(_mm_set1_ps(m.v[k * 4 + r]), c[k], acc);
+                _mm_store_ps(dst[r] + i, acc);
+            }
+        }
+#endif
+        for (; i < end; ++i) {
+            const vec4 v = m * vec4(src[0][i], src[1][i], src[2][i], src[3][i]);
+            for (size_t r = 0; r < 4; ++r)
+                dst[r][i] = v[r];
+        }
+    });
+}
+
+} // namespace gszauer
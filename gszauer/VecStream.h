@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat4.h"
+
+namespace gszauer {
+
+// std::allocator with ALIGN-byte aligned blocks, enough for full AVX loads
+template <typename T, size_t ALIGN>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, ALIGN>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGN>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(ALIGN)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(ALIGN));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, ALIGN>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, ALIGN>&) const noexcept { return false; }
+};
+
+static constexpr size_t STREAM_ALIGN = 32;
+
+template <typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T, STREAM_ALIGN>>;
+
+// Structure-of-arrays storage for N-component float vectors: one aligned
+// array per component, so bulk operations run a full SIMD register of
+// elements per instruction instead of one padded vector.
+template <size_t N>
+class TVecStream
+{
+public:
+    static constexpr size_t COMPONENTS = N;
+
+    TVecStream() = default;
+    explicit TVecStream(size_t count) { resize(count); }
+
+    size_t size() const { return mComp[0].size(); }
+    bool empty() const { return mComp[0].empty(); }
+
+    // new elements are zero
+    void resize(size_t count)
+    {
+        for (auto& c : mComp)
+            c.resize(count, 0.f);
+    }
+
+    void clear()
+    {
+        for (auto& c : mComp)
+            c.clear();
+    }
+
+    float* component(size_t c) { assert(c < N); return mComp[c].data(); }
+    const float* component(size_t c) const { assert(c < N); return mComp[c].data(); }
+
+    float* x() { return mComp[0].data(); }
+    float* y() { return mComp[1].data(); }
+    float* z() { return mComp[2].data(); }
+    float* w() requires (N == 4) { return mComp[3].data(); }
+    const float* x() const { return mComp[0].data(); }
+    const float* y() const { return mComp[1].data(); }
+    const float* z() const { return mComp[2].data(); }
+    const float* w() const requires (N == 4) { return mComp[3].data(); }
+
+private:
+    aligned_vector<float> mComp[N];
+};
+
+using Vec3Stream = TVecStream<3>;
+using Vec4Stream = TVecStream<4>;
+
+// Element access and AoS conversion. fromAoS resizes the stream to the
+// span, toAoS expects a span of size() elements.
+vec3 get(const Vec3Stream& s, size_t i);
+vec4 get(const Vec4Stream& s, size_t i);
+void set(Vec3Stream& s, size_t i, const vec3& v);
+void set(Vec4Stream& s, size_t i, const vec4& v);
+
+void fromAoS(std::span<const vec3> in, Vec3Stream& out);
+void fromAoS(std::span<const vec4> in, Vec4Stream& out);
+void toAoS(const Vec3Stream& in, std::span<vec3> out);
+void toAoS(const Vec4Stream& in, std::span<vec4> out);
+
+// Bulk operations. Inputs must have the same size, out is resized to it and
+// may be one of the inputs.
+void add(const Vec3Stream& a, const Vec3Stream& b, Vec3Stream& out);
+void add(const Vec4Stream& a, const Vec4Stream& b, Vec4Stream& out);
+void scale(const Vec3Stream& a, float s, Vec3Stream& out);
+void scale(const Vec4Stream& a, float s, Vec4Stream& out);
+void lerp(const Vec3Stream& a, const Vec3Stream& b, float t, Vec3Stream& out);
+void lerp(const Vec4Stream& a, const Vec4Stream& b, float t, Vec4Stream& out);
+void cross(const Vec3Stream& a, const Vec3Stream& b, Vec3Stream& out);
+
+// out must hold size() floats
+void dot(const Vec3Stream& a, const Vec3Stream& b, float* out);
+void dot(const Vec4Stream& a, const Vec4Stream& b, float* out);
+
+// Precise matches normalized() in Vec3.h. Fast uses the hardware reciprocal
+// square root estimate plus one Newton step, a few ulp off Precise and
+// several times cheaper than the sqrt and divide.
+enum class NormalizePolicy
+{
+    Precise,
+    Fast,
+};
+
+// vectors shorter than sqrt(VEC3_EPSILON) are left unchanged
+void normalize(Vec3Stream& v, NormalizePolicy policy = NormalizePolicy::Precise);
+void normalize(Vec4Stream& v);
+
+// samples the curve at every t, out is resized to t.size()
+void interpolate(const Bezier<vec3>& curve, std::span<const float> t, Vec3Stream& out);
+// the same into caller owned arrays of t.size() floats
+void interpolate(const Bezier<vec3>& curve, std::span<const float> t, float* x, float* y, float* z);
+
+// points use w = 1 and vectors w = 0, see the raw SoA overloads in Mat4.h
+void transformPoints(const mat4& m, const Vec3Stream& in, Vec3Stream& out, size_t threads = 1);
+void transformVectors(const mat4& m, const Vec3Stream& in, Vec3Stream& out, size_t threads = 1);
+// full 4x4 product per element
+void transform(const mat4& m, const Vec4Stream& in, Vec4Stream& out, size_t threads = 1);
+
+} // namespace gszauer
@@ -0,0 +1,373 @@
+#include "SoftRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace headless {
+
+namespace {
+
+struct Color
+{
+    float r, g, b, a;
+};
+
+Color unpack(uint32_t c)
+{
+    constexpr float k = 1.f / 255.f;
+    return { float((c >> IM_COL32_R_SHIFT) & 0xff) * k, float((c >> IM_COL32_G_SHIFT) & 0xff) * k,
+             float((c >> IM_COL32_B_SHIFT) & 0xff) * k, float((c >> IM_COL32_A_SHIFT) & 0xff) * k };
+}
+
+uint32_t pack(const Color& c)
+{
+    auto byte = [](float v) { return uint32_t(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f); };
+    return (byte(c.r) << IM_COL32_R_SHIFT) | (byte(c.g) << IM_COL32_G_SHIFT) |
+           (byte(c.b) << IM_COL32_B_SHIFT) | (byte(c.a) << IM_COL32_A_SHIFT);
+}
+
+Color modulate(const Color& a, const Color& b)
+{
+    return { a.r * b.r, a.g * b.g, a.b * b.b, a.a * b.a };
+}
+
+// x / 255 rounded, exact for x <= 255 * 255
+uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// A source color ready for the DX11 backend blend state, rgb SrcAlpha /
+// InvSrcAlpha and alpha One / InvSrcAlpha, in 8 bit integer math.
+struct Source
+{
+    uint32_t color;      // packed, written as is when opaque
+    uint32_t r, g, b, a; // rgb premultiplied by a, scaled by 255
+    uint32_t inv;        // 255 - a
+};
+
+Source source(const Color& c)
+{
+    const uint32_t color = pack(c);
+    const uint32_t a = (color >> IM_COL32_A_SHIFT) & 0xff;
+    return { color, ((color >> IM_COL32_R_SHIFT) & 0xff) * a, ((color >> IM_COL32_G_SHIFT) & 0xff) * a,
+             ((color >> IM_COL32_B_SHIFT) & 0xff) * a, a * 255, 255 - a };
+}
+
+void blend(uint32_t& dst, const Source& src)
+{
+    if (src.inv == 0) {
+        dst = src.color;
+        return;
+    }
+    if (src.inv == 255)
+        return;
+    const uint32_t d = dst;
+    dst = (div255(src.r + ((d >> IM_COL32_R_SHIFT) & 0xff) * src.inv) << IM_COL32_R_SHIFT) |
+          (div255(src.g + ((d >> IM_COL32_G_SHIFT) & 0xff) * src.inv) << IM_COL32_G_SHIFT) |
+          (div255(src.b + ((d >> IM_COL32_B_SHIFT) & 0xff) * src.inv) << IM_COL32_B_SHIFT) |
+          (div255(src.a + ((d >> IM_COL32_A_SHIFT) & 0xff) * src.inv) << IM_COL32_A_SHIFT);
+}
+
+Color sample(const Image* texture, const ImVec2& uv)
+{
+    if (!texture)
+        return { 1.f, 1.f, 1.f, 1.f };
+    const int x = std::clamp(int(uv.x * float(texture->width)), 0, texture->width - 1);
+    const int y = std::clamp(int(uv.y * float(texture->height)), 0, texture->height - 1);
+    return unpack(texture->at(x, y));
+}
+
+// pixel rectangle [x0, x1) x [y0, y1)
+struct Rect
+{
+    int x0, y0, x1, y1;
+};
+
+struct Edge
+{
+    ImVec2 a;
+    float dx, dy;
+    bool owns;      // whether pixels exactly on the edge belong to this triangle
+};
+
+// Oriented so the inside is positive. Of two triangles sharing an edge,
+// which then run it in opposite directions, exactly one owns it, so
+// translucent meshes are not blended twice along their seams.
+Edge makeEdge(const ImVec2& a, const ImVec2& b)
+{
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    return { a, dx, dy, dy < 0.f || (dy == 0.f && dx > 0.f) };
+}
+
+bool inside(float w, const Edge& e)
+{
+    return w > 0.f || (w == 0.f && e.owns);
+}
+
+void drawTriangle(const ImDrawVert* v[3], const ImVec2 p[3], const Image* texture,
+                  const Rect& clip, Image& target)
+{
+    const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (area == 0.f || std::isnan(area))
+        return;
+
+    // counter clockwise in y down coordinates, so every edge function is
+    // positive inside
+    int i1 = 1, i2 = 2;
+    if (area < 0.f)
+        std::swap(i1, i2);
+    const float invArea = 1.f / std::fabs(area);
+
+    // edge k is opposite to vertex k and weighs it
+    const Edge e[3] = { makeEdge(p[i1], p[i2]), makeEdge(p[i2], p[0]), makeEdge(p[0], p[i1]) };
+    const ImDrawVert* vert[3] = { v[0], v[i1], v[i2] };
+
+    const Rect r = {
+        std::max(clip.x0, int(std::floor(std::min({ p[0].x, p[1].x, p[2].x })))),
+        std::max(clip.y0, int(std::floor(std::min({ p[0].y, p[1].y, p[2].y })))),
+        std::min(clip.x1, int(std::ceil(std::max({ p[0].x, p[1].x, p[2].x })))),
+        std::min(clip.y1, int(std::ceil(std::max({ p[0].y, p[1].y, p[2].y })))),
+    };
+    if (r.x0 >= r.x1 || r.y0 >= r.y1)
+        return;
+
+    // most ImGui triangles are solid, same color and the white texel on
+    // every corner; only anti aliasing fringes and glyphs interpolate
+    const bool flat = vert[0]->col == vert[1]->col && vert[0]->col == vert[2]->col &&
+                      vert[0]->uv.x == vert[1]->uv.x && vert[0]->uv.x == vert[2]->uv.x &&
+                      vert[0]->uv.y == vert[1]->uv.y && vert[0]->uv.y == vert[2]->uv.y;
+    const Source flatColor = flat ? source(modulate(unpack(vert[0]->col), sample(texture, vert[0]->uv))) : Source{};
+    const Color c[3] = { unpack(vert[0]->col), unpack(vert[1]->col), unpack(vert[2]->col) };
+
+    for (int y = r.y0; y < r.y1; ++y) {
+        const float py = float(y) + 0.5f;
+        // evaluated per pixel rather than stepped, so the two sides of a
+        // shared edge see bit identical values
+        const float row[3] = { e[0].dx * (py - e[0].a.y), e[1].dx * (py - e[1].a.y), e[2].dx * (py - e[2].a.y) };
+
+        // Span of the row where every edge function can be positive. Fans
+        // of thin triangles, as ImGui fills rounded rectangles, would
+        // otherwise scan their whole bounding box. One pixel of slack on
+        // each side, the exact test below has the last word.
+        float lo = float(r.x0), hi = float(r.x1);
+        for (int k = 0; k < 3; ++k) {
+            if (e[k].dy == 0.f) {
+                if (row[k] < 0.f)
+                    lo = hi;
+                continue;
+            }
+            const float px = e[k].a.x + row[k] / e[k].dy;
+            if (e[k].dy > 0.f)
+                hi = std::min(hi, px + 1.f);
+            else
+                lo = std::max(lo, px - 1.f);
+        }
+        if (!(lo < hi))
+            continue;
+
+        uint32_t* dst = &target.at(0, y);
+        const int x0 = std::max(r.x0, int(lo));
+        const int x1 = std::min(r.x1, int(hi) + 1);
+        for (int x = x0; x < x1; ++x) {
+            const float px = float(x) + 0.5f;
+            const float w0 = row[0] - e[0].dy * (px - e[0].a.x);
+            const float w1 = row[1] - e[1].dy * (px - e[1].a.x);
+            const float w2 = row[2] - e[2].dy * (px - e[2].a.x);
+            if (!inside(w0, e[0]) || !inside(w1, e[1]) || !inside(w2, e[2]))
+                continue;
+            if (flat) {
+                blend(dst[x], flatColor);
+                continue;
+            }
+            const float l0 = w0 * invArea, l1 = w1 * invArea, l2 = w2 * invArea;
+            const ImVec2 uv(l0 * vert[0]->uv.x + l1 * vert[1]->uv.x + l2 * vert[2]->uv.x,
+                            l0 * vert[0]->uv.y + l1 * vert[1]->uv.y + l2 * vert[2]->uv.y);
+            const Color col = { l0 * c[0].r + l1 * c[1].r + l2 * c[2].r, l0 * c[0].g + l1 * c[1].g + l2 * c[2].g,
+                                l0 * c[0].b + l1 * c[1].b + l2 * c[2].b, l0 * c[0].a + l1 * c[1].a + l2 * c[2].a };
+            blend(dst[x], source(modulate(col, sample(texture, uv))));
+        }
+    }
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.insert(out.end(), { uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v) });
+}
+
+void writeChunk(std::ostream& out, const char type[4], const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    putBE32(chunk, uint32_t(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    out.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size()));
+}
+
+} // namespace
+
+void createFontsTexture(ImFontAtlas& atlas, Image& texture)
+{
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    texture = Image(width, height);
+    std::memcpy(texture.pixels.data(), pixels, texture.pixels.size() * sizeof(uint32_t));
+    atlas.SetTexID(static_cast<ImTextureID>(&texture));
+}
+
+void clear(Image& target, const ImVec4& color)
+{
+    std::fill(target.pixels.begin(), target.pixels.end(), pack({ color.x, color.y, color.z, color.w }));
+}
+
+void renderDrawData(const ImDrawData& data, Image& target)
+{
+    const ImVec2 offset = data.DisplayPos;
+    const ImVec2 scale = data.FramebufferScale;
+
+    std::vector<ImVec2> positions;
+    for (int n = 0; n < data.CmdListsCount; ++n) {
+        const ImDrawList* list = data.CmdLists[n];
+
+        // framebuffer positions, transformed once per list
+        positions.resize(size_t(list->VtxBuffer.Size));
+        for (int i = 0; i < list->VtxBuffer.Size; ++i) {
+            const ImVec2& pos = list->VtxBuffer[i].pos;
+            positions[size_t(i)] = ImVec2((pos.x - offset.x) * scale.x, (pos.y - offset.y) * scale.y);
+        }
+
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            if (cmd.UserCallback) {
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState)
+                    cmd.UserCallback(list, &cmd);
+                continue;
+            }
+
+            // truncated like the DX11 scissor rectangle
+            const Rect clip = {
+                std::max(0, int((cmd.ClipRect.x - offset.x) * scale.x)),
+                std::max(0, int((cmd.ClipRect.y - offset.y) * scale.y)),
+                std::min(target.width, int((cmd.ClipRect.z - offset.x) * scale.x)),
+                std::min(target.height, int((cmd.ClipRect.w - offset.y) * scale.y)),
+            };
+            if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1)
+                continue;
+
+            const Image* texture = static_cast<const Image*>(cmd.TextureId);
+            const ImDrawIdx* idx = list->IdxBuffer.Data + cmd.IdxOffset;
+            for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                const ImDrawVert* v[3];
+                ImVec2 p[3];
+                for (int k = 0; k < 3; ++k) {
+                    const unsigned int vi = cmd.VtxOffset + idx[i + k];
+                    v[k] = &list->VtxBuffer[int(vi)];
+                    p[k] = positions[vi];
+                }
+                drawTriangle(v, p, texture, clip, target);
+            }
+        }
+    }
+}
+
+bool writePPM(const std::string& path, const Image& image)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    out << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+    std::vector<uint8_t> row(size_t(image.width) * 3);
+    for (int y = 0; y < image.height; ++y) {
+        for (int x = 0; x < image.width; ++x) {
+            const uint32_t c = image.at(x, y);
+            row[size_t(x) * 3 + 0] = uint8_t(c >> IM_COL32_R_SHIFT);
+            row[size_t(x) * 3 + 1] = uint8_t(c >> IM_COL32_G_SHIFT);
+            row[size_t(x) * 3 + 2] = uint8_t(c >> IM_COL32_B_SHIFT);
+        }
+        out.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size()));
+    }
+    return bool(out);
+}
+
+bool writePNG(const std::string& path, const Image& image)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    putBE32(header, uint32_t(image.width));
+    putBE32(header, uint32_t(image.height));
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });     // 8 bit RGBA, no interlace
+    writeChunk(out, "IHDR", header);
+
+    // scanlines with filter type 0
+    std::vector<uint8_t> raw;
+    raw.reserve(size_t(image.height) * (size_t(image.width) * 4 + 1));
+    for (int y = 0; y < image.height; ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < image.width; ++x) {
+            const uint32_t c = image.at(x, y);
+            raw.insert(raw.end(), { uint8_t(c >> IM_COL32_R_SHIFT), uint8_t(c >> IM_COL32_G_SHIFT),
+                                    uint8_t(c >> IM_COL32_B_SHIFT), uint8_t(c >> IM_COL32_A_SHIFT) });
+        }
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    size_t pos = 0;
+    do {
+        const size_t len = std::min<size_t>(raw.size() - pos, 0xffff);
+        const bool last = pos + len == raw.size();
+        z.insert(z.end(), { uint8_t(last), uint8_t(len), uint8_t(len >> 8),
+                            uint8_t(~len), uint8_t(~len >> 8) });
+        z.insert(z.end(), raw.begin() + ptrdiff_t(pos), raw.begin() + ptrdiff_t(pos + len));
+        pos += len;
+    } while (pos < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(z, (b << 16) | a);
+    writeChunk(out, "IDAT", z);
+    writeChunk(out, "IEND", {});
+    return bool(out);
+}
+
+bool writeImage(const std::string& path, const Image& image)
+{
+    const bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+    return ppm ? writePPM(path, image) : writePNG(path, image);
+}
+
+} // namespace headless
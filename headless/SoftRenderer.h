@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+// CPU renderer for ImDrawData, the headless counterpart of
+// imgui_impl_dx11. Triangles are filled with the same blend state as the
+// DX11 backend (straight alpha, SrcAlpha / InvSrcAlpha) and textures are
+// sampled with nearest filtering, which is exact for the 1:1 font atlas.
+//
+//     headless::Image fonts, frame(1280, 800);
+//     headless::createFontsTexture(*io.Fonts, fonts);
+//     ...
+//     ImGui::Render();
+//     headless::clear(frame, clear_color);
+//     headless::renderDrawData(*ImGui::GetDrawData(), frame);
+//     headless::writeImage("frame.png", frame);
+
+namespace headless {
+
+// RGBA8 pixels, row major from the top, used for textures and targets
+struct Image
+{
+    Image() = default;
+    Image(int w, int h) : width(w), height(h), pixels(size_t(w) * h, 0) {}
+
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;   // IM_COL32 layout, R in the low byte
+
+    uint32_t& at(int x, int y) { return pixels[size_t(y) * width + x]; }
+    uint32_t at(int x, int y) const { return pixels[size_t(y) * width + x]; }
+};
+
+// Builds the atlas as RGBA32 into `texture` and sets it as the atlas
+// TexID. `texture` has to outlive the draw data rendered with it.
+void createFontsTexture(ImFontAtlas& atlas, Image& texture);
+
+void clear(Image& target, const ImVec4& color);
+
+// Draws every command list into `target`, which maps to data.DisplayPos
+// and data.DisplaySize * data.FramebufferScale. Commands with a null
+// TexID are drawn untextured.
+void renderDrawData(const ImDrawData& data, Image& target);
+
+// Binary PPM (P6) and PNG (RGBA, stored without compression, so large but
+// dependency free). Return false if the file can't be written.
+bool writePPM(const std::string& path, const Image& image);
+bool writePNG(const std::string& path, const Image& image);
+
+// picks the format from the extension, PNG unless it is .ppm
+bool writeImage(const std::string& path, const Image& image);
+
+} // namespace headless
@@ -0,0 +1,153 @@
+// Headless build of the app: runs the plots through ImGui at a fixed display
+// size without a window or GPU and rasterizes the frames on the CPU.
+//
+//     TestCurvesHeadless [--size 1280x800] [--frames 60] [--out plots.png]
+//                        [--profiler] [--trace <frames> <file>]
+//                        [--atlas-cache <file>] [--idle]
+//
+// Writes the last frame to --out (.png or .ppm) and prints the average frame
+// times, for plot regression images and benchmarks on machines without a
+// display. --atlas-cache keeps the built font atlas in a file for the next
+// run, see plot/FontAtlasCache.h. --idle runs the frames through the idle
+// mode of the Win32 app, see plot/FrameScheduler.h; without input only the
+// first few are drawn.
+
+#include <imgui.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "SoftRenderer.h"
+#include "../plot/FrameArena.h"
+#include "../plot/FrameScheduler.h"
+#include "../plot/Markers.h"
+#include "../plot/Plots.h"
+#include "../profiler/ChromeTrace.h"
+#include "../profiler/Profiler.h"
+#include "../profiler/ProfilerWindow.h"
+
+int main(int argc, char** argv)
+{
+    int width = 1280, height = 800;
+    int frames = 60;
+    const char* out = "plots.png";
+    bool show_profiler = false;
+    const char* atlas_cache = NULL;
+    bool idle = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "bad --size %s, expected WxH\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--atlas-cache") == 0 && i + 1 < argc) {
+            atlas_cache = argv[++i];
+        } else if (strcmp(argv[i], "--idle") == 0) {
+            idle = true;
+        } else if (strcmp(argv[i], "--profiler") == 0) {
+            show_profiler = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 2 < argc) {
+            profiler::captureChromeTrace(size_t(atoi(argv[i + 1])), argv[i + 2]);
+            i += 2;
+        } else {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+    // ImGui lays windows out over the first frames
+    frames = frames < 3 ? 3 : frames;
+    FrameScheduler& scheduler = frameScheduler();
+    scheduler.setEnabled(idle);
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    InstallFrameArena(ImGui::GetCurrentContext());
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = NULL;  // same layout on every run
+    io.DisplaySize = ImVec2(float(width), float(height));
+    io.DeltaTime = 1.f / 60.f;
+    io.BackendRendererName = "headless";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+    ImGui::StyleColorsDark();
+
+    const uint64_t atlasStart = profiler::now();
+    const bool atlasCached = AddMarkerSprites(io.Fonts, atlas_cache);
+    const uint64_t atlasTime = profiler::now() - atlasStart;
+    headless::Image fonts;
+    headless::createFontsTexture(*io.Fonts, fonts);
+    headless::Image target(width, height);
+    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+
+    profiler::setThreadName("main");
+
+    uint64_t uiTime = 0, rasterTime = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        if (!scheduler.frameDue(io))
+            continue;
+
+        profiler::beginFrame();
+        const uint64_t t0 = profiler::now();
+
+        {
+            PROFILE_SCOPE("NewFrame");
+            scheduler.beginFrame(io);
+            io.DeltaTime = 1.f / 60.f;  // fixed steps keep the images reproducible
+            ImGui::NewFrame();
+        }
+
+        // the Win32 app leaves placement to ImGui, which stacks the windows
+        ImGui::SetNextWindowPos(ImVec2(480.f, 60.f), ImGuiCond_FirstUseEver);
+        ShowBezierPlot();
+        ShowSlerpPlot();
+        ImGui::SetNextWindowPos(ImVec2(820.f, 60.f), ImGuiCond_FirstUseEver);
+        ShowTrackPlot();
+        ImGui::SetNextWindowPos(ImVec2(820.f, 420.f), ImGuiCond_FirstUseEver);
+        ShowScatterPlot();
+        ImGui::SetNextWindowPos(ImVec2(480.f, 420.f), ImGuiCond_FirstUseEver);
+        ShowCurvesPlot();
+        if (show_profiler)
+            profiler::ShowProfilerWindow(&show_profiler);
+
+        {
+            PROFILE_SCOPE("Render");
+            ImGui::Render();
+        }
+        scheduler.endFrame(io);
+        PROFILE_COUNTER("vertices", ImGui::GetDrawData()->TotalVtxCount);
+        PROFILE_COUNTER("frame arena", frameArena().used());
+        const uint64_t t1 = profiler::now();
+
+        {
+            PROFILE_SCOPE("RenderDrawData");
+            headless::clear(target, clear_color);
+            headless::renderDrawData(*ImGui::GetDrawData(), target);
+        }
+        const uint64_t t2 = profiler::now();
+
+        uiTime += t1 - t0;
+        rasterTime += t2 - t1;
+    }
+    profiler::beginFrame();
+
+    const int drawn = int(scheduler.framesDrawn());
+    printf("%d frames at %dx%d: ui %.3f ms, raster %.3f ms per frame\n", drawn, width, height,
+        double(uiTime) / drawn * 1e-6, double(rasterTime) / drawn * 1e-6);
+    if (idle)
+        printf("idle: %d of %d frames drawn\n", drawn, frames);
+    printf("font atlas %s in %.3f ms\n", atlasCached ? "loaded" : "built", double(atlasTime) * 1e-6);
+    printf("frame arena: peak %zu KiB in %zu KiB, %zu heap blocks\n", frameArena().peak() / 1024,
+        frameArena().capacity() / 1024, frameArena().heapAllocations());
+
+    ImGui::DestroyContext();
+
+    if (!headless::writeImage(out, target)) {
+        fprintf(stderr, "can't write %s\n", out);
+        return 1;
+    }
+    return 0;
+}
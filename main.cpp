@@ -15,14 +15,16 @@
 #define DIRECTINPUT_VERSION 0x0800
 #include <dinput.h>
 #include <tchar.h>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
-#include "gszauer/Vec2.h"
-#include "gszauer/Vec3.h"
-#include "gszauer/Vec4.h"
-
-const vec4 white(1.f, 1.f, 1.f, 1.f);
-const vec4 pink(1.00f, 0.00f, 0.75f, 1.0f);
-const vec4 cyan(0.00f, 0.75f, 1.00f, 1.0f);
+#include "plot/FrameArena.h"
+#include "plot/FrameScheduler.h"
+#include "plot/Markers.h"
+#include "plot/Plots.h"
+#include "profiler/ChromeTrace.h"
+#include "profiler/Profiler.h"
+#include "profiler/ProfilerWindow.h"
 
 // Data
 static ID3D11Device*            g_pd3dDevice = NULL;
@@ -37,212 +39,19 @@ void CreateRenderTarget();
 void CleanupRenderTarget();
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-struct ImGuiGrid
-{
-    enum { LINE_WIDTH = 1 }; // handlers: small lines width
-    enum { GRAB_RADIUS = 8 }; // handlers: circle radius
-    enum { GRAB_BORDER = 2 }; // handlers: circle border width
-    enum { GRAB_SMALL_RADIUS = 3 };
-    enum { AREA_CONSTRAINED = true }; // should grabbers be constrained to grid area?
-    enum { AREA_WIDTH = 256 }; // area width in pixels. 0 for adaptive size (will use max avail width)
-
-    bool drawGrid();
-    bool drawLine(vec2 a, vec2 b, vec4 c);
-    bool drawLine(vec3 a, vec3 b, vec4 c);
-    bool drawPoint(vec2 p, vec4 c);
-    bool drawPoint(vec3 p, vec4 c);
-    bool drawSmallPoint(vec3 p, vec4 c);
-
-    ImVec2 scalePosition(vec2 p);
-
-    vec2 mgmin = vec2(0.f);
-    vec2 mgmax = vec2(1.f);
-
-    ImVec2 mCanvas;
-    ImRect mbb;
-};
-
-bool ImGuiGrid::drawGrid()
-{
-    using namespace ImGui;
-
-    // prepare canvas
-    const float avail = GetContentRegionAvailWidth();
-    const float dim = AREA_WIDTH > 0 ? AREA_WIDTH : avail;
-
-    ImVec2 Canvas(dim, dim);
-    const ImGuiStyle& Style = GetStyle();
-
-    ImDrawList* DrawList = GetWindowDrawList();
-    ImGuiWindow* Window = GetCurrentWindow();
-    if (Window->SkipItems)
-        return false;
-
-    ImRect bb = ImRect(Window->DC.CursorPos, Window->DC.CursorPos + Canvas);
-    ItemSize(bb);
-    if (!ItemAdd(bb, NULL))
-        return false;
-
-    RenderFrame(bb.Min, bb.Max, GetColorU32(ImGuiCol_FrameBg, 1), true, Style.FrameRounding);
-
-    // background grid
-    for (int i = 0; i <= Canvas.x; i += (Canvas.x / 8)) {
-        DrawList->AddLine(
-            ImVec2(bb.Min.x + i, bb.Min.y),
-            ImVec2(bb.Min.x + i, bb.Max.y),
-            GetColorU32(ImGuiCol_TextDisabled));
-    }
-    for (int i = 0; i <= Canvas.y; i += (Canvas.y / 8)) {
-        DrawList->AddLine(
-            ImVec2(bb.Min.x, bb.Min.y + i),
-            ImVec2(bb.Max.x, bb.Min.y + i),
-            GetColorU32(ImGuiCol_TextDisabled));
-    }
-
-    mbb = bb;
-    mCanvas = Canvas;
-
-    return true;
-}
-
-bool ImGuiGrid::drawLine(vec2 a, vec2 b, vec4 c)
-{
-    using namespace ImGui;
-
-    ImDrawList* DrawList = GetWindowDrawList();
-
-    float luma = IsItemActive() || IsItemHovered() ? 0.5f : 1.0f;
-
-    ImVec2 p1 = scalePosition(a);
-    ImVec2 p2 = scalePosition(b);
-    ImColor color(c.r, c.g, c.b, c.a);
-
-    DrawList->AddLine(p1, p2, color, LINE_WIDTH);
-
-    return true;
-}
-
-bool ImGuiGrid::drawPoint(vec2 p, vec4 c)
-{
-    using namespace ImGui;
-
-    ImVec4 white(GetStyle().Colors[ImGuiCol_Text]);
-
-    ImDrawList* DrawList = GetWindowDrawList();
-
-    ImVec2 pos = scalePosition(p);
-    ImColor color(c.r, c.g, c.b, c.a);
-
-    DrawList->AddCircleFilled(pos, GRAB_RADIUS, ImColor(white));
-    DrawList->AddCircleFilled(pos, GRAB_RADIUS - GRAB_BORDER, color);
-
-    return true;
-}
-
-bool ImGuiGrid::drawLine(vec3 a, vec3 b, vec4 c)
-{
-    return drawLine(vec2(a), vec2(b), c);
-}
-
-bool ImGuiGrid::drawPoint(vec3 p, vec4 c)
-{
-    return drawPoint(vec2(p), c);
-}
-
-bool ImGuiGrid::drawSmallPoint(vec3 p, vec4 c)
-{
-    using namespace ImGui;
-
-    ImVec4 white(GetStyle().Colors[ImGuiCol_Text]);
-
-    ImDrawList* DrawList = GetWindowDrawList();
-
-    ImVec2 pos = scalePosition(p);
-    ImColor color(c.r, c.g, c.b, c.a);
-
-    DrawList->AddCircleFilled(pos, GRAB_SMALL_RADIUS, color);
-
-    return true;
-}
-
-ImVec2 ImGuiGrid::scalePosition(vec2 p)
-{
-    vec2 npos = (p - mgmin) / (mgmax - mgmin);
-    return ImVec2(npos.x, 1 - npos.y) * (mbb.Max - mbb.Min) + mbb.Min;
-}
-
-void ShowBezierPlot()
-{
-    ImGui::Begin("Bezier curve");
-    ImGui::Text("Curve");
-
-    auto p1 = vec3(-5.f, 0.f, 0.f);
-    auto p2 = vec3(+5.f, 0.f, 0.f);
-    auto c1 = vec3(-2.f, 1.f, 0.f);
-    auto c2 = vec3(+2.f, 1.f, 0.f);
-
-    auto red = vec4(1.f, 0.f, 0.f, 1.f);
-    auto green = vec4(0.f, 1.f, 0.f, 1.f);
-    auto blue = vec4(0.f, 0.f, 1.f, 1.f);
-    auto magenta = vec4(1.f, 0.f, 1.f, 1.f);
-
-    ImGuiGrid grid;
-    grid.mgmin = vec2(-5.f);
-    grid.mgmax = vec2(+5.f);
-    grid.drawGrid();
-
-    gszauer::Bezier<vec3> curve;
-    curve.P1 = p1;
-    curve.P2 = p2;
-    curve.C1 = c1;
-    curve.C2 = c2;
-
-    static const int count = 200;
-    for (int i = 0; i < count; i++) {
-        float t0 = (float)(i + 0) / count;
-        float t1 = (float)(i + 1) / count;
-        auto k0 = interpolate(curve, t0);
-        auto k1 = interpolate(curve, t1);
-        grid.drawLine(k0, k1, magenta);
-    }
-
-    grid.drawLine(p1, c1, white);
-    grid.drawLine(p2, c2, white);
-    grid.drawPoint(p1, red);
-    grid.drawPoint(c1, green);
-    grid.drawPoint(p2, red);
-    grid.drawPoint(c2, green);
-
-    ImGui::End();
-}
-
-void ShowSlerpPlot()
+// Main code
+// --trace <frames> <file> writes a Chrome trace of the first frames
+// --continuous draws every frame instead of idling while nothing changes
+int main(int argc, char** argv)
 {
-    using gszauer::slerp;
-
-    ImGuiGrid grid;
-    grid.mgmin = vec2(0.f);
-    grid.mgmax = vec2(+10.f);
-    grid.drawGrid();
-
-    auto o = vec3(0.f, 0.f, 0.f);
-    auto s = vec3(0.f, 10.f, 0.f);
-    auto e = vec3(10.f, 0.f, 0.f);
-    auto l = len(s - o);
-
-    static const int k = 30;
-    float d = 1.f / k;
-    for (int i = 0; i < k; i++) {
-        vec3 a = slerp(s, e, d*i) * (l * 0.9f);
-        vec3 b = nlerp(s, e, d*i) * l;
-        grid.drawSmallPoint(b, cyan);
-        grid.drawSmallPoint(a, pink);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--trace") == 0 && i + 2 < argc)
+            profiler::captureChromeTrace(size_t(atoi(argv[i + 1])), argv[i + 2]);
+        else if (strcmp(argv[i], "--continuous") == 0)
+            frameScheduler().setEnabled(false);
     }
-}
 
-// Main code
-int main(int, char**)
-{
     // Create application window
     //ImGui_ImplWin32_EnableDpiAwareness();
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(NULL), NULL, NULL, NULL, NULL, _T("ImGui Example"), NULL };
@@ -265,6 +74,7 @@ int main(int, char**)
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
+    InstallFrameArena(ImGui::GetCurrentContext());
     //io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
 
@@ -291,11 +101,18 @@ int main(int, char**)
     //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL, io.Fonts->GetGlyphRangesJapanese());
     //IM_ASSERT(font != NULL);
 
+    // Plot markers are sprites in the font atlas, baked before the backend uploads it.
+    // The built atlas is cached next to imgui.ini, later launches skip rasterizing the fonts.
+    AddMarkerSprites(io.Fonts, "imgui_atlas.bin");
+
     // Our state
     bool show_demo_window = true;
     bool show_another_window = false;
+    bool show_profiler = true;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
+    profiler::setThreadName("main");
+
     // Main loop
     MSG msg;
     ZeroMemory(&msg, sizeof(msg));
@@ -313,20 +130,55 @@ int main(int, char**)
             continue;
         }
 
-        // Start the Dear ImGui frame
+        // The backends only poll the mouse, window size and clock here, the
+        // frame itself starts with ImGui::NewFrame(). Nothing is built,
+        // rendered or presented until the input changes or a plot asks for
+        // a frame; meanwhile the thread sleeps until the next message.
+        FrameScheduler& scheduler = frameScheduler();
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
-        ImGui::NewFrame();
+        if (!scheduler.frameDue(io))
+        {
+            const uint64_t timeout = scheduler.timeout();
+            const DWORD ms = timeout == UINT64_MAX ? INFINITE : DWORD((timeout + 999999) / 1000000);
+            ::MsgWaitForMultipleObjectsEx(0, NULL, ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            continue;
+        }
+
+        profiler::beginFrame();
+
+        // Start the Dear ImGui frame
+        {
+            PROFILE_SCOPE("NewFrame");
+            scheduler.beginFrame(io);
+            ImGui::NewFrame();
+        }
 
         ShowBezierPlot();
         ShowSlerpPlot();
+        ShowTrackPlot();
+        ShowScatterPlot();
+        ShowCurvesPlot();
+        if (show_profiler)
+            profiler::ShowProfilerWindow(&show_profiler);
 
         // Rendering
-        ImGui::Render();
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, NULL);
-        g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, (float*)&clear_color);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        {
+            PROFILE_SCOPE("Render");
+            ImGui::Render();
+        }
+        scheduler.endFrame(io);
+        PROFILE_COUNTER("vertices", ImGui::GetDrawData()->TotalVtxCount);
+        PROFILE_COUNTER("frame arena", frameArena().used());
+        {
+            PROFILE_SCOPE("RenderDrawData");
+            g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, NULL);
+            g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, (float*)&clear_color);
+            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        }
 
+        // includes the wait for vsync
+        PROFILE_SCOPE("Present");
         g_pSwapChain->Present(1, 0); // Present with vsync
         //g_pSwapChain->Present(0, 0); // Present without vsync
     }
@@ -405,6 +257,7 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
         return true;
 
+    static bool tracking_mouse = false;
     switch (msg)
     {
     case WM_SIZE:
@@ -413,8 +266,24 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
             CleanupRenderTarget();
             g_pSwapChain->ResizeBuffers(0, (UINT)LOWORD(lParam), (UINT)HIWORD(lParam), DXGI_FORMAT_UNKNOWN, 0);
             CreateRenderTarget();
+            frameScheduler().wake();
         }
         return 0;
+    case WM_PAINT:
+        // uncovered or restored, the default handler validates the window
+        frameScheduler().wake();
+        break;
+    case WM_MOUSEMOVE:
+        // ask for WM_MOUSELEAVE, so hover state clears in idle mode too
+        if (!tracking_mouse)
+        {
+            TRACKMOUSEEVENT tme = { sizeof(tme), TME_LEAVE, hWnd, 0 };
+            tracking_mouse = ::TrackMouseEvent(&tme) != FALSE;
+        }
+        break;
+    case WM_MOUSELEAVE:
+        tracking_mouse = false;
+        break;
     case WM_SYSCOMMAND:
         if ((wParam & 0xfff0) == SC_KEYMENU) // Disable ALT application menu
             return 0;
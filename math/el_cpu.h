@@ -0,0 +1,101 @@
+#ifndef __EL_CPU_H__
+#define __EL_CPU_H__
+
+#include <cstdint>
+
+#include "el_platform.h"
+
+#if EL_ARCH_X86
+#   if EL_COMP_MSVC
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
+namespace el {
+
+// Instruction sets of the CPU the program runs on, as opposed to the
+// EL_SIMD_* macros which describe what a translation unit was compiled for.
+// AVX levels also require the OS to save the wider registers.
+struct CpuFeatures
+{
+    bool sse41 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+};
+
+namespace details {
+
+#if EL_ARCH_X86
+
+inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) noexcept
+{
+#if EL_COMP_MSVC
+    int r[4];
+    __cpuidex(r, int(leaf), int(subleaf));
+    for (int i = 0; i < 4; ++i)
+        regs[i] = uint32_t(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline uint64_t xgetbv0() noexcept
+{
+#if EL_COMP_MSVC
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (uint64_t(hi) << 32) | lo;
+#endif
+}
+
+#endif // EL_ARCH_X86
+
+inline CpuFeatures detectCpuFeatures() noexcept
+{
+    CpuFeatures f;
+#if EL_ARCH_X86
+    uint32_t r[4];
+    cpuid(0, 0, r);
+    const uint32_t maxLeaf = r[0];
+    if (maxLeaf < 1)
+        return f;
+
+    cpuid(1, 0, r);
+    f.sse41 = (r[2] >> 19) & 1;
+    const bool osxsave = (r[2] >> 27) & 1;
+
+    // XCR0: SSE and AVX state for ymm, plus opmask and zmm state for AVX-512
+    const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+    const bool ymm = (xcr0 & 0x06) == 0x06;
+    const bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+    f.avx = ymm && ((r[2] >> 28) & 1);
+    f.fma = f.avx && ((r[2] >> 12) & 1);
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, r);
+        f.avx2 = f.avx && ((r[1] >> 5) & 1);
+        f.avx512f = zmm && f.avx2 && ((r[1] >> 16) & 1);
+    }
+#endif
+    return f;
+}
+
+} // namespace details
+
+// detected on first call
+inline const CpuFeatures& cpuFeatures() noexcept
+{
+    static const CpuFeatures features = details::detectCpuFeatures();
+    return features;
+}
+
+} // namespace el
+
+#endif // __EL_CPU_H__
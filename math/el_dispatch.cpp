@@ -0,0 +1,82 @@
+#include "el_dispatch.h"
+
+#include <atomic>
+
+#include "el_cpu.h"
+#include "el_simd.h"
+
+namespace el {
+namespace dispatch {
+
+const Kernels& baselineKernels() noexcept
+{
+    static const Kernels kernels = EL_DISPATCH_KERNEL_TABLE;
+    return kernels;
+}
+
+} // namespace dispatch
+
+namespace {
+
+const dispatch::Kernels& kernelsFor(SimdLevel level) noexcept
+{
+    const dispatch::Kernels* kernels = nullptr;
+    if (level == SimdLevel::AVX512)
+        kernels = dispatch::avx512Kernels();
+    else if (level == SimdLevel::AVX2)
+        kernels = dispatch::avx2Kernels();
+    return kernels ? *kernels : dispatch::baselineKernels();
+}
+
+std::atomic<SimdLevel>& currentLevel() noexcept
+{
+    static std::atomic<SimdLevel> level{ bestSimdLevel() };
+    return level;
+}
+
+} // namespace
+
+const char* toString(SimdLevel level) noexcept
+{
+    switch (level) {
+    case SimdLevel::AVX512: return "AVX-512";
+    case SimdLevel::AVX2:   return "AVX2";
+    default:                return "baseline";
+    }
+}
+
+SimdLevel bestSimdLevel() noexcept
+{
+    static const SimdLevel best = [] {
+        const CpuFeatures& cpu = cpuFeatures();
+        if (cpu.avx512f && cpu.fma && dispatch::avx512Kernels())
+            return SimdLevel::AVX512;
+        if (cpu.avx2 && cpu.fma && dispatch::avx2Kernels())
+            return SimdLevel::AVX2;
+        return SimdLevel::Baseline;
+    }();
+    return best;
+}
+
+SimdLevel simdLevel() noexcept
+{
+    return currentLevel().load(std::memory_order_relaxed);
+}
+
+SimdLevel setSimdLevel(SimdLevel level) noexcept
+{
+    if (level > bestSimdLevel())
+        level = bestSimdLevel();
+    currentLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+namespace dispatch {
+
+const Kernels& kernels() noexcept
+{
+    return kernelsFor(simdLevel());
+}
+
+} // namespace dispatch
+} // namespace el
@@ -0,0 +1,70 @@
+#ifndef __EL_DISPATCH_H__
+#define __EL_DISPATCH_H__
+
+#include <cstddef>
+
+namespace el {
+
+// Run-time selection of the batch kernels in el_simd.h.
+//
+// The kernels are compiled three times: with the program's own flags
+// (el_dispatch.cpp), for AVX2 + FMA (el_kernels_avx2.cpp) and for AVX-512
+// (el_kernels_avx512.cpp). On first use the best level the CPU supports is
+// picked, so one binary built for the baseline still runs the wide kernels
+// on newer hosts. Batch entry points such as transformPoints call through
+// dispatch::kernels(); the single-value math types are unaffected.
+
+enum class SimdLevel
+{
+    Baseline,   // whatever the program is compiled for, SSE2 on x86-64
+    AVX2,       // AVX2 + FMA
+    AVX512,     // AVX-512F
+};
+
+const char* toString(SimdLevel level) noexcept;
+
+// best level both this CPU and the build support
+SimdLevel bestSimdLevel() noexcept;
+
+// level the batch kernels currently use, bestSimdLevel() unless overridden
+SimdLevel simdLevel() noexcept;
+
+// Forces a lower level, e.g. to compare kernels. Requests above
+// bestSimdLevel() are clamped; returns the level now in use.
+SimdLevel setSimdLevel(SimdLevel level) noexcept;
+
+namespace dispatch {
+
+struct Kernels
+{
+    void (*transform3_aos)(const float* m, float w,
+        const float* in, float* out, size_t count) noexcept;
+    void (*transform3_soa)(const float* m, float w,
+        const float* x, const float* y, const float* z,
+        float* ox, float* oy, float* oz, size_t count) noexcept;
+    void (*normalize3_soa)(float* x, float* y, float* z, size_t count, float eps) noexcept;
+    void (*normalize3_soa_fast)(float* x, float* y, float* z, size_t count, float eps) noexcept;
+    void (*bezier3_soa)(const float p[12], const float* t,
+        float* ox, float* oy, float* oz, size_t count) noexcept;
+};
+
+// kernels of the current simdLevel()
+const Kernels& kernels() noexcept;
+
+// per level tables, nullptr when the unit was built without the needed flags
+const Kernels& baselineKernels() noexcept;
+const Kernels* avx2Kernels() noexcept;
+const Kernels* avx512Kernels() noexcept;
+
+} // namespace dispatch
+} // namespace el
+
+// the el::simd kernels as compiled in the including translation unit
+#define EL_DISPATCH_KERNEL_TABLE {      \
+    &el::simd::transform3_aos,          \
+    &el::simd::transform3_soa,          \
+    &el::simd::normalize3_soa,          \
+    &el::simd::normalize3_soa_fast,     \
+    &el::simd::bezier3_soa }
+
+#endif // __EL_DISPATCH_H__
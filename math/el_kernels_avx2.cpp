@@ -0,0 +1,19 @@
+// Built with AVX2 and FMA enabled (-mavx2 -mfma, /arch:AVX2), see el_dispatch.h.
+#include "el_dispatch.h"
+#include "el_simd.h"
+
+namespace el {
+namespace dispatch {
+
+const Kernels* avx2Kernels() noexcept
+{
+#if EL_SIMD_AVX2 && EL_SIMD_FMA
+    static const Kernels kernels = EL_DISPATCH_KERNEL_TABLE;
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace dispatch
+} // namespace el
@@ -0,0 +1,20 @@
+// Built with AVX-512F enabled (-mavx512f -mavx2 -mfma, /arch:AVX512), see
+// el_dispatch.h.
+#include "el_dispatch.h"
+#include "el_simd.h"
+
+namespace el {
+namespace dispatch {
+
+const Kernels* avx512Kernels() noexcept
+{
+#if EL_SIMD_AVX512
+    static const Kernels kernels = EL_DISPATCH_KERNEL_TABLE;
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace dispatch
+} // namespace el
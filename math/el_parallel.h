@@ -0,0 +1,48 @@
+#ifndef __EL_PARALLEL_H__
+#define __EL_PARALLEL_H__
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace el {
+
+// Splits [0, count) into contiguous ranges of at least `grain` elements and
+// runs fn(begin, end) on up to `threads` threads, the caller included.
+// threads == 0 picks std::thread::hardware_concurrency(). Range starts are
+// multiples of `grain`, so SIMD kernels only see a partial tail at the end.
+template <typename F>
+void parallel_for(size_t count, size_t threads, size_t grain, F&& fn)
+{
+    if (grain == 0)
+        grain = 1;
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    const size_t blocks = (count + grain - 1) / grain;
+    if (threads > blocks)
+        threads = blocks;
+    if (threads <= 1) {
+        if (count > 0)
+            fn(size_t(0), count);
+        return;
+    }
+
+    const size_t blocksPerThread = (blocks + threads - 1) / threads;
+    const size_t chunk = blocksPerThread * grain;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t begin = chunk; begin < count; begin += chunk) {
+        const size_t end = begin + chunk < count ? begin + chunk : count;
+        workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    fn(size_t(0), chunk < count ? chunk : count);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+} // namespace el
+
+#endif // __EL_PARALLEL_H__
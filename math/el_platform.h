@@ -17,6 +17,13 @@
 #define EL_PLAT_OSX 0
 #define EL_PLAT_TVOS 0
 
+#define EL_SIMD_SSE2 0
+#define EL_SIMD_SSE41 0
+#define EL_SIMD_AVX 0
+#define EL_SIMD_AVX2 0
+#define EL_SIMD_FMA 0
+#define EL_SIMD_AVX512 0
+
 // https://www.boost.org/doc/libs/1_66_0/doc/html/predef
 #if defined(__arm__) || defined(__arm64) || defined(__thumb__) || \
     defined(__TARGET_ARCH_ARM) || defined(__TARGET_ARCH_THUMB) || \
@@ -89,6 +96,38 @@
 #    endif
 #endif
 
+// Instruction sets the compiler is allowed to emit for this translation unit.
+// Define EL_DISABLE_SIMD to force the scalar code paths. What the running CPU
+// supports is a separate question, see el_cpu.h and el_dispatch.h.
+#if !defined(EL_DISABLE_SIMD)
+#   if EL_ARCH_X86_64 || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       undef EL_SIMD_SSE2
+#       define EL_SIMD_SSE2 1
+#   endif
+#   if EL_SIMD_SSE2 && defined(__AVX__)
+#       undef EL_SIMD_AVX
+#       define EL_SIMD_AVX 1
+#   endif
+// MSVC has no __SSE4_1__, /arch:AVX implies it
+#   if EL_SIMD_SSE2 && (defined(__SSE4_1__) || EL_SIMD_AVX)
+#       undef EL_SIMD_SSE41
+#       define EL_SIMD_SSE41 1
+#   endif
+#   if EL_SIMD_AVX && defined(__AVX2__)
+#       undef EL_SIMD_AVX2
+#       define EL_SIMD_AVX2 1
+#   endif
+// MSVC has no __FMA__, but every AVX2 target it knows about has FMA3
+#   if EL_SIMD_AVX && (defined(__FMA__) || defined(__AVX2__))
+#       undef EL_SIMD_FMA
+#       define EL_SIMD_FMA 1
+#   endif
+#   if EL_SIMD_AVX2 && EL_SIMD_FMA && defined(__AVX512F__)
+#       undef EL_SIMD_AVX512
+#       define EL_SIMD_AVX512 1
+#   endif
+#endif // EL_DISABLE_SIMD
+
 #define EL_PLAT_APPLE (0 \
     ||  EL_PLAT_IOS      \
     ||  EL_PLAT_OSX      \
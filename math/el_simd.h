@@ -0,0 +1,698 @@
+#ifndef __EL_SIMD_H__
+#define __EL_SIMD_H__
+
+#include <cstddef>
+#include <math.h>
+
+#include "el_platform.h"
+
+#if EL_SIMD_SSE2
+#   include <emmintrin.h>
+#endif
+#if EL_SIMD_AVX
+#   include <immintrin.h>
+#endif
+
+// Every instruction set level gets its own inline namespace. The
+// el_kernels_*.cpp units include this header with wider -m flags than the
+// rest of the program; without it their copies of these inline functions
+// would share names with the baseline ones and the linker could keep either.
+#if EL_SIMD_AVX512
+#   define EL_SIMD_ISA isa_avx512
+#elif EL_SIMD_AVX2 && EL_SIMD_FMA
+#   define EL_SIMD_ISA isa_avx2
+#elif EL_SIMD_AVX
+#   define EL_SIMD_ISA isa_avx
+#elif EL_SIMD_SSE2
+#   define EL_SIMD_ISA isa_sse2
+#else
+#   define EL_SIMD_ISA isa_scalar
+#endif
+
+namespace el {
+namespace simd {
+inline namespace EL_SIMD_ISA {
+
+// All kernels work on column-major 4x4 matrices stored as 16 contiguous
+// elements, the layout of details::TMat44. Outputs may not alias inputs.
+
+#if EL_SIMD_SSE2
+
+// a * b + c, fused when the target has FMA3
+inline __m128 madd(__m128 a, __m128 b, __m128 c) noexcept
+{
+#if EL_SIMD_FMA
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+#if EL_SIMD_AVX
+inline __m256 madd(__m256 a, __m256 b, __m256 c) noexcept
+{
+#if EL_SIMD_FMA
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline __m256d madd(__m256d a, __m256d b, __m256d c) noexcept
+{
+#if EL_SIMD_FMA
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+#endif // EL_SIMD_AVX
+
+#if EL_SIMD_AVX512
+inline __m512 madd(__m512 a, __m512 b, __m512 c) noexcept
+{
+    return _mm512_fmadd_ps(a, b, c);
+}
+#endif // EL_SIMD_AVX512
+
+// column c of a product: each element of b is broadcast and multiplied by the
+// matching column of a, r = a[0]*b.x + a[1]*b.y + a[2]*b.z + a[3]*b.w
+inline __m128 mul_col(const __m128 a[4], __m128 b) noexcept
+{
+    __m128 r = _mm_mul_ps(a[0], _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = madd(a[1], _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1)), r);
+    r = madd(a[2], _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2)), r);
+    r = madd(a[3], _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3)), r);
+    return r;
+}
+
+inline void mat44_mul(float* r, const float* a, const float* b) noexcept
+{
+#if EL_SIMD_AVX
+    // two result columns per 256-bit register; the lhs column is duplicated
+    // into both lanes and the in-lane shuffle broadcasts the rhs element.
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+    for (int c = 0; c < 16; c += 8) {
+        const __m256 bc = _mm256_loadu_ps(b + c);
+        __m256 rc = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0)));
+        rc = madd(a1, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1)), rc);
+        rc = madd(a2, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2)), rc);
+        rc = madd(a3, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3)), rc);
+        _mm256_storeu_ps(r + c, rc);
+    }
+#else
+    const __m128 ac[4] = {
+        _mm_loadu_ps(a + 0), _mm_loadu_ps(a + 4),
+        _mm_loadu_ps(a + 8), _mm_loadu_ps(a + 12) };
+    _mm_storeu_ps(r + 0, mul_col(ac, _mm_loadu_ps(b + 0)));
+    _mm_storeu_ps(r + 4, mul_col(ac, _mm_loadu_ps(b + 4)));
+    _mm_storeu_ps(r + 8, mul_col(ac, _mm_loadu_ps(b + 8)));
+    _mm_storeu_ps(r + 12, mul_col(ac, _mm_loadu_ps(b + 12)));
+#endif // EL_SIMD_AVX
+}
+
+inline void mat44_mul_vec4(float* r, const float* m, const float* v) noexcept
+{
+    const __m128 mc[4] = {
+        _mm_loadu_ps(m + 0), _mm_loadu_ps(m + 4),
+        _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12) };
+    _mm_storeu_ps(r, mul_col(mc, _mm_loadu_ps(v)));
+}
+
+#endif // EL_SIMD_SSE2
+
+#if EL_SIMD_AVX
+
+inline void mat44_mul(double* r, const double* a, const double* b) noexcept
+{
+    const __m256d ac[4] = {
+        _mm256_loadu_pd(a + 0), _mm256_loadu_pd(a + 4),
+        _mm256_loadu_pd(a + 8), _mm256_loadu_pd(a + 12) };
+    for (int c = 0; c < 16; c += 4) {
+        __m256d rc = _mm256_mul_pd(ac[0], _mm256_broadcast_sd(b + c + 0));
+        rc = madd(ac[1], _mm256_broadcast_sd(b + c + 1), rc);
+        rc = madd(ac[2], _mm256_broadcast_sd(b + c + 2), rc);
+        rc = madd(ac[3], _mm256_broadcast_sd(b + c + 3), rc);
+        _mm256_storeu_pd(r + c, rc);
+    }
+}
+
+inline void mat44_mul_vec4(double* r, const double* m, const double* v) noexcept
+{
+    __m256d rc = _mm256_mul_pd(_mm256_loadu_pd(m + 0), _mm256_broadcast_sd(v + 0));
+    rc = madd(_mm256_loadu_pd(m + 4), _mm256_broadcast_sd(v + 1), rc);
+    rc = madd(_mm256_loadu_pd(m + 8), _mm256_broadcast_sd(v + 2), rc);
+    rc = madd(_mm256_loadu_pd(m + 12), _mm256_broadcast_sd(v + 3), rc);
+    _mm256_storeu_pd(r, rc);
+}
+
+#endif // EL_SIMD_AVX
+
+#if EL_SIMD_SSE2
+
+// _mm_shuffle_ps with the lanes listed in result order
+#define EL_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define EL_SWIZZLE(a, x, y, z, w) EL_SHUFFLE(a, a, x, y, z, w)
+
+// 2x2 blocks are packed as (m00, m01, m10, m11) in one register.
+
+// A * B
+inline __m128 mat22_mul(__m128 a, __m128 b) noexcept
+{
+    return _mm_add_ps(
+        _mm_mul_ps(a, EL_SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(EL_SWIZZLE(a, 1, 0, 3, 2), EL_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(A) * B
+inline __m128 mat22_adj_mul(__m128 a, __m128 b) noexcept
+{
+    return _mm_sub_ps(
+        _mm_mul_ps(EL_SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(EL_SWIZZLE(a, 1, 1, 2, 2), EL_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * adj(B)
+inline __m128 mat22_mul_adj(__m128 a, __m128 b) noexcept
+{
+    return _mm_sub_ps(
+        _mm_mul_ps(a, EL_SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(EL_SWIZZLE(a, 1, 0, 3, 2), EL_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// General inverse through 2x2 blocks: with M = | A B |, every block of
+//                                             | C D |
+// adj(M) is built from 2x2 products of A..D and their adjugates. The kernel
+// never looks at the layout, inverse(transpose(M)) = transpose(inverse(M)).
+// A singular matrix yields inf/nan.
+inline void mat44_inverse(float* r, const float* m) noexcept
+{
+    const __m128 c0 = _mm_loadu_ps(m + 0);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+
+    const __m128 A = _mm_movelh_ps(c0, c1);
+    const __m128 B = _mm_movehl_ps(c1, c0);
+    const __m128 C = _mm_movelh_ps(c2, c3);
+    const __m128 D = _mm_movehl_ps(c3, c2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(EL_SHUFFLE(c0, c2, 0, 2, 0, 2), EL_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(EL_SHUFFLE(c0, c2, 1, 3, 1, 3), EL_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    const __m128 detA = EL_SWIZZLE(detSub, 0, 0, 0, 0);
+    const __m128 detB = EL_SWIZZLE(detSub, 1, 1, 1, 1);
+    const __m128 detC = EL_SWIZZLE(detSub, 2, 2, 2, 2);
+    const __m128 detD = EL_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    const __m128 DC = mat22_adj_mul(D, C);
+    const __m128 AB = mat22_adj_mul(A, B);
+
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat22_mul(B, DC));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat22_mul(C, AB));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat22_mul_adj(D, AB));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat22_mul_adj(A, DC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 tr = _mm_mul_ps(AB, EL_SWIZZLE(DC, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, EL_SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, EL_SWIZZLE(tr, 2, 3, 0, 1));
+    const __m128 det = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+    const __m128 rdet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+    X = _mm_mul_ps(X, rdet);
+    Y = _mm_mul_ps(Y, rdet);
+    Z = _mm_mul_ps(Z, rdet);
+    W = _mm_mul_ps(W, rdet);
+
+    // the final adjugate swizzle folds into the store shuffle
+    _mm_storeu_ps(r + 0, EL_SHUFFLE(X, Y, 3, 1, 3, 1));
+    _mm_storeu_ps(r + 4, EL_SHUFFLE(X, Y, 2, 0, 2, 0));
+    _mm_storeu_ps(r + 8, EL_SHUFFLE(Z, W, 3, 1, 3, 1));
+    _mm_storeu_ps(r + 12, EL_SHUFFLE(Z, W, 2, 0, 2, 0));
+}
+
+inline __m128 cross3(__m128 a, __m128 b) noexcept
+{
+    return _mm_sub_ps(
+        _mm_mul_ps(EL_SWIZZLE(a, 1, 2, 0, 3), EL_SWIZZLE(b, 2, 0, 1, 3)),
+        _mm_mul_ps(EL_SWIZZLE(a, 2, 0, 1, 3), EL_SWIZZLE(b, 1, 2, 0, 3)));
+}
+
+// writes the column-major inverse of | L t |, given the rows of L^-1
+//                                    | 0 1 |
+inline void store_affine_inverse(float* r, __m128 r0, __m128 r1, __m128 r2,
+    const float* m) noexcept
+{
+    __m128 r3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    // -L^-1 * t, w = 1
+    __m128 t = _mm_mul_ps(r0, _mm_set1_ps(m[12]));
+    t = madd(r1, _mm_set1_ps(m[13]), t);
+    t = madd(r2, _mm_set1_ps(m[14]), t);
+    t = _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), t);
+
+    _mm_storeu_ps(r + 0, r0);
+    _mm_storeu_ps(r + 4, r1);
+    _mm_storeu_ps(r + 8, r2);
+    _mm_storeu_ps(r + 12, t);
+}
+
+// Inverse of a matrix whose last row is (0, 0, 0, 1): the 3x3 part is
+// inverted by its adjugate (rows are cross products of the columns).
+inline void mat44_affine_inverse(float* r, const float* m) noexcept
+{
+    const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 c0 = _mm_and_ps(_mm_loadu_ps(m + 0), mask);
+    const __m128 c1 = _mm_and_ps(_mm_loadu_ps(m + 4), mask);
+    const __m128 c2 = _mm_and_ps(_mm_loadu_ps(m + 8), mask);
+
+    const __m128 x0 = cross3(c1, c2);
+    const __m128 x1 = cross3(c2, c0);
+    const __m128 x2 = cross3(c0, c1);
+
+    __m128 det = _mm_mul_ps(c0, x0);
+    det = _mm_add_ps(det, EL_SWIZZLE(det, 1, 0, 3, 2));
+    det = _mm_add_ps(det, EL_SWIZZLE(det, 2, 3, 0, 1));
+    const __m128 rdet = _mm_div_ps(_mm_set1_ps(1.f), det);
+
+    store_affine_inverse(r,
+        _mm_mul_ps(x0, rdet), _mm_mul_ps(x1, rdet), _mm_mul_ps(x2, rdet), m);
+}
+
+// Inverse of rotation + translation: the 3x3 part is transposed.
+inline void mat44_rigid_inverse(float* r, const float* m) noexcept
+{
+    const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    store_affine_inverse(r,
+        _mm_and_ps(_mm_loadu_ps(m + 0), mask),
+        _mm_and_ps(_mm_loadu_ps(m + 4), mask),
+        _mm_and_ps(_mm_loadu_ps(m + 8), mask), m);
+}
+
+#undef EL_SWIZZLE
+#undef EL_SHUFFLE
+
+#endif // EL_SIMD_SSE2
+
+// Batch transforms of float3 data by the upper 3x4 of a column-major 4x4.
+// w is 1 for points and 0 for vectors; the projected w row is ignored. The
+// output may be the input array, but must not partially overlap it.
+
+inline void transform3_scalar(const float* m, float w,
+    float x, float y, float z, float* ox, float* oy, float* oz) noexcept
+{
+    const float rx = m[0] * x + m[4] * y + m[8]  * z + m[12] * w;
+    const float ry = m[1] * x + m[5] * y + m[9]  * z + m[13] * w;
+    const float rz = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+    *ox = rx;
+    *oy = ry;
+    *oz = rz;
+}
+
+#if EL_SIMD_SSE2
+
+struct transform3_sse
+{
+    __m128 m[9];
+    __m128 t[3];
+
+    transform3_sse(const float* mat, float w) noexcept
+    {
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                m[c * 3 + r] = _mm_set1_ps(mat[c * 4 + r]);
+        for (int r = 0; r < 3; ++r)
+            t[r] = _mm_set1_ps(mat[12 + r] * w);
+    }
+
+    void operator()(__m128& x, __m128& y, __m128& z) const noexcept
+    {
+        const __m128 rx = madd(m[6], z, madd(m[3], y, madd(m[0], x, t[0])));
+        const __m128 ry = madd(m[7], z, madd(m[4], y, madd(m[1], x, t[1])));
+        const __m128 rz = madd(m[8], z, madd(m[5], y, madd(m[2], x, t[2])));
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+};
+
+#endif // EL_SIMD_SSE2
+
+#if EL_SIMD_AVX
+
+struct transform3_avx
+{
+    __m256 m[9];
+    __m256 t[3];
+
+    transform3_avx(const float* mat, float w) noexcept
+    {
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                m[c * 3 + r] = _mm256_set1_ps(mat[c * 4 + r]);
+        for (int r = 0; r < 3; ++r)
+            t[r] = _mm256_set1_ps(mat[12 + r] * w);
+    }
+
+    void operator()(__m256& x, __m256& y, __m256& z) const noexcept
+    {
+        const __m256 rx = madd(m[6], z, madd(m[3], y, madd(m[0], x, t[0])));
+        const __m256 ry = madd(m[7], z, madd(m[4], y, madd(m[1], x, t[1])));
+        const __m256 rz = madd(m[8], z, madd(m[5], y, madd(m[2], x, t[2])));
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+};
+
+#endif // EL_SIMD_AVX
+
+#if EL_SIMD_AVX512
+
+struct transform3_avx512
+{
+    __m512 m[9];
+    __m512 t[3];
+
+    transform3_avx512(const float* mat, float w) noexcept
+    {
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                m[c * 3 + r] = _mm512_set1_ps(mat[c * 4 + r]);
+        for (int r = 0; r < 3; ++r)
+            t[r] = _mm512_set1_ps(mat[12 + r] * w);
+    }
+
+    void operator()(__m512& x, __m512& y, __m512& z) const noexcept
+    {
+        const __m512 rx = madd(m[6], z, madd(m[3], y, madd(m[0], x, t[0])));
+        const __m512 ry = madd(m[7], z, madd(m[4], y, madd(m[1], x, t[1])));
+        const __m512 rz = madd(m[8], z, madd(m[5], y, madd(m[2], x, t[2])));
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+};
+
+#endif // EL_SIMD_AVX512
+
+// separate x[], y[] and z[] arrays
+inline void transform3_soa(const float* m, float w,
+    const float* x, const float* y, const float* z,
+    float* ox, float* oy, float* oz, size_t count) noexcept
+{
+    size_t i = 0;
+#if EL_SIMD_AVX512
+    const transform3_avx512 xf16(m, w);
+    for (; i + 16 <= count; i += 16) {
+        __m512 vx = _mm512_loadu_ps(x + i);
+        __m512 vy = _mm512_loadu_ps(y + i);
+        __m512 vz = _mm512_loadu_ps(z + i);
+        xf16(vx, vy, vz);
+        _mm512_storeu_ps(ox + i, vx);
+        _mm512_storeu_ps(oy + i, vy);
+        _mm512_storeu_ps(oz + i, vz);
+    }
+#endif
+#if EL_SIMD_AVX
+    const transform3_avx xf8(m, w);
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        xf8(vx, vy, vz);
+        _mm256_storeu_ps(ox + i, vx);
+        _mm256_storeu_ps(oy + i, vy);
+        _mm256_storeu_ps(oz + i, vz);
+    }
+#endif
+#if EL_SIMD_SSE2
+    const transform3_sse xf4(m, w);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        xf4(vx, vy, vz);
+        _mm_storeu_ps(ox + i, vx);
+        _mm_storeu_ps(oy + i, vy);
+        _mm_storeu_ps(oz + i, vz);
+    }
+#endif
+    for (; i < count; ++i)
+        transform3_scalar(m, w, x[i], y[i], z[i], ox + i, oy + i, oz + i);
+}
+
+// interleaved x, y, z triples
+inline void transform3_aos(const float* m, float w,
+    const float* in, float* out, size_t count) noexcept
+{
+    size_t i = 0;
+#if EL_SIMD_SSE2
+    // four points are three registers; transpose them to x/y/z lanes,
+    // transform, and transpose back.
+    const transform3_sse xf4(m, w);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 a = _mm_loadu_ps(in + i * 3 + 0); // x0 y0 z0 x1
+        const __m128 b = _mm_loadu_ps(in + i * 3 + 4); // y1 z1 x2 y2
+        const __m128 c = _mm_loadu_ps(in + i * 3 + 8); // z2 x3 y3 z3
+
+        __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 y = _mm_shuffle_ps(
+            _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+            _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(
+            _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+            _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        xf4(x, y, z);
+
+        const __m128 ra = _mm_shuffle_ps(
+            _mm_unpacklo_ps(x, y),
+            _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+        const __m128 rb = _mm_shuffle_ps(
+            _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+            _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 rc = _mm_shuffle_ps(
+            _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+            _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        _mm_storeu_ps(out + i * 3 + 0, ra);
+        _mm_storeu_ps(out + i * 3 + 4, rb);
+        _mm_storeu_ps(out + i * 3 + 8, rc);
+    }
+#endif
+    for (; i < count; ++i) {
+        const float* p = in + i * 3;
+        float* o = out + i * 3;
+        transform3_scalar(m, w, p[0], p[1], p[2], o + 0, o + 1, o + 2);
+    }
+}
+
+// Scales each (x, y, z) to unit length in place. Vectors with a squared
+// length below `eps` are left unchanged.
+inline void normalize3_soa(float* x, float* y, float* z, size_t count, float eps) noexcept
+{
+    size_t i = 0;
+#if EL_SIMD_AVX512
+    for (; i + 16 <= count; i += 16) {
+        const __m512 vx = _mm512_loadu_ps(x + i);
+        const __m512 vy = _mm512_loadu_ps(y + i);
+        const __m512 vz = _mm512_loadu_ps(z + i);
+        const __m512 sq = madd(vz, vz, madd(vy, vy, _mm512_mul_ps(vx, vx)));
+        const __mmask16 keep = _mm512_cmp_ps_mask(sq, _mm512_set1_ps(eps), _CMP_GE_OQ);
+        const __m512 s = _mm512_mask_div_ps(_mm512_set1_ps(1.f), keep,
+            _mm512_set1_ps(1.f), _mm512_sqrt_ps(sq));
+        _mm512_storeu_ps(x + i, _mm512_mul_ps(vx, s));
+        _mm512_storeu_ps(y + i, _mm512_mul_ps(vy, s));
+        _mm512_storeu_ps(z + i, _mm512_mul_ps(vz, s));
+    }
+#endif
+#if EL_SIMD_AVX
+    for (; i + 8 <= count; i += 8) {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 vz = _mm256_loadu_ps(z + i);
+        const __m256 sq = madd(vz, vz, madd(vy, vy, _mm256_mul_ps(vx, vx)));
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 keep = _mm256_cmp_ps(sq, _mm256_set1_ps(eps), _CMP_GE_OQ);
+        const __m256 s = _mm256_blendv_ps(one, _mm256_div_ps(one, _mm256_sqrt_ps(sq)), keep);
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(vx, s));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(vy, s));
+        _mm256_storeu_ps(z + i, _mm256_mul_ps(vz, s));
+    }
+#endif
+#if EL_SIMD_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 vz = _mm_loadu_ps(z + i);
+        const __m128 sq = madd(vz, vz, madd(vy, vy, _mm_mul_ps(vx, vx)));
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 keep = _mm_cmpge_ps(sq, _mm_set1_ps(eps));
+        const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(sq));
+        const __m128 s = _mm_or_ps(_mm_and_ps(keep, inv), _mm_andnot_ps(keep, one));
+        _mm_storeu_ps(x + i, _mm_mul_ps(vx, s));
+        _mm_storeu_ps(y + i, _mm_mul_ps(vy, s));
+        _mm_storeu_ps(z + i, _mm_mul_ps(vz, s));
+    }
+#endif
+    for (; i < count; ++i) {
+        const float sq = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        if (sq < eps)
+            continue;
+        const float s = 1.f / sqrtf(sq);
+        x[i] *= s;
+        y[i] *= s;
+        z[i] *= s;
+    }
+}
+
+// normalize3_soa with the hardware reciprocal square root estimate refined by
+// one Newton-Raphson step, r' = r * (1.5 - 0.5 * sq * r * r). That leaves a
+// relative error of a few ulp instead of the exact 1 / sqrt, at a fraction of
+// the cost of the divide. The scalar tail is exact.
+inline void normalize3_soa_fast(float* x, float* y, float* z, size_t count, float eps) noexcept
+{
+    size_t i = 0;
+#if EL_SIMD_AVX512
+    for (; i + 16 <= count; i += 16) {
+        const __m512 vx = _mm512_loadu_ps(x + i);
+        const __m512 vy = _mm512_loadu_ps(y + i);
+        const __m512 vz = _mm512_loadu_ps(z + i);
+        const __m512 sq = madd(vz, vz, madd(vy, vy, _mm512_mul_ps(vx, vx)));
+        const __mmask16 keep = _mm512_cmp_ps_mask(sq, _mm512_set1_ps(eps), _CMP_GE_OQ);
+        const __m512 r = _mm512_rsqrt14_ps(sq);
+        const __m512 nh = _mm512_mul_ps(sq, _mm512_set1_ps(-0.5f));
+        const __m512 n = _mm512_mul_ps(r, madd(_mm512_mul_ps(nh, r), r, _mm512_set1_ps(1.5f)));
+        const __m512 s = _mm512_mask_blend_ps(keep, _mm512_set1_ps(1.f), n);
+        _mm512_storeu_ps(x + i, _mm512_mul_ps(vx, s));
+        _mm512_storeu_ps(y + i, _mm512_mul_ps(vy, s));
+        _mm512_storeu_ps(z + i, _mm512_mul_ps(vz, s));
+    }
+#endif
+#if EL_SIMD_AVX
+    for (; i + 8 <= count; i += 8) {
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 vz = _mm256_loadu_ps(z + i);
+        const __m256 sq = madd(vz, vz, madd(vy, vy, _mm256_mul_ps(vx, vx)));
+        const __m256 keep = _mm256_cmp_ps(sq, _mm256_set1_ps(eps), _CMP_GE_OQ);
+        const __m256 r = _mm256_rsqrt_ps(sq);
+        const __m256 nh = _mm256_mul_ps(sq, _mm256_set1_ps(-0.5f));
+        const __m256 n = _mm256_mul_ps(r, madd(_mm256_mul_ps(nh, r), r, _mm256_set1_ps(1.5f)));
+        const __m256 s = _mm256_blendv_ps(_mm256_set1_ps(1.f), n, keep);
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(vx, s));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(vy, s));
+        _mm256_storeu_ps(z + i, _mm256_mul_ps(vz, s));
+    }
+#endif
+#if EL_SIMD_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 vz = _mm_loadu_ps(z + i);
+        const __m128 sq = madd(vz, vz, madd(vy, vy, _mm_mul_ps(vx, vx)));
+        const __m128 keep = _mm_cmpge_ps(sq, _mm_set1_ps(eps));
+        const __m128 r = _mm_rsqrt_ps(sq);
+        const __m128 nh = _mm_mul_ps(sq, _mm_set1_ps(-0.5f));
+        const __m128 n = _mm_mul_ps(r, madd(_mm_mul_ps(nh, r), r, _mm_set1_ps(1.5f)));
+        const __m128 s = _mm_or_ps(_mm_and_ps(keep, n), _mm_andnot_ps(keep, _mm_set1_ps(1.f)));
+        _mm_storeu_ps(x + i, _mm_mul_ps(vx, s));
+        _mm_storeu_ps(y + i, _mm_mul_ps(vy, s));
+        _mm_storeu_ps(z + i, _mm_mul_ps(vz, s));
+    }
+#endif
+    normalize3_soa(x + i, y + i, z + i, count - i, eps);
+}
+
+// Cubic Bezier by de Casteljau, the same six lerps as gszauer::interpolate
+// with lerp(a, b, t) = b * t + a * (1 - t). p holds the four (x, y, z)
+// points in curve order: start, first control, second control, end.
+template <typename V, typename F>
+inline V bezier3_lane(const V p[4], V t, V s, F lerp) noexcept
+{
+    const V a = lerp(p[0], p[1], t, s);
+    const V b = lerp(p[2], p[3], t, s);
+    const V c = lerp(p[1], p[2], t, s);
+    const V d = lerp(a, c, t, s);
+    const V e = lerp(c, b, t, s);
+    return lerp(d, e, t, s);
+}
+
+inline void bezier3_soa(const float p[12], const float* t,
+    float* ox, float* oy, float* oz, size_t count) noexcept
+{
+    float* out[3] = { ox, oy, oz };
+    size_t i = 0;
+#if EL_SIMD_AVX512
+    {
+        __m512 cp[3][4];
+        for (int c = 0; c < 3; ++c)
+            for (int k = 0; k < 4; ++k)
+                cp[c][k] = _mm512_set1_ps(p[k * 3 + c]);
+        auto lerp = [](__m512 a, __m512 b, __m512 vt, __m512 vs) {
+            return madd(b, vt, _mm512_mul_ps(a, vs));
+        };
+        for (; i + 16 <= count; i += 16) {
+            const __m512 vt = _mm512_loadu_ps(t + i);
+            const __m512 vs = _mm512_sub_ps(_mm512_set1_ps(1.f), vt);
+            for (int c = 0; c < 3; ++c)
+                _mm512_storeu_ps(out[c] + i, bezier3_lane(cp[c], vt, vs, lerp));
+        }
+    }
+#endif
+#if EL_SIMD_AVX
+    {
+        __m256 cp[3][4];
+        for (int c = 0; c < 3; ++c)
+            for (int k = 0; k < 4; ++k)
+                cp[c][k] = _mm256_set1_ps(p[k * 3 + c]);
+        auto lerp = [](__m256 a, __m256 b, __m256 vt, __m256 vs) {
+            return madd(b, vt, _mm256_mul_ps(a, vs));
+        };
+        for (; i + 8 <= count; i += 8) {
+            const __m256 vt = _mm256_loadu_ps(t + i);
+            const __m256 vs = _mm256_sub_ps(_mm256_set1_ps(1.f), vt);
+            for (int c = 0; c < 3; ++c)
+                _mm256_storeu_ps(out[c] + i, bezier3_lane(cp[c], vt, vs, lerp));
+        }
+    }
+#endif
+#if EL_SIMD_SSE2
+    {
+        __m128 cp[3][4];
+        for (int c = 0; c < 3; ++c)
+            for (int k = 0; k < 4; ++k)
+                cp[c][k] = _mm_set1_ps(p[k * 3 + c]);
+        auto lerp = [](__m128 a, __m128 b, __m128 vt, __m128 vs) {
+            return madd(b, vt, _mm_mul_ps(a, vs));
+        };
+        for (; i + 4 <= count; i += 4) {
+            const __m128 vt = _mm_loadu_ps(t + i);
+            const __m128 vs = _mm_sub_ps(_mm_set1_ps(1.f), vt);
+            for (int c = 0; c < 3; ++c)
+                _mm_storeu_ps(out[c] + i, bezier3_lane(cp[c], vt, vs, lerp));
+        }
+    }
+#endif
+    auto lerp = [](float a, float b, float vt, float vs) { return b * vt + a * vs; };
+    for (; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const float cp[4] = { p[c], p[3 + c], p[6 + c], p[9 + c] };
+            out[c][i] = bezier3_lane(cp, t[i], 1.f - t[i], lerp);
+        }
+    }
+}
+
+} // namespace EL_SIMD_ISA
+} // namespace simd
+} // namespace el
+
+#endif // __EL_SIMD_H__
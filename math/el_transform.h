@@ -0,0 +1,121 @@
+#ifndef __EL_TRANSFORM_H__
+#define __EL_TRANSFORM_H__
+
+#include <cstddef>
+
+#include "el_vec4.h"
+#include "el_dispatch.h"
+#include "el_parallel.h"
+
+namespace el {
+
+// Batch transforms of float3 arrays by a mat4f.
+//
+// Points are transformed with w = 1 and vectors with w = 0; only the upper
+// 3x4 part of the matrix is used, so no perspective divide happens. `out`
+// may be `in` (or each SoA array its input) but must not partially overlap
+// it. `threads` > 1 splits the array across that many threads, 0 uses every
+// hardware thread. The kernels are picked at run time, see el_dispatch.h.
+
+template <typename T>
+struct TSoA3
+{
+    T* x;
+    T* y;
+    T* z;
+};
+
+using float3_soa = TSoA3<float>;
+using const_float3_soa = TSoA3<const float>;
+
+namespace details {
+
+// elements per parallel_for block; keeps ranges SIMD aligned and large
+// enough that a thread does not just pay for its own start-up
+constexpr size_t TRANSFORM_GRAIN = 16 * 1024;
+// matrices per block for the batch inverses, a matrix being 16 floats
+constexpr size_t INVERSE_GRAIN = TRANSFORM_GRAIN / 16;
+
+static_assert(sizeof(float3) == sizeof(float) * 3,
+    "AoS transforms expect tightly packed float3");
+
+inline void transform(const mat4f& m, float w,
+    const float3* in, float3* out, size_t count, size_t threads)
+{
+    const float* mat = &m[0][0];
+    const float* src = reinterpret_cast<const float*>(in);
+    float* dst = reinterpret_cast<float*>(out);
+    const auto kernel = dispatch::kernels().transform3_aos;
+    parallel_for(count, threads, TRANSFORM_GRAIN, [=](size_t begin, size_t end) {
+        kernel(mat, w, src + begin * 3, dst + begin * 3, end - begin);
+    });
+}
+
+inline void transform(const mat4f& m, float w,
+    const_float3_soa in, float3_soa out, size_t count, size_t threads)
+{
+    const float* mat = &m[0][0];
+    const auto kernel = dispatch::kernels().transform3_soa;
+    parallel_for(count, threads, TRANSFORM_GRAIN, [=](size_t begin, size_t end) {
+        kernel(mat, w,
+            in.x + begin, in.y + begin, in.z + begin,
+            out.x + begin, out.y + begin, out.z + begin, end - begin);
+    });
+}
+
+} // namespace details
+
+inline void transformPoints(const mat4f& m,
+    const float3* in, float3* out, size_t count, size_t threads = 1)
+{
+    details::transform(m, 1.f, in, out, count, threads);
+}
+
+inline void transformVectors(const mat4f& m,
+    const float3* in, float3* out, size_t count, size_t threads = 1)
+{
+    details::transform(m, 0.f, in, out, count, threads);
+}
+
+inline void transformPoints(const mat4f& m,
+    const_float3_soa in, float3_soa out, size_t count, size_t threads = 1)
+{
+    details::transform(m, 1.f, in, out, count, threads);
+}
+
+inline void transformVectors(const mat4f& m,
+    const_float3_soa in, float3_soa out, size_t count, size_t threads = 1)
+{
+    details::transform(m, 0.f, in, out, count, threads);
+}
+
+// Batch inverses, see details::inverse, affineInverse and rigidInverse.
+// out may be in.
+
+inline void inverse(const mat4f* in, mat4f* out, size_t count, size_t threads = 1)
+{
+    parallel_for(count, threads, details::INVERSE_GRAIN, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = details::inverse(in[i]);
+    });
+}
+
+inline void affineInverse(const mat4f* in, mat4f* out, size_t count, size_t threads = 1)
+{
+    parallel_for(count, threads, details::INVERSE_GRAIN, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = details::affineInverse(in[i]);
+    });
+}
+
+inline void rigidInverse(const mat4f* in, mat4f* out, size_t count, size_t threads = 1)
+{
+    parallel_for(count, threads, details::INVERSE_GRAIN, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = details::rigidInverse(in[i]);
+    });
+}
+
+} // namespace el
+
+#endif // __EL_TRANSFORM_H__
@@ -2,31 +2,34 @@
 #define __EL_MATH_VEC4_H__
 
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <type_traits>
+#include <utility>
 
 #include "el_macros.h"
+#include "el_simd.h"
 
 namespace el {
 
 template <typename T>
-inline T min(T a, T b) noexcept {
+constexpr T min(T a, T b) noexcept {
     return a < b ? a : b;
 }
 
 template <typename T>
-inline T max(T a, T b) noexcept {
+constexpr T max(T a, T b) noexcept {
     return a > b ? a : b;
 }
 
 template <typename T>
-inline T clamp(T v, T min, T max) noexcept {
+constexpr T clamp(T v, T min, T max) noexcept {
     assert(min <= max);
     return T(el::min(max, (el::max(min, v))));
 }
 
 template <typename T>
-inline T mix(T x, T y, T a) noexcept {
+constexpr T mix(T x, T y, T a) noexcept {
     return x * (T(1) - a) + y * a;
 }
 
@@ -50,13 +53,17 @@ using enable_if_arithmetic_t = std::enable_if_t<
     std::is_arithmetic<C>::value &&
     std::is_arithmetic<D>::value>;
 
+template <typename T> class TVec2;
+template <typename T> class TVec3;
+template <typename T> class TVec4;
+
 template <template <typename T> class VECTOR, typename T> 
 struct TVecAddOperators 
 {
 public:
 
-    template <typename OHTER>
-    VECTOR<T>& operator+=(const VECTOR<OHTER>& v)
+    template <typename U>
+    constexpr VECTOR<T>& operator+=(const VECTOR<U>& v)
     {
         VECTOR<T>& lhs = static_cast<VECTOR<T>&>(*this);
         for (size_t i = 0; i < lhs.size(); i++)
@@ -64,8 +71,8 @@ public:
         return lhs;
     }
 
-    template <typename OHTER>
-    VECTOR<T>& operator-=(const VECTOR<OHTER>& v)
+    template <typename U>
+    constexpr VECTOR<T>& operator-=(const VECTOR<U>& v)
     {
         VECTOR<T>& lhs = static_cast<VECTOR<T>&>(*this);
         for (size_t i = 0; i < lhs.size(); i++)
@@ -75,9 +82,14 @@ public:
 
 private:
 
+    /*
+     * The result keeps the vector's element type. A scalar is applied per
+     * component, without a broadcast vector; one that T would be promoted to
+     * (a double added to a float4) in the wider type, not rounded to T first.
+     */
+
     template <typename U>
-    friend inline 
-    VECTOR<T> operator+(const VECTOR<T>& lv, const VECTOR<U>& rv)
+    friend constexpr VECTOR<T> operator+(const VECTOR<T>& lv, const VECTOR<U>& rv)
     {
         VECTOR<T> res(lv);
         res += rv;
@@ -85,22 +97,22 @@ private:
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator+(const VECTOR<T>& lv, U rv)
+    friend constexpr VECTOR<T> operator+(const VECTOR<T>& lv, U rv)
     {
-        return lv + VECTOR<U>(rv);
+        VECTOR<T> res(lv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv[i] + rv);
+        return res;
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator+(U lv, const VECTOR<T>& rv)
+    friend constexpr VECTOR<T> operator+(U lv, const VECTOR<T>& rv)
     {
-        return VECTOR<U>(lv) + rv;
+        return rv + lv;
     }
 
     template <typename U>
-    friend inline 
-    VECTOR<T> operator-(const VECTOR<T>& lv, const VECTOR<U>& rv)
+    friend constexpr VECTOR<T> operator-(const VECTOR<T>& lv, const VECTOR<U>& rv)
     {
         VECTOR<T> res(lv);
         res -= rv;
@@ -108,17 +120,21 @@ private:
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator-(const VECTOR<T>& lv, U rv)
+    friend constexpr VECTOR<T> operator-(const VECTOR<T>& lv, U rv)
     {
-        return lv - VECTOR<U>(rv);
+        VECTOR<T> res(lv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv[i] - rv);
+        return res;
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator-(U lv, const VECTOR<T>& rv)
+    friend constexpr VECTOR<T> operator-(U lv, const VECTOR<T>& rv)
     {
-        return VECTOR<U>(lv) - rv;
+        VECTOR<T> res(rv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv - rv[i]);
+        return res;
     }
 };
 
@@ -127,8 +143,8 @@ struct TVecProductOperators
 {
 public:
 
-    template <typename OHTER>
-    VECTOR<T>& operator*=(const VECTOR<OHTER>& v)
+    template <typename U>
+    constexpr VECTOR<T>& operator*=(const VECTOR<U>& v)
     {
         VECTOR<T>& lhs = static_cast<VECTOR<T>&>(*this);
         for (size_t i = 0; i < lhs.size(); i++)
@@ -136,8 +152,8 @@ public:
         return lhs;
     }
 
-    template <typename OHTER>
-    VECTOR<T>& operator/=(const VECTOR<OHTER>& v)
+    template <typename U>
+    constexpr VECTOR<T>& operator/=(const VECTOR<U>& v)
     {
         VECTOR<T>& lhs = static_cast<VECTOR<T>&>(*this);
         for (size_t i = 0; i < lhs.size(); i++)
@@ -147,32 +163,41 @@ public:
 
 private:
 
-    template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<arithmetic_result_t<T, U>> operator*(const VECTOR<T>& lv, const VECTOR<U>& rv)
+    // vector products promote (double4 * float4 is a double4), everything
+    // else keeps T like the additive operators
+    template <typename U>
+    friend constexpr VECTOR<arithmetic_result_t<T, U>> operator*(const VECTOR<T>& lv, const VECTOR<U>& rv)
     {
-        VECTOR<arithmetic_result_t<T, U>> res(lv);
-        res *= rv;
-        return res;
+        using R = arithmetic_result_t<T, U>;
+        if constexpr (std::is_same<R, T>::value) {
+            VECTOR<T> res(lv);
+            res *= rv;
+            return res;
+        } else {
+            VECTOR<R> res(R(0));
+            for (size_t i = 0; i < res.size(); i++)
+                res[i] = lv[i] * rv[i];
+            return res;
+        }
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator*(U lv, const VECTOR<T>& rv)
+    friend constexpr VECTOR<T> operator*(const VECTOR<T>& lv, U rv)
     {
-        return VECTOR<U>(lv) * rv;
+        VECTOR<T> res(lv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv[i] * rv);
+        return res;
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator*(const VECTOR<T>& lv, U rv)
+    friend constexpr VECTOR<T> operator*(U lv, const VECTOR<T>& rv)
     {
-        return lv * VECTOR<U>(rv);
+        return rv * lv;
     }
 
-    template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator/(const VECTOR<T>& lv, const VECTOR<U>& rv)
+    template <typename U>
+    friend constexpr VECTOR<T> operator/(const VECTOR<T>& lv, const VECTOR<U>& rv)
     {
         VECTOR<T> res(lv);
         res /= rv;
@@ -180,17 +205,21 @@ private:
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator/(const VECTOR<T>& lv, U rv)
+    friend constexpr VECTOR<T> operator/(const VECTOR<T>& lv, U rv)
     {
-        return lv / VECTOR<U>(rv);
+        VECTOR<T> res(lv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv[i] / rv);
+        return res;
     }
 
     template <typename U, typename = enable_if_arithmetic_t<U>>
-    friend inline 
-    VECTOR<T> operator/(U lv, const VECTOR<T>& rv)
+    friend constexpr VECTOR<T> operator/(U lv, const VECTOR<T>& rv)
     {
-        return VECTOR<U>(lv) / rv;
+        VECTOR<T> res(rv);
+        for (size_t i = 0; i < res.size(); i++)
+            res[i] = T(lv / rv[i]);
+        return res;
     }
 };
 
@@ -199,7 +228,7 @@ struct TVecCompareOperators
 {
 private:
 
-    friend inline bool operator==(const VECTOR<T>& lv, const VECTOR<T>& rv)
+    friend constexpr bool operator==(const VECTOR<T>& lv, const VECTOR<T>& rv)
     {
         for (size_t i = 0; i < lv.size(); i++)
             if (lv[i] != rv[i])
@@ -207,7 +236,7 @@ private:
         return true;
     }
 
-    friend inline bool operator!=(const VECTOR<T>& lv, const VECTOR<T>& rv)
+    friend constexpr bool operator!=(const VECTOR<T>& lv, const VECTOR<T>& rv)
     {
         return !operator==(lv, rv);
     }
@@ -216,7 +245,7 @@ private:
 template <template <typename T> class VECTOR, typename T>
 struct TVecFunctions
 {
-    friend inline VECTOR<T> clamp(const VECTOR<T>& v, T min, T max) 
+    friend constexpr VECTOR<T> clamp(const VECTOR<T>& v, T min, T max) 
     {
         VECTOR<T> res(v);
         for (size_t i = 0; i < v.size(); i++) {
@@ -225,7 +254,7 @@ struct TVecFunctions
         return res;
     }
 
-    friend inline VECTOR<T> mix(const VECTOR<T>& u, const VECTOR<T>& v, T t) 
+    friend constexpr VECTOR<T> mix(const VECTOR<T>& u, const VECTOR<T>& v, T t) 
     {
         VECTOR<T> res{};
         for (size_t i = 0; i < res.size(); i++) {
@@ -235,6 +264,9 @@ struct TVecFunctions
     }
 };
 
+// Every vector and matrix operation is constexpr. In a constant expression
+// the components must be read through operator[]: constructors initialize
+// v, and the named members (x, rgb, yz, ...) alias it through the union.
 template <typename T>
 class EL_EMPTY_BASES TVec2 :
         public TVecAddOperators<TVec2, T>,
@@ -248,19 +280,22 @@ public:
 
     static constexpr size_t SIZE = 2;
 
-    TVec2() noexcept = default;
+    constexpr TVec2() noexcept = default;
 
     template <typename A, typename = enable_if_arithmetic_t<A>>
-    TVec2(A a) noexcept : v{ T(a), T(a) } {}
+    constexpr TVec2(A a) noexcept : v{ T(a), T(a) } {}
+
+    template <typename A, typename B, typename = enable_if_arithmetic_t<A, B>>
+    constexpr TVec2(A a, B b) noexcept : v{ T(a), T(b) } {}
 
-    inline size_t size() const { return SIZE; }
+    constexpr size_t size() const noexcept { return SIZE; }
 
-    inline const T& operator[](size_t i) const noexcept {
+    constexpr const T& operator[](size_t i) const noexcept {
         assert(i < SIZE);
         return v[i];
     }
 
-    inline T& operator[](size_t i) noexcept {
+    constexpr T& operator[](size_t i) noexcept {
         assert(i < SIZE);
         return v[i];
     }
@@ -285,22 +320,22 @@ public:
 
     static constexpr size_t SIZE = 3;
 
-    TVec3() noexcept = default;
+    constexpr TVec3() noexcept = default;
 
     template <typename A, typename = enable_if_arithmetic_t<A>>
-    TVec3(A a) noexcept : v{ T(a), T(a), T(a) } {}
+    constexpr TVec3(A a) noexcept : v{ T(a), T(a), T(a) } {}
 
     template <typename A, typename B, typename C, typename = enable_if_arithmetic_t<A, B, C>>
-    TVec3(A a, B b, C c) noexcept : v{ T(a), T(b), T(c) } {}
+    constexpr TVec3(A a, B b, C c) noexcept : v{ T(a), T(b), T(c) } {}
 
-    inline size_t size() const { return SIZE; }
+    constexpr size_t size() const noexcept { return SIZE; }
 
-    inline const T& operator[](size_t i) const noexcept {
+    constexpr const T& operator[](size_t i) const noexcept {
         assert(i < SIZE);
         return v[i];
     }
 
-    inline T& operator[](size_t i) noexcept {
+    constexpr T& operator[](size_t i) noexcept {
         assert(i < SIZE);
         return v[i];
     }
@@ -337,26 +372,26 @@ public:
 
     static constexpr size_t SIZE = 4;
 
-    TVec4() noexcept = default;
+    constexpr TVec4() noexcept = default;
 
     template <typename A, typename = enable_if_arithmetic_t<A>>
-    TVec4(A a) noexcept : v{ T(a), T(a), T(a), T(a) } {}
+    constexpr TVec4(A a) noexcept : v{ T(a), T(a), T(a), T(a) } {}
 
     template <typename A, typename B, typename C, typename D,
         typename = enable_if_arithmetic_t<A,B,C,D>>
-    TVec4(A a, B b, C c, D d) noexcept : v{ T(a), T(b), T(c), T(d) } {}
+    constexpr TVec4(A a, B b, C c, D d) noexcept : v{ T(a), T(b), T(c), T(d) } {}
 
     template <typename A, typename B, typename = enable_if_arithmetic_t<A, B>>
-    TVec4(const TVec3<A>& a, B b) noexcept : v{ T(a[0]), T(a[1]), T(a[2]), T(b)} {}
+    constexpr TVec4(const TVec3<A>& a, B b) noexcept : v{ T(a[0]), T(a[1]), T(a[2]), T(b)} {}
 
-    inline size_t size() const { return SIZE; }
+    constexpr size_t size() const noexcept { return SIZE; }
 
-    inline const T& operator[](size_t i) const noexcept {
+    constexpr const T& operator[](size_t i) const noexcept {
         assert(i < SIZE);
         return v[i];
     }
 
-    inline T& operator[](size_t i) noexcept {
+    constexpr T& operator[](size_t i) noexcept {
         assert(i < SIZE);
         return v[i];
     }
@@ -388,16 +423,209 @@ public:
     };
 };
 
+#if EL_SIMD_SSE2
+
+/*
+ * TVec4<float> is backed by an __m128 and 16-byte aligned. Its compound
+ * assignments with another float4 are one SSE instruction each, and the
+ * binary operators of TVecAddOperators and TVecProductOperators go through
+ * them, so float4 arithmetic with float4 or float/integer scalars is
+ * vectorized. Other operands and constant evaluation take the component loop
+ * with the same results.
+ */
+
+// Storage of TVec4<float>. The nested swizzle unions hold members with
+// constructors, which GCC only accepts in an anonymous struct of a class
+// template, hence the template over what is always float.
+template <typename T>
+struct TVec4SseStorage
+{
+    constexpr TVec4SseStorage() noexcept = default;
+    constexpr TVec4SseStorage(T a, T b, T c, T d) noexcept : v{ a, b, c, d } {}
+    explicit TVec4SseStorage(__m128 r) noexcept : m(r) {}
+
+    union {
+        __m128 m;
+        EL_ALIGN_DECL(16, T v[4]);
+#if EL_SUPPORT_UNRESTRICTED_UNIONS
+        TVec2<T> xy, rg;
+        TVec3<T> xyz, rgb;
+        struct {
+            union { T x, r; };
+            union {
+                TVec2<T> yz, gb;
+                TVec3<T> yzw, gba;
+                struct {
+                    union { T y, g; };
+                    union {
+                        TVec2<T> zw, ba;
+                        struct { T z, w; };
+                        struct { T b, a; };
+                    };
+                };
+            };
+        };
+#else
+        struct { T x, y, z, w; };
+        struct { T r, g, b, a; };
+#endif // EL_SUPPORT_UNRESTRICTED_UNIONS
+    };
+};
+
+template <>
+class EL_EMPTY_BASES TVec4<float> :
+    public TVec4SseStorage<float>,
+    public TVecAddOperators<TVec4, float>,
+    public TVecProductOperators<TVec4, float>,
+    public TVecCompareOperators<TVec4, float>,
+    public TVecFunctions<TVec4, float>
+{
+public:
+
+    using value_type = float;
+
+    static constexpr size_t SIZE = 4;
+
+    constexpr TVec4() noexcept = default;
+
+    template <typename A, typename = enable_if_arithmetic_t<A>>
+    constexpr TVec4(A a) noexcept : TVec4SseStorage(float(a), float(a), float(a), float(a)) {}
+
+    template <typename A, typename B, typename C, typename D,
+        typename = enable_if_arithmetic_t<A,B,C,D>>
+    constexpr TVec4(A a, B b, C c, D d) noexcept
+        : TVec4SseStorage(float(a), float(b), float(c), float(d)) {}
+
+    template <typename A, typename B, typename = enable_if_arithmetic_t<A, B>>
+    constexpr TVec4(const TVec3<A>& a, B b) noexcept
+        : TVec4SseStorage(float(a[0]), float(a[1]), float(a[2]), float(b)) {}
+
+    explicit TVec4(__m128 r) noexcept : TVec4SseStorage(r) {}
+
+    constexpr size_t size() const noexcept { return SIZE; }
+
+    constexpr const float& operator[](size_t i) const noexcept {
+        assert(i < SIZE);
+        return v[i];
+    }
+
+    constexpr float& operator[](size_t i) noexcept {
+        assert(i < SIZE);
+        return v[i];
+    }
+
+    template <typename U>
+    constexpr TVec4& operator+=(const TVec4<U>& rv) noexcept
+    {
+        if constexpr (std::is_same<U, float>::value) {
+            if (!std::is_constant_evaluated()) {
+                m = _mm_add_ps(m, rv.m);
+                return *this;
+            }
+        }
+        for (size_t i = 0; i < SIZE; i++)
+            v[i] += rv[i];
+        return *this;
+    }
+
+    template <typename U>
+    constexpr TVec4& operator-=(const TVec4<U>& rv) noexcept
+    {
+        if constexpr (std::is_same<U, float>::value) {
+            if (!std::is_constant_evaluated()) {
+                m = _mm_sub_ps(m, rv.m);
+                return *this;
+            }
+        }
+        for (size_t i = 0; i < SIZE; i++)
+            v[i] -= rv[i];
+        return *this;
+    }
+
+    template <typename U>
+    constexpr TVec4& operator*=(const TVec4<U>& rv) noexcept
+    {
+        if constexpr (std::is_same<U, float>::value) {
+            if (!std::is_constant_evaluated()) {
+                m = _mm_mul_ps(m, rv.m);
+                return *this;
+            }
+        }
+        for (size_t i = 0; i < SIZE; i++)
+            v[i] *= rv[i];
+        return *this;
+    }
+
+    template <typename U>
+    constexpr TVec4& operator/=(const TVec4<U>& rv) noexcept
+    {
+        if constexpr (std::is_same<U, float>::value) {
+            if (!std::is_constant_evaluated()) {
+                m = _mm_div_ps(m, rv.m);
+                return *this;
+            }
+        }
+        for (size_t i = 0; i < SIZE; i++)
+            v[i] /= rv[i];
+        return *this;
+    }
+};
+
+static_assert(alignof(TVec4<float>) == 16 && sizeof(TVec4<float>) == 16,
+    "float4 must map onto an __m128");
+
+#endif // EL_SIMD_SSE2
+
+template <typename T> struct TMat44;
+template <typename T> struct TMat34;
+
+// true when R = A * B can go through the el::simd kernels for T
+template <typename T, typename R, typename A, typename B>
+constexpr bool is_simd_mat44_v =
+    std::is_same<R, TMat44<T>>::value &&
+    std::is_same<A, TMat44<T>>::value &&
+    std::is_same<B, TMat44<T>>::value &&
+    ((EL_SIMD_SSE2 && std::is_same<T, float>::value) ||
+     (EL_SIMD_AVX && std::is_same<T, double>::value));
+
+// NO_INIT at run time. Constant evaluation only lets a union member be
+// written once it is the active one, which element stores through
+// operator[] cannot switch, so there the matrix starts value-initialized.
+template <typename MATRIX>
+constexpr MATRIX uninitialized_matrix() noexcept
+{
+    if (std::is_constant_evaluated())
+        return MATRIX();
+    return MATRIX(MATRIX::NO_INIT);
+}
+
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B,
             typename = std::enable_if_t<
                 MATRIX_A::NUM_COLS == MATRIX_B::NUM_ROWS &&
                 MATRIX_R::NUM_COLS == MATRIX_B::NUM_COLS &&
                 MATRIX_R::NUM_ROWS == MATRIX_B::NUM_ROWS>>
-MATRIX_R multiply(const MATRIX_A& lhs, const MATRIX_B& rhs)
+constexpr MATRIX_R multiply(const MATRIX_A& lhs, const MATRIX_B& rhs)
 {
-    MATRIX_R res{};
+    using T = typename MATRIX_R::value_type;
+
+    MATRIX_R res = uninitialized_matrix<MATRIX_R>();
+#if EL_SIMD_SSE2
+    if constexpr (is_simd_mat44_v<T, MATRIX_R, MATRIX_A, MATRIX_B>) {
+        if (!std::is_constant_evaluated()) {
+            simd::mat44_mul(&res[0][0], &lhs[0][0], &rhs[0][0]);
+            return res;
+        }
+    }
+#endif
+    // accumulate in place, column by column, instead of building each
+    // result column from TVec4 temporaries
     for (size_t col = 0; col < MATRIX_R::NUM_COLS; ++col) {
-        res[col] = lhs * rhs[col];
+        for (size_t row = 0; row < MATRIX_R::NUM_ROWS; ++row) {
+            T sum = T(lhs[0][row] * rhs[col][0]);
+            for (size_t k = 1; k < MATRIX_A::NUM_COLS; ++k)
+                sum += lhs[k][row] * rhs[col][k];
+            res[col][row] = sum;
+        }
     }
     return res;
 }
@@ -422,54 +650,61 @@ struct TMat44
 
     col_type m_cols[NUM_COLS];
 
-    explicit TMat44(NoInit) noexcept {}
+    static_assert(sizeof(col_type) == sizeof(T) * COL_SIZE,
+        "el::simd kernels expect 16 contiguous elements");
+
+    constexpr explicit TMat44(NoInit) noexcept {}
 
-    TMat44() noexcept;
+    constexpr TMat44() noexcept;
 
     template <typename A, typename = enable_if_arithmetic_t<A>>
-    explicit TMat44(A v) noexcept;
+    constexpr explicit TMat44(A v) noexcept;
+
+    template <typename A>
+    constexpr explicit TMat44(const TVec4<A>& v) noexcept;
 
+    // affine matrix with (0, 0, 0, 1) as the last row
     template <typename A>
-    explicit TMat44(const TVec4<A>& v) noexcept;
+    constexpr explicit TMat44(const TMat34<A>& m) noexcept;
 
     template <
         typename A, typename B, typename C, typename D,
         typename E, typename F, typename G, typename H,
         typename I, typename J, typename K, typename L,
         typename M, typename N, typename O, typename P>
-    explicit TMat44(A m00, B m01, C m02, D m03,
+    constexpr explicit TMat44(A m00, B m01, C m02, D m03,
                     E m10, F m11, G m12, H m13,
                     I m20, J m21, K m22, L m23,
                     M m30, N m31, O m32, P m33) noexcept;
 
-    const col_type& operator[](size_t col) const
+    constexpr const col_type& operator[](size_t col) const
     {
         assert(col < NUM_COLS);
         return m_cols[col];
     }
 
-    col_type& operator[](size_t col)
+    constexpr col_type& operator[](size_t col)
     {
         assert(col < NUM_COLS);
         return m_cols[col];
     }
 
     template<typename A>
-    static TMat44 translation(const TVec3<A>& t) noexcept {
+    static constexpr TMat44 translation(const TVec3<A>& t) noexcept {
         TMat44 r;
         r[3] = TVec4<T>{ t, 1 };
         return r;
     }
 
     template<typename A>
-    static TMat44 scaling(const TVec3<A>& s) noexcept {
+    static constexpr TMat44 scaling(const TVec3<A>& s) noexcept {
         return TMat44{ TVec4<T>{ s, 1 }};
     }
 
 private:
 
     template <typename U>
-    friend inline TMat44<arithmetic_result_t<T, U>>
+    friend constexpr TMat44<arithmetic_result_t<T, U>>
     operator*(const TMat44<T>& lv, const TMat44<U>& rv)
     {
         return multiply<TMat44<arithmetic_result_t<T, U>>>(lv, rv);
@@ -477,19 +712,32 @@ private:
 
     // matrix * vector
     template <typename U>
-    friend inline typename TMat44<arithmetic_result_t<T, U>>::col_type
+    friend constexpr typename TMat44<arithmetic_result_t<T, U>>::col_type
     operator*(const TMat44<T>& lv, const TVec4<U>& rv)
     {
-        typename TMat44<arithmetic_result_t<T, U>>::col_type res{};
-        for (size_t col = 0; col < TMat44::NUM_COLS; ++col) {
-            res += lv[col] * rv[col];
+        using R = arithmetic_result_t<T, U>;
+
+        typename TMat44<R>::col_type res{};
+#if EL_SIMD_SSE2
+        if constexpr (is_simd_mat44_v<R, TMat44<R>, TMat44<T>, TMat44<U>>) {
+            if (!std::is_constant_evaluated()) {
+                simd::mat44_mul_vec4(&res[0], &lv[0][0], &rv[0]);
+                return res;
+            }
+        }
+#endif
+        for (size_t row = 0; row < TMat44::NUM_ROWS; ++row) {
+            R sum = R(lv[0][row] * rv[0]);
+            for (size_t col = 1; col < TMat44::NUM_COLS; ++col)
+                sum += lv[col][row] * rv[col];
+            res[row] = sum;
         }
         return res;
     }
 };
 
 template <typename T>
-TMat44<T>::TMat44() noexcept
+constexpr TMat44<T>::TMat44() noexcept
     : m_cols {
         col_type(1, 0, 0, 0),
         col_type(0, 1, 0, 0),
@@ -499,7 +747,7 @@ TMat44<T>::TMat44() noexcept
 
 template <typename T>
 template <typename A,typename>
-TMat44<T>::TMat44(A v) noexcept 
+constexpr TMat44<T>::TMat44(A v) noexcept
     : m_cols {
         col_type(v, 0, 0, 0),
         col_type(0, v, 0, 0),
@@ -509,7 +757,7 @@ TMat44<T>::TMat44(A v) noexcept
 
 template <typename T>
 template <typename A>
-TMat44<T>::TMat44(const TVec4<A>& v) noexcept
+constexpr TMat44<T>::TMat44(const TVec4<A>& v) noexcept
     : m_cols {
         col_type(v[0], 0, 0, 0),
         col_type(0, v[1], 0, 0),
@@ -523,15 +771,268 @@ template <
     typename E, typename F, typename G, typename H,
     typename I, typename J, typename K, typename L,
     typename M, typename N, typename O, typename P>
-TMat44<T>::TMat44(A m00, B m01, C m02, D m03,
+constexpr TMat44<T>::TMat44(A m00, B m01, C m02, D m03,
                     E m10, F m11, G m12, H m13,
                     I m20, J m21, K m22, L m23,
                     M m30, N m31, O m32, P m33) noexcept
+    : m_cols {
+        col_type(m00, m01, m02, m03),
+        col_type(m10, m11, m12, m13),
+        col_type(m20, m21, m22, m23),
+        col_type(m30, m31, m32, m33) } {
+}
+
+// General inverse by cofactor expansion over 2x2 sub-determinants. A
+// singular matrix yields inf/nan.
+template <typename T>
+constexpr TMat44<T> inverse(const TMat44<T>& m) noexcept
+{
+    TMat44<T> r = uninitialized_matrix<TMat44<T>>();
+#if EL_SIMD_SSE2
+    if constexpr (std::is_same<T, float>::value) {
+        if (!std::is_constant_evaluated()) {
+            simd::mat44_inverse(&r[0][0], &m[0][0]);
+            return r;
+        }
+    }
+#endif
+    // inverse and transpose commute, so the formula is layout agnostic
+    const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+    const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    const T rdet = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    r[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * rdet;
+    r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * rdet;
+    r[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * rdet;
+    r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * rdet;
+
+    r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * rdet;
+    r[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * rdet;
+    r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * rdet;
+    r[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * rdet;
+
+    r[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * rdet;
+    r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * rdet;
+    r[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * rdet;
+    r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * rdet;
+
+    r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * rdet;
+    r[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * rdet;
+    r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * rdet;
+    r[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * rdet;
+    return r;
+}
+
+// writes the inverse of | L t | given the rows of L^-1
+//                       | 0 1 |
+template <typename T>
+constexpr void set_affine_inverse(TMat44<T>& r, const TVec3<T> li[3], const TVec4<T>& t) noexcept
+{
+    for (size_t c = 0; c < 3; ++c)
+        r[c] = TVec4<T>(li[0][c], li[1][c], li[2][c], 0);
+    for (size_t i = 0; i < 3; ++i)
+        r[3][i] = -(li[i][0] * t[0] + li[i][1] * t[1] + li[i][2] * t[2]);
+    r[3][3] = T(1);
+}
+
+// Inverse of a matrix whose last row is (0, 0, 0, 1), roughly a third of
+// the cost of inverse().
+template <typename T>
+constexpr TMat44<T> affineInverse(const TMat44<T>& m) noexcept
 {
-    m_cols[0] = col_type(m00, m01, m02, m03);
-    m_cols[1] = col_type(m10, m11, m12, m13);
-    m_cols[2] = col_type(m20, m21, m22, m23);
-    m_cols[3] = col_type(m30, m31, m32, m33);
+    TMat44<T> r = uninitialized_matrix<TMat44<T>>();
+#if EL_SIMD_SSE2
+    if constexpr (std::is_same<T, float>::value) {
+        if (!std::is_constant_evaluated()) {
+            simd::mat44_affine_inverse(&r[0][0], &m[0][0]);
+            return r;
+        }
+    }
+#endif
+    const TVec3<T> c[3] = {
+        TVec3<T>(m[0][0], m[0][1], m[0][2]),
+        TVec3<T>(m[1][0], m[1][1], m[1][2]),
+        TVec3<T>(m[2][0], m[2][1], m[2][2]) };
+    auto cross = [](const TVec3<T>& a, const TVec3<T>& b) {
+        return TVec3<T>(
+            a[1] * b[2] - a[2] * b[1],
+            a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0]);
+    };
+    TVec3<T> li[3] = { cross(c[1], c[2]), cross(c[2], c[0]), cross(c[0], c[1]) };
+    const T rdet = T(1) / (c[0][0] * li[0][0] + c[0][1] * li[0][1] + c[0][2] * li[0][2]);
+    for (auto& row : li)
+        row *= TVec3<T>(rdet);
+    set_affine_inverse(r, li, m[3]);
+    return r;
+}
+
+// Inverse of rotation + translation, the rotation is transposed.
+template <typename T>
+constexpr TMat44<T> rigidInverse(const TMat44<T>& m) noexcept
+{
+    TMat44<T> r = uninitialized_matrix<TMat44<T>>();
+#if EL_SIMD_SSE2
+    if constexpr (std::is_same<T, float>::value) {
+        if (!std::is_constant_evaluated()) {
+            simd::mat44_rigid_inverse(&r[0][0], &m[0][0]);
+            return r;
+        }
+    }
+#endif
+    const TVec3<T> li[3] = {
+        TVec3<T>(m[0][0], m[0][1], m[0][2]),
+        TVec3<T>(m[1][0], m[1][1], m[1][2]),
+        TVec3<T>(m[2][0], m[2][1], m[2][2]) };
+    set_affine_inverse(r, li, m[3]);
+    return r;
+}
+
+// Affine transform stored without the constant (0, 0, 0, 1) last row: four
+// TVec3 columns, the 3x3 linear part followed by the translation. Composing
+// two of them takes 36 multiplies instead of the 64 of TMat44.
+template <typename T>
+struct TMat34
+{
+    enum NoInit { NO_INIT };
+
+    typedef T value_type;
+    typedef T& referrence;
+    typedef T const& const_reference;
+    typedef size_t size_type;
+
+    typedef TVec3<value_type> col_type;
+
+    static const size_type COL_SIZE = col_type::SIZE;
+    static const size_type NUM_ROWS = COL_SIZE;
+    static const size_type NUM_COLS = 4;
+
+    col_type m_cols[NUM_COLS];
+
+    constexpr explicit TMat34(NoInit) noexcept {}
+
+    constexpr TMat34() noexcept
+        : m_cols {
+            col_type(1, 0, 0),
+            col_type(0, 1, 0),
+            col_type(0, 0, 1),
+            col_type(0, 0, 0) } {
+    }
+
+    template <typename A, typename = enable_if_arithmetic_t<A>>
+    constexpr explicit TMat34(A v) noexcept
+        : m_cols {
+            col_type(v, 0, 0),
+            col_type(0, v, 0),
+            col_type(0, 0, v),
+            col_type(0, 0, 0) } {
+    }
+
+    // drops the last row, which must be (0, 0, 0, 1) for the result to
+    // describe the same transform
+    template <typename A>
+    constexpr explicit TMat34(const TMat44<A>& m) noexcept
+        : m_cols {
+            col_type(m[0][0], m[0][1], m[0][2]),
+            col_type(m[1][0], m[1][1], m[1][2]),
+            col_type(m[2][0], m[2][1], m[2][2]),
+            col_type(m[3][0], m[3][1], m[3][2]) } {
+    }
+
+    constexpr const col_type& operator[](size_t col) const
+    {
+        assert(col < NUM_COLS);
+        return m_cols[col];
+    }
+
+    constexpr col_type& operator[](size_t col)
+    {
+        assert(col < NUM_COLS);
+        return m_cols[col];
+    }
+
+    template<typename A>
+    static constexpr TMat34 translation(const TVec3<A>& t) noexcept {
+        TMat34 r;
+        r[3] = col_type(t[0], t[1], t[2]);
+        return r;
+    }
+
+    template<typename A>
+    static constexpr TMat34 scaling(const TVec3<A>& s) noexcept {
+        TMat34 r;
+        r[0][0] = s[0];
+        r[1][1] = s[1];
+        r[2][2] = s[2];
+        return r;
+    }
+
+private:
+
+    // applies the linear part of l to (x, y, z) and adds w * translation
+    template <typename R, typename U>
+    static constexpr TVec3<R> transform(const TMat34<T>& l, U x, U y, U z, U w) noexcept
+    {
+        TVec3<R> res{};
+        for (size_t row = 0; row < NUM_ROWS; ++row)
+            res[row] = l[0][row] * x + l[1][row] * y + l[2][row] * z + l[3][row] * w;
+        return res;
+    }
+
+    // the linear part of l alone, three multiplies per row; a w of 0 or 1
+    // would still cost a fourth, IEEE floats can't drop it
+    template <typename R, typename U>
+    static constexpr TVec3<R> linear(const TMat34<T>& l, U x, U y, U z) noexcept
+    {
+        TVec3<R> res{};
+        for (size_t row = 0; row < NUM_ROWS; ++row)
+            res[row] = l[0][row] * x + l[1][row] * y + l[2][row] * z;
+        return res;
+    }
+
+    template <typename U>
+    friend constexpr TMat34<arithmetic_result_t<T, U>>
+    operator*(const TMat34<T>& lv, const TMat34<U>& rv)
+    {
+        using R = arithmetic_result_t<T, U>;
+        TMat34<R> res = uninitialized_matrix<TMat34<R>>();
+        for (size_t col = 0; col < 3; ++col)
+            res[col] = linear<R>(lv, rv[col][0], rv[col][1], rv[col][2]);
+        res[3] = linear<R>(lv, rv[3][0], rv[3][1], rv[3][2]);
+        for (size_t row = 0; row < NUM_ROWS; ++row)
+            res[3][row] += lv[3][row];
+        return res;
+    }
+
+    // matrix * vector, w = 1 transforms a point and w = 0 a direction
+    template <typename U>
+    friend constexpr TVec3<arithmetic_result_t<T, U>>
+    operator*(const TMat34<T>& lv, const TVec4<U>& rv)
+    {
+        return transform<arithmetic_result_t<T, U>>(lv, rv[0], rv[1], rv[2], rv[3]);
+    }
+};
+
+template <typename T>
+template <typename A>
+constexpr TMat44<T>::TMat44(const TMat34<A>& m) noexcept
+    : m_cols {
+        col_type(m[0], 0),
+        col_type(m[1], 0),
+        col_type(m[2], 0),
+        col_type(m[3], 1) } {
 }
 
 } // namespace detail
@@ -552,6 +1053,9 @@ using float4 = vec4<float>;
 using mat4 = details::TMat44<double>;
 using mat4f = details::TMat44<float>;
 
+using mat34 = details::TMat34<double>;
+using mat34f = details::TMat34<float>;
+
 } // namespace el
 
 #endif // __EL_MATH_VEC4_H__
\ No newline at end of file
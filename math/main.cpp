@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
 #include <gtest/gtest.h>
 #include "el_vec4.h"
+#include "el_transform.h"
+#include "el_dispatch.h"
 
 using namespace el;
 
@@ -28,8 +35,55 @@ class VecTest : public testing::Test {
 protected:
 };
 
+namespace {
+
+// quadratic Bezier lookup table baked at compile time
+template <size_t N>
+constexpr std::array<float3, N> bezierTable(const float3& p0, const float3& p1, const float3& p2)
+{
+    std::array<float3, N> table{};
+    for (size_t i = 0; i < N; ++i) {
+        const float t = float(i) / float(N - 1);
+        const float q = 1.f - t;
+        table[i] = q * q * p0 + 2.f * t * q * p1 + t * t * p2;
+    }
+    return table;
+}
+
+} // namespace
+
 TEST_F(VecTest, constexpr) {
     constexpr double4 v1{};
+    static_assert(v1[0] == 0 && v1[3] == 0);
+
+    constexpr double4 v2(1, 2, 3, 4);
+    constexpr double4 v3 = v2 * 2.0 + v2;
+    static_assert(v3 == double4(3, 6, 9, 12));
+    static_assert(mix(v1, v2, 0.5) == double4(0.5, 1, 1.5, 2));
+    static_assert(clamp(v2, 2.0, 3.0) == double4(2, 2, 3, 3));
+
+    constexpr auto table = bezierTable<5>(
+        float3(0.f, 0.f, 0.f), float3(1.f, 2.f, 0.f), float3(2.f, 0.f, 0.f));
+    static_assert(table[0] == float3(0.f, 0.f, 0.f));
+    static_assert(table[2] == float3(1.f, 1.f, 0.f));
+    static_assert(table[4] == float3(2.f, 0.f, 0.f));
+
+    constexpr mat4 m = mat4::translation(double3(1, 2, 3)) * mat4::scaling(double3(2, 4, 8));
+    static_assert(m * double4(1, 1, 1, 1) == double4(3, 6, 11, 1));
+    static_assert(affineInverse(m) * double4(3, 6, 11, 1) == double4(1, 1, 1, 1));
+    static_assert(inverse(m) * double4(3, 6, 11, 1) == double4(1, 1, 1, 1));
+    static_assert(rigidInverse(mat4::translation(double3(1, 2, 3)))[3] == double4(-1, -2, -3, 1));
+
+    constexpr mat4f mf = mat4f::scaling(float3(2.f, 2.f, 2.f)) * mat4f::translation(float3(1.f, 0.f, 0.f));
+    static_assert(mf[3] == float4(2.f, 0.f, 0.f, 1.f));
+    static_assert(inverse(mf)[0] == float4(0.5f, 0.f, 0.f, 0.f));
+
+    constexpr mat34f a = mat34f::translation(float3(1.f, 2.f, 3.f)) * mat34f::scaling(float3(2.f, 2.f, 2.f));
+    static_assert(a * float4(1.f, 1.f, 1.f, 1.f) == float3(3.f, 4.f, 5.f));
+    static_assert(mat4f(a)[3] == float4(1.f, 2.f, 3.f, 1.f));
+
+    // the table is usable at run time as plain data
+    EXPECT_EQ(table[1], float3(0.5f, 0.75f, 0.f));
 }
 
 TEST_F(VecTest, Basics) {
@@ -72,6 +126,72 @@ TEST_F(VecTest, Arithmetic) {
     EXPECT_EQ(d.b, 6);
 }
 
+TEST_F(VecTest, MixedTypes) {
+    double4 a(1, 2, 3, 4);
+    double4 b(10, 20, 30, 40);
+    float4 f(2);
+
+    // products promote, the other operators keep the lhs vector type
+    static_assert(std::is_same<decltype(a * f), double4>::value, "");
+    static_assert(std::is_same<decltype(f * a), double4>::value, "");
+    static_assert(std::is_same<decltype(f + a), float4>::value, "");
+    static_assert(std::is_same<decltype(2 * f), float4>::value, "");
+
+    double4 r = a * 2 + b / 10 - 1;
+    EXPECT_EQ(r, double4(2, 5, 8, 11));
+
+    r = 2 * (a + b) * f;
+    EXPECT_EQ(r, double4(44, 88, 132, 176));
+
+    r += a * b;
+    r -= a;
+    r *= f;
+    r /= double4(2);
+    EXPECT_EQ(r, double4(53, 126, 219, 332));
+
+    // an auto holds a value, not a view of a
+    auto e = double4(1) + a;
+    a = double4(0);
+    EXPECT_EQ(e, double4(2, 3, 4, 5));
+}
+
+TEST_F(VecTest, Float4) {
+#if EL_SIMD_SSE2
+    static_assert(alignof(float4) == 16, "");
+#endif
+    const float4 a(1.f, -2.f, 3.5f, 4.f);
+    const float4 b(0.5f, 3.f, -1.f, 2.f);
+    const float4 c(-4.f, 1.f, 0.25f, 8.f);
+
+    // vectorized operators against the component loop
+    float4 r = a * b + c - b / 2.f + 3 * a;
+    for (size_t i = 0; i < r.size(); ++i)
+        EXPECT_FLOAT_EQ(r[i], a[i] * b[i] + c[i] - b[i] / 2.f + 3 * a[i]);
+
+    // a double scalar is applied per component in double
+    float4 d = a * 0.1;
+    for (size_t i = 0; i < d.size(); ++i)
+        EXPECT_EQ(d[i], float(a[i] * 0.1));
+
+    r = a;
+    r += b;
+    r -= c;
+    r *= b;
+    r /= float4(2.f);
+    for (size_t i = 0; i < r.size(); ++i)
+        EXPECT_FLOAT_EQ(r[i], (a[i] + b[i] - c[i]) * b[i] / 2.f);
+
+#if EL_SUPPORT_UNRESTRICTED_UNIONS
+    // swizzles still alias the vector register
+    r = float4(1.f, 2.f, 3.f, 4.f);
+    EXPECT_EQ(r.xyz, float3(1.f, 2.f, 3.f));
+    EXPECT_EQ(r.zw[0], 3.f);
+    EXPECT_EQ(r.w, 4.f);
+    r.xyz = float3(5.f, 6.f, 7.f);
+    EXPECT_EQ(r, float4(5.f, 6.f, 7.f, 4.f));
+#endif
+}
+
 float3 linear_bazier(float3 start_position, float3 end_position, float t)
 {
     return mix(start_position, end_position, t);
@@ -118,6 +238,22 @@ void test()
 }
 
 
+TEST_F(VecTest, QuadraticBezier) {
+    float3 positions[3] = {
+        float3(0.f, 1.f, 2.f),
+        float3(3.f, -1.f, 0.5f),
+        float3(-2.f, 4.f, 1.f) };
+    for (float t = 0.f; t <= 1.f; t += 0.125f) {
+        float3 p = quadratic_bazier(positions, t);
+        const float q = 1.f - t;
+        for (size_t i = 0; i < 3; ++i) {
+            const float expected = q * q * positions[0][i] +
+                2 * t * q * positions[1][i] + t * t * positions[2][i];
+            EXPECT_NEAR(expected, p[i], 1e-6f);
+        }
+    }
+}
+
 class MatTest : public testing::Test {
 protected:
 };
@@ -188,6 +324,279 @@ TYPED_TEST(MatTestT, Translation4) {
     double k = clamp(1.0, 0.5, 3.5);
 }
 
+TYPED_TEST(MatTestT, Multiply) {
+    typedef el::details::TMat44<TypeParam> M44T;
+    typedef el::details::TVec4<TypeParam> V4T;
+    typedef el::details::TVec3<TypeParam> V3T;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<TypeParam> dist(-10, 10);
+    auto random = [&]() {
+        M44T m(M44T::NO_INIT);
+        for (size_t c = 0; c < M44T::NUM_COLS; ++c)
+            for (size_t r = 0; r < M44T::NUM_ROWS; ++r)
+                m[c][r] = dist(gen);
+        return m;
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        M44T a = random();
+        M44T b = random();
+        M44T ab = a * b;
+        for (size_t c = 0; c < M44T::NUM_COLS; ++c) {
+            for (size_t r = 0; r < M44T::NUM_ROWS; ++r) {
+                double expected = 0;
+                for (size_t k = 0; k < M44T::NUM_COLS; ++k)
+                    expected += double(a[k][r]) * double(b[c][k]);
+                EXPECT_NEAR(expected, ab[c][r], 1e-3);
+            }
+        }
+
+        V4T v(dist(gen), dist(gen), dist(gen), dist(gen));
+        V4T av = a * v;
+        for (size_t r = 0; r < M44T::NUM_ROWS; ++r) {
+            double expected = 0;
+            for (size_t k = 0; k < M44T::NUM_COLS; ++k)
+                expected += double(a[k][r]) * double(v[k]);
+            EXPECT_NEAR(expected, av[r], 1e-3);
+        }
+    }
+
+    // translate(scale(p)) applied right to left
+    M44T ts = M44T::translation(V3T(1, 2, 3)) * M44T::scaling(V3T(2, 2, 2));
+    EXPECT_VEC_EQ((ts * V4T(1, 1, 1, 1)), V4T(3, 4, 5, 1));
+}
+
+TYPED_TEST(MatTestT, Inverse) {
+    typedef el::details::TMat44<TypeParam> M44T;
+    typedef el::details::TVec3<TypeParam> V3T;
+
+    const TypeParam eps = std::is_same<TypeParam, float>::value ? 1e-4 : 1e-10;
+    auto expectIdentity = [eps](const M44T& m) {
+        for (size_t c = 0; c < M44T::NUM_COLS; ++c)
+            for (size_t r = 0; r < M44T::NUM_ROWS; ++r)
+                EXPECT_NEAR(c == r ? 1 : 0, m[c][r], eps);
+    };
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<TypeParam> dist(-1, 1);
+    for (int i = 0; i < 100; ++i) {
+        // diagonally dominant, so well conditioned
+        M44T m(M44T::NO_INIT);
+        for (size_t c = 0; c < M44T::NUM_COLS; ++c)
+            for (size_t r = 0; r < M44T::NUM_ROWS; ++r)
+                m[c][r] = dist(gen) + (c == r ? 4 : 0);
+        expectIdentity(m * inverse(m));
+        expectIdentity(inverse(m) * m);
+
+        // scale, shear and translation
+        M44T a = m;
+        a[0][3] = a[1][3] = a[2][3] = 0;
+        a[3][3] = 1;
+        expectIdentity(a * affineInverse(a));
+
+        // rotation about a random axis + translation
+        V3T axis(dist(gen), dist(gen), dist(gen) + 2);
+        const TypeParam len = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        const TypeParam x = axis[0] / len, y = axis[1] / len, z = axis[2] / len;
+        const TypeParam angle = dist(gen) * 3, s = std::sin(angle), c = std::cos(angle), t = 1 - c;
+        M44T rot(
+            t * x * x + c,     t * x * y + s * z, t * x * z - s * y, 0,
+            t * x * y - s * z, t * y * y + c,     t * y * z + s * x, 0,
+            t * x * z + s * y, t * y * z - s * x, t * z * z + c,     0,
+            dist(gen) * 10,    dist(gen) * 10,    dist(gen) * 10,    1);
+        expectIdentity(rot * rigidInverse(rot));
+        expectIdentity(rot * affineInverse(rot));
+        expectIdentity(rot * inverse(rot));
+    }
+
+    M44T t = M44T::translation(V3T(1, 2, 3)) * M44T::scaling(V3T(2, 4, 8));
+    M44T ti = inverse(t);
+    EXPECT_NEAR(ti[0][0], 0.5, eps);
+    EXPECT_NEAR(ti[1][1], 0.25, eps);
+    EXPECT_NEAR(ti[2][2], 0.125, eps);
+    EXPECT_NEAR(ti[3][0], -0.5, eps);
+    EXPECT_NEAR(ti[3][1], -0.5, eps);
+    EXPECT_NEAR(ti[3][2], -0.375, eps);
+}
+
+TYPED_TEST(MatTestT, Affine34) {
+    typedef el::details::TMat44<TypeParam> M44T;
+    typedef el::details::TMat34<TypeParam> M34T;
+    typedef el::details::TVec4<TypeParam> V4T;
+    typedef el::details::TVec3<TypeParam> V3T;
+
+    EXPECT_EQ(sizeof(M34T), sizeof(TypeParam) * 12);
+
+    const V3T t(1, -2, 3), sc(2, 3, 4);
+    M44T a44 = M44T::translation(t) * M44T::scaling(sc);
+    M34T a34 = M34T::translation(t) * M34T::scaling(sc);
+
+    // shear plus translation for the right hand side
+    M44T b44(
+        1, 0.5, 0, 0,
+        0, 1, 0.25, 0,
+        0.1, 0, 1, 0,
+        -4, 5, 6, 1);
+    M34T b34(b44);
+
+    M44T ab44 = a44 * b44;
+    M44T ab34(a34 * b34);
+    for (size_t c = 0; c < M44T::NUM_COLS; ++c)
+        EXPECT_VEC_EQ(ab44[c], ab34[c]);
+
+    const V4T p(0.5, -1.5, 2, 1), d(0.5, -1.5, 2, 0);
+    EXPECT_VEC_EQ((ab44 * p).xyz, (a34 * b34) * p);
+    EXPECT_VEC_EQ((ab44 * d).xyz, (a34 * b34) * d);
+
+    // round trip through the 4x4 form
+    M34T back{ M44T(a34) };
+    for (size_t c = 0; c < M34T::NUM_COLS; ++c)
+        EXPECT_VEC_EQ(back[c], a34[c]);
+    const M44T identity{ M34T() };
+    EXPECT_VEC_EQ(identity[3], V4T(0, 0, 0, 1));
+}
+
+class TransformTest : public testing::Test {
+protected:
+    mat4f m = mat4f::translation(float3(1.f, -2.f, 3.f)) * mat4f(
+        0.f, 2.f, 0.f, 0.f,
+        -1.f, 0.f, 0.f, 0.f,
+        0.f, 0.f, 3.f, 0.f,
+        0.f, 0.f, 0.f, 1.f);
+};
+
+TEST_F(TransformTest, PointsAndVectors) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+    // odd sizes exercise the SIMD tails, the large one the threaded split
+    for (size_t count : { 0, 1, 3, 4, 5, 8, 13, 100003 }) {
+        std::vector<float3> in(count);
+        for (auto& p : in)
+            p = float3(dist(gen), dist(gen), dist(gen));
+
+        std::vector<float3> points(count), vectors(count);
+        transformPoints(m, in.data(), points.data(), count, 4);
+        transformVectors(m, in.data(), vectors.data(), count, 4);
+
+        std::vector<float> x(count), y(count), z(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = in[i].x;
+            y[i] = in[i].y;
+            z[i] = in[i].z;
+        }
+        std::vector<float> vx(x), vy(y), vz(z);
+        transformPoints(m, { x.data(), y.data(), z.data() },
+            { x.data(), y.data(), z.data() }, count, 0);
+        transformVectors(m, { vx.data(), vy.data(), vz.data() },
+            { vx.data(), vy.data(), vz.data() }, count);
+
+        for (size_t i = 0; i < count; ++i) {
+            float4 p = m * float4(in[i], 1.f);
+            float4 v = m * float4(in[i], 0.f);
+            for (size_t k = 0; k < 3; ++k) {
+                EXPECT_NEAR(p[k], points[i][k], 1e-3f);
+                EXPECT_NEAR(v[k], vectors[i][k], 1e-3f);
+            }
+            EXPECT_NEAR(p.x, x[i], 1e-3f);
+            EXPECT_NEAR(p.y, y[i], 1e-3f);
+            EXPECT_NEAR(p.z, z[i], 1e-3f);
+            EXPECT_NEAR(v.x, vx[i], 1e-3f);
+            EXPECT_NEAR(v.y, vy[i], 1e-3f);
+            EXPECT_NEAR(v.z, vz[i], 1e-3f);
+        }
+    }
+}
+
+TEST_F(TransformTest, InPlace) {
+    std::vector<float3> pts = { float3(1, 0, 0), float3(0, 1, 0), float3(0, 0, 1),
+        float3(1, 1, 1), float3(2, 3, 4) };
+    std::vector<float3> expected(pts);
+    for (auto& p : expected)
+        p = (m * float4(p, 1.f)).xyz;
+
+    transformPoints(m, pts.data(), pts.data(), pts.size());
+    for (size_t i = 0; i < pts.size(); ++i)
+        for (size_t k = 0; k < 3; ++k)
+            EXPECT_FLOAT_EQ(expected[i][k], pts[i][k]);
+}
+
+TEST_F(TransformTest, BatchInverse) {
+    std::vector<mat4f> in(1000), out(in.size());
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = m * mat4f::translation(float3(float(i), 1.f, -float(i)));
+
+    inverse(in.data(), out.data(), in.size(), 4);
+    for (size_t i = 0; i < in.size(); ++i)
+        EXPECT_NEAR((in[i] * out[i])[3][0], 0.f, 1e-3f);
+
+    affineInverse(in.data(), out.data(), in.size());
+    for (size_t i = 0; i < in.size(); ++i)
+        EXPECT_NEAR((in[i] * out[i])[3][0], 0.f, 1e-3f);
+
+    // in place
+    std::vector<mat4f> copy(in);
+    affineInverse(copy.data(), copy.data(), copy.size());
+    for (size_t i = 0; i < in.size(); ++i)
+        for (size_t c = 0; c < 4; ++c)
+            for (size_t r = 0; r < 4; ++r)
+                EXPECT_FLOAT_EQ(out[i][c][r], copy[i][c][r]);
+}
+
+TEST(DispatchTest, LevelsAgree) {
+    const SimdLevel best = bestSimdLevel();
+    EXPECT_EQ(simdLevel(), best);
+    EXPECT_EQ(setSimdLevel(SimdLevel::AVX512), best);
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+    const float m[16] = { 0.f, 2.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f,
+        0.f, 0.f, 3.f, 0.f, 1.f, -2.f, 3.f, 1.f };
+    const float p[12] = { 0.f, 0.f, 0.f, 1.f, 2.f, 0.f, 3.f, -1.f, 1.f, 4.f, 0.f, 2.f };
+
+    // 37 elements reach the 16, 8 and 4 wide loops and the scalar tail
+    const size_t count = 37;
+    std::vector<float> in(count * 3), t(count);
+    for (auto& f : in)
+        f = dist(gen);
+    in[6] = in[7] = in[8] = 0.f;
+    for (size_t i = 0; i < count; ++i)
+        t[i] = float(i) / float(count - 1);
+
+    auto run = [&](const dispatch::Kernels& k) {
+        std::vector<float> r(count * 3 * 5);
+        float* aos = r.data();
+        float* soa = aos + count * 3;
+        float* norm = soa + count * 3;
+        float* fast = norm + count * 3;
+        float* curve = fast + count * 3;
+        k.transform3_aos(m, 1.f, in.data(), aos, count);
+        k.transform3_soa(m, 0.f, in.data(), in.data() + count, in.data() + count * 2,
+            soa, soa + count, soa + count * 2, count);
+        std::copy(in.begin(), in.end(), norm);
+        k.normalize3_soa(norm, norm + count, norm + count * 2, count, 1e-6f);
+        std::copy(in.begin(), in.end(), fast);
+        k.normalize3_soa_fast(fast, fast + count, fast + count * 2, count, 1e-6f);
+        k.bezier3_soa(p, t.data(), curve, curve + count, curve + count * 2, count);
+        return r;
+    };
+
+    const std::vector<float> expected = run(dispatch::baselineKernels());
+    for (size_t i = 0; i < count * 3; ++i)
+        EXPECT_NEAR(expected[count * 9 + i], expected[count * 6 + i], 1e-6f);
+    for (SimdLevel level : { SimdLevel::Baseline, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (level > best)
+            break;
+        EXPECT_EQ(setSimdLevel(level), level);
+        SCOPED_TRACE(toString(level));
+        const std::vector<float> r = run(dispatch::kernels());
+        for (size_t i = 0; i < r.size(); ++i)
+            EXPECT_NEAR(r[i], expected[i], 1e-4f);
+    }
+    setSimdLevel(best);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,58 @@
+#include "BezierSpline.h"
+
+#include <cassert>
+#include "../profiler/Profiler.h"
+
+void BezierSpline::assign(std::span<const vec3> points, int segmentSamples)
+{
+    assert(points.size() % 3 == 1 && segmentSamples > 0);
+
+    mPoints.assign(points.begin(), points.end());
+    mDirty.assign(mPoints.size() / 3, 1);
+    mSegmentSamples = segmentSamples;
+
+    mT.resize(size_t(segmentSamples) + 1);
+    for (int i = 0; i <= segmentSamples; i++)
+        mT[size_t(i)] = (float)i / segmentSamples;
+    mSamples.resize(segmentCount() * size_t(segmentSamples) + 1);
+}
+
+gszauer::Bezier<vec3> BezierSpline::segment(size_t i) const
+{
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = mPoints[3 * i];
+    curve.C1 = mPoints[3 * i + 1];
+    curve.C2 = mPoints[3 * i + 2];
+    curve.P2 = mPoints[3 * i + 3];
+    return curve;
+}
+
+void BezierSpline::setPoint(size_t i, vec3 p)
+{
+    mPoints[i] = p;
+    // an anchor ends the segment before it and starts the one after it
+    const size_t s = i / 3;
+    if (s < segmentCount())
+        mDirty[s] = 1;
+    if (i % 3 == 0 && s > 0)
+        mDirty[s - 1] = 1;
+}
+
+size_t BezierSpline::tessellate()
+{
+    const uint64_t start = profiler::now();
+    size_t count = 0;
+    for (size_t s = 0; s < segmentCount(); s++) {
+        if (!mDirty[s])
+            continue;
+        // the sample at an inner anchor is the next segment's first, only
+        // the last segment ends on its own
+        const size_t first = s * size_t(mSegmentSamples);
+        const std::span<const float> t = s + 1 < segmentCount() ? std::span<const float>(mT).first(mT.size() - 1) : mT;
+        gszauer::interpolate(segment(s), t, mSamples.x() + first, mSamples.y() + first, mSamples.z() + first);
+        mDirty[s] = 0;
+        count++;
+    }
+    mLastTime = profiler::now() - start;
+    return count;
+}
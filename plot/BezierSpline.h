@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../gszauer/Vec3.h"
+#include "../gszauer/Vec4.h"
+#include "../gszauer/VecStream.h"
+
+// Chain of cubic Bezier segments that share their end points, with the
+// samples of every segment retained. The points run anchor, control,
+// control, anchor, control, ..., so segment i is points 3i to 3i + 3.
+// Moving a point marks the segments it shapes, one or the two meeting at an
+// anchor, and tessellate() evaluates only those again; dragging one handle
+// of a long spline costs two segments instead of all of them.
+//
+//     spline.setPoint(i, p);
+//     spline.tessellate();
+//     grid.drawPolyline(spline.samples(), color);
+class BezierSpline
+{
+public:
+    BezierSpline() = default;
+    BezierSpline(std::span<const vec3> points, int segmentSamples) { assign(points, segmentSamples); }
+
+    // 3n + 1 points for n segments, each sampled at segmentSamples + 1
+    // evenly spaced t; marks every segment
+    void assign(std::span<const vec3> points, int segmentSamples);
+
+    size_t segmentCount() const { return mDirty.size(); }
+    int segmentSamples() const { return mSegmentSamples; }
+    std::span<const vec3> points() const { return mPoints; }
+    gszauer::Bezier<vec3> segment(size_t i) const;
+
+    // moves point i and marks the segments it belongs to
+    void setPoint(size_t i, vec3 p);
+
+    // Samples the marked segments again and returns how many there were.
+    // Records the time it took in lastTime().
+    size_t tessellate();
+
+    // the samples of all segments as one polyline, a segment's last sample
+    // being the next one's first; current as of the last tessellate()
+    const gszauer::Vec3Stream& samples() const { return mSamples; }
+
+    // nanoseconds the last tessellate() took
+    uint64_t lastTime() const { return mLastTime; }
+
+private:
+    std::vector<vec3> mPoints;
+    std::vector<char> mDirty;       // per segment
+    int mSegmentSamples = 0;
+    std::vector<float> mT;          // segmentSamples + 1 evenly spaced
+    gszauer::Vec3Stream mSamples;
+    uint64_t mLastTime = 0;
+};
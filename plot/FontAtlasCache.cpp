@@ -0,0 +1,349 @@
+#include "FontAtlasCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <imgui_internal.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Layout of the file: a Header, a FontRecord per font, a RectRecord per
+// custom rect, the glyphs of every font in font order, then the pixels.
+// All of it in the byte order and ImGui build of the writer, which the
+// header checks.
+constexpr char MAGIC[8] = { 'I', 'M', 'A', 'T', 'L', 'A', 'S', '1' };
+
+struct Header
+{
+    char magic[8];
+    uint32_t imguiVersion;
+    uint32_t key;
+    uint32_t glyphSize;
+    int32_t texWidth, texHeight;
+    int32_t fonts, rects;
+    int32_t packIdMouseCursors, packIdLines;
+    ImVec2 texUvScale;
+    ImVec2 texUvWhitePixel;
+    ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+};
+
+struct FontRecord
+{
+    int32_t config;         // first of the font's ImFontConfig
+    int32_t configCount;
+    int32_t glyphs;
+    int32_t metricsTotalSurface;
+    float fontSize, ascent, descent;
+    uint32_t ellipsisChar;
+};
+
+struct RectRecord
+{
+    uint16_t width, height, x, y;
+    uint32_t glyphId;
+    float glyphAdvanceX;
+    ImVec2 glyphOffset;
+    int32_t font;           // -1 for none
+};
+
+// read only view of a whole file, empty if it can't be mapped
+class MappedFile
+{
+public:
+    explicit MappedFile(const char* path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            if (HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)) {
+                mData = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                mSize = mData ? size_t(size.QuadPart) : 0;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mData = static_cast<const unsigned char*>(data);
+                mSize = size_t(st.st_size);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+        if (mData == nullptr)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(mData);
+#else
+        munmap(const_cast<unsigned char*>(mData), mSize);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    const unsigned char* mData = nullptr;
+    size_t mSize = 0;
+};
+
+int fontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+        if (atlas->Fonts[i] == font)
+            return i;
+    return -1;
+}
+
+// hash of the build inputs, see the header
+ImU32 atlasKey(ImFontAtlas* atlas)
+{
+    ImU32 seed = 0;
+    auto hash = [&seed](const void* data, size_t size) { seed = ImHashData(data, size, seed); };
+    auto value = [&hash](const auto& v) { hash(&v, sizeof(v)); };
+
+    value(atlas->Flags);
+    value(atlas->TexDesiredWidth);
+    value(atlas->TexGlyphPadding);
+    value(atlas->PackIdMouseCursors);
+    value(atlas->PackIdLines);
+    for (const ImFontConfig& cfg : atlas->ConfigData) {
+        hash(cfg.FontData, size_t(cfg.FontDataSize));
+        value(cfg.FontNo);
+        value(cfg.SizePixels);
+        value(cfg.OversampleH);
+        value(cfg.OversampleV);
+        value(cfg.PixelSnapH);
+        value(cfg.GlyphExtraSpacing);
+        value(cfg.GlyphOffset);
+        value(cfg.GlyphMinAdvanceX);
+        value(cfg.GlyphMaxAdvanceX);
+        value(cfg.MergeMode);
+        value(cfg.RasterizerFlags);
+        value(cfg.RasterizerMultiply);
+        value(cfg.EllipsisChar);
+        value(fontIndex(atlas, cfg.DstFont));
+
+        const ImWchar* ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+        size_t count = 0;
+        while (ranges[count] != 0)
+            count++;
+        hash(ranges, count * sizeof(ImWchar));
+    }
+    for (const ImFontAtlasCustomRect& r : atlas->CustomRects) {
+        value(r.Width);
+        value(r.Height);
+        value(r.GlyphID);
+        value(r.GlyphAdvanceX);
+        value(r.GlyphOffset);
+        value(fontIndex(atlas, r.Font));
+    }
+    return seed;
+}
+
+bool load(ImFontAtlas* atlas, const char* path, ImU32 key)
+{
+    const MappedFile file(path);
+    if (file.size() < sizeof(Header))
+        return false;
+
+    Header h;
+    memcpy(&h, file.data(), sizeof(h));
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.imguiVersion != IMGUI_VERSION_NUM || h.key != key
+        || h.glyphSize != sizeof(ImFontGlyph) || h.fonts != atlas->Fonts.Size || h.rects < atlas->CustomRects.Size
+        || h.texWidth <= 0 || h.texHeight <= 0)
+        return false;
+
+    std::vector<FontRecord> fonts(size_t(h.fonts));
+    std::vector<RectRecord> rects(size_t(h.rects));
+    const unsigned char* p = file.data() + sizeof(Header);
+    const size_t records = fonts.size() * sizeof(FontRecord) + rects.size() * sizeof(RectRecord);
+    if (file.size() < sizeof(Header) + records)
+        return false;
+    memcpy(fonts.data(), p, fonts.size() * sizeof(FontRecord));
+    p += fonts.size() * sizeof(FontRecord);
+    memcpy(rects.data(), p, rects.size() * sizeof(RectRecord));
+    p += rects.size() * sizeof(RectRecord);
+
+    size_t glyphs = 0;
+    for (const FontRecord& f : fonts) {
+        if (f.config < 0 || f.configCount < 1 || f.config + f.configCount > atlas->ConfigData.Size || f.glyphs < 0)
+            return false;
+        glyphs += size_t(f.glyphs);
+    }
+    for (const RectRecord& r : rects)
+        if (r.font < -1 || r.font >= h.fonts)
+            return false;
+    const size_t pixels = size_t(h.texWidth) * size_t(h.texHeight);
+    if (file.size() != sizeof(Header) + records + glyphs * sizeof(ImFontGlyph) + pixels * 4)
+        return false;
+
+    // everything checks out, the atlas takes it over as if it was built
+    atlas->ClearTexData();
+    atlas->TexWidth = h.texWidth;
+    atlas->TexHeight = h.texHeight;
+    atlas->TexUvScale = h.texUvScale;
+    atlas->TexUvWhitePixel = h.texUvWhitePixel;
+    memcpy(atlas->TexUvLines, h.texUvLines, sizeof(h.texUvLines));
+    atlas->PackIdMouseCursors = h.packIdMouseCursors;
+    atlas->PackIdLines = h.packIdLines;
+
+    atlas->CustomRects.resize(h.rects);
+    for (int i = 0; i < h.rects; i++) {
+        const RectRecord& r = rects[size_t(i)];
+        ImFontAtlasCustomRect& rect = atlas->CustomRects[i];
+        rect.Width = r.width;
+        rect.Height = r.height;
+        rect.X = r.x;
+        rect.Y = r.y;
+        rect.GlyphID = r.glyphId;
+        rect.GlyphAdvanceX = r.glyphAdvanceX;
+        rect.GlyphOffset = r.glyphOffset;
+        rect.Font = r.font >= 0 ? atlas->Fonts[r.font] : NULL;
+    }
+
+    for (int i = 0; i < h.fonts; i++) {
+        const FontRecord& f = fonts[size_t(i)];
+        ImFont* font = atlas->Fonts[i];
+        font->ClearOutputData();
+        font->FontSize = f.fontSize;
+        font->Ascent = f.ascent;
+        font->Descent = f.descent;
+        font->MetricsTotalSurface = f.metricsTotalSurface;
+        font->EllipsisChar = (ImWchar)f.ellipsisChar;
+        font->ConfigData = &atlas->ConfigData[f.config];
+        font->ConfigDataCount = (short)f.configCount;
+        font->ContainerAtlas = atlas;
+        font->Glyphs.resize(f.glyphs);
+        memcpy(font->Glyphs.Data, p, size_t(f.glyphs) * sizeof(ImFontGlyph));
+        p += size_t(f.glyphs) * sizeof(ImFontGlyph);
+        font->BuildLookupTable();
+    }
+
+    // ClearTexData() frees the pixels with IM_FREE, so they can't stay in
+    // the mapping
+    atlas->TexPixelsRGBA32 = (unsigned int*)IM_ALLOC(pixels * 4);
+    memcpy(atlas->TexPixelsRGBA32, p, pixels * 4);
+    return true;
+}
+
+void save(const ImFontAtlas* atlas, const char* path, ImU32 key)
+{
+    Header h;
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.imguiVersion = IMGUI_VERSION_NUM;
+    h.key = key;
+    h.glyphSize = sizeof(ImFontGlyph);
+    h.texWidth = atlas->TexWidth;
+    h.texHeight = atlas->TexHeight;
+    h.fonts = atlas->Fonts.Size;
+    h.rects = atlas->CustomRects.Size;
+    h.packIdMouseCursors = atlas->PackIdMouseCursors;
+    h.packIdLines = atlas->PackIdLines;
+    h.texUvScale = atlas->TexUvScale;
+    h.texUvWhitePixel = atlas->TexUvWhitePixel;
+    memcpy(h.texUvLines, atlas->TexUvLines, sizeof(h.texUvLines));
+
+    std::vector<FontRecord> fonts;
+    for (const ImFont* font : atlas->Fonts) {
+        FontRecord f = {};
+        f.config = font->ConfigData ? int32_t(font->ConfigData - atlas->ConfigData.Data) : -1;
+        f.configCount = font->ConfigDataCount;
+        f.glyphs = font->Glyphs.Size;
+        f.metricsTotalSurface = font->MetricsTotalSurface;
+        f.fontSize = font->FontSize;
+        f.ascent = font->Ascent;
+        f.descent = font->Descent;
+        f.ellipsisChar = font->EllipsisChar;
+        fonts.push_back(f);
+    }
+    std::vector<RectRecord> rects;
+    for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+        RectRecord r = {};
+        r.width = rect.Width;
+        r.height = rect.Height;
+        r.x = rect.X;
+        r.y = rect.Y;
+        r.glyphId = rect.GlyphID;
+        r.glyphAdvanceX = rect.GlyphAdvanceX;
+        r.glyphOffset = rect.GlyphOffset;
+        r.font = fontIndex(atlas, rect.Font);
+        rects.push_back(r);
+    }
+
+    // written aside and renamed over, so concurrent instances never map a
+    // partial file
+    const std::string tmp = std::string(path) + "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(fonts.data()), std::streamsize(fonts.size() * sizeof(FontRecord)));
+        out.write(reinterpret_cast<const char*>(rects.data()), std::streamsize(rects.size() * sizeof(RectRecord)));
+        for (const ImFont* font : atlas->Fonts)
+            out.write(reinterpret_cast<const char*>(font->Glyphs.Data), std::streamsize(size_t(font->Glyphs.Size) * sizeof(ImFontGlyph)));
+        out.write(reinterpret_cast<const char*>(atlas->TexPixelsRGBA32), std::streamsize(size_t(atlas->TexWidth) * atlas->TexHeight * 4));
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tmp, path, error);
+    if (error)
+        std::remove(tmp.c_str());
+}
+
+} // namespace
+
+bool LoadOrBuildFontAtlas(ImFontAtlas* atlas, const char* path, FontAtlasPaint paint)
+{
+    // the font GetTexDataAsRGBA32() would add, before it goes into the key
+    if (atlas->ConfigData.empty())
+        atlas->AddFontDefault();
+
+    const ImU32 key = atlasKey(atlas);
+    if (load(atlas, path, key))
+        return true;
+
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    atlas->ClearTexData();
+    atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+    if (paint)
+        paint(atlas);
+    save(atlas, path, key);
+    return false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <imgui.h>
+
+// On-disk cache of a built font atlas, for instances that start often and
+// briefly. Building rasterizes every glyph with stb_truetype and packs the
+// atlas with stb_rect_pack on each launch; a cache hit instead maps the
+// file and restores the RGBA32 pixels, the glyph tables of every font and
+// the packed custom rects.
+//
+// The file is keyed by a hash of everything the build reads: the font data
+// and configs with their glyph ranges, the atlas flags and sizes and the
+// custom rects registered so far. Any change, or a file written by another
+// ImGui version, misses and is replaced by a fresh build.
+//
+// Only the RGBA32 texture is restored; GetTexDataAsAlpha8() on a loaded
+// atlas builds it again.
+
+// Called after a build with the atlas in RGBA32 to draw into its custom
+// rects; what it draws is cached with the glyphs.
+typedef void (*FontAtlasPaint)(ImFontAtlas* atlas);
+
+// Loads the atlas from `path` when the cache there matches, else builds it
+// as GetTexDataAsRGBA32() would, runs `paint` and writes the cache. Returns
+// true on a cache hit. Failing to write the cache isn't an error, the atlas
+// is built either way.
+bool LoadOrBuildFontAtlas(ImFontAtlas* atlas, const char* path, FontAtlasPaint paint = nullptr);
@@ -0,0 +1,124 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+struct FrameArena::Block
+{
+    explicit Block(size_t bytes, Block* next) : data(new char[bytes]), size(bytes), prev(next) {}
+    ~Block() { delete[] data; }
+
+    char* const data;
+    const size_t size;
+    std::atomic<size_t> used{ 0 };
+    Block* const prev;      // filled earlier in the frame
+};
+
+FrameArena::FrameArena(size_t blockSize)
+    : mBlockSize(blockSize)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (Block* b = mHead.load(); b != nullptr;) {
+        Block* prev = b->prev;
+        delete b;
+        b = prev;
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t align)
+{
+    IM_ASSERT(align != 0 && (align & (align - 1)) == 0);
+
+    Block* b = mHead.load(std::memory_order_acquire);
+    for (;;) {
+        if (b != nullptr) {
+            const uintptr_t base = reinterpret_cast<uintptr_t>(b->data);
+            size_t used = b->used.load(std::memory_order_relaxed);
+            for (;;) {
+                const size_t start = size_t(((base + used + align - 1) & ~uintptr_t(align - 1)) - base);
+                if (start + size > b->size)
+                    break;
+                if (b->used.compare_exchange_weak(used, start + size, std::memory_order_relaxed))
+                    return b->data + start;
+            }
+        }
+        b = grow(b, size, align);
+    }
+}
+
+FrameArena::Block* FrameArena::grow(Block* full, size_t size, size_t align)
+{
+    std::lock_guard<std::mutex> lock(mGrow);
+
+    // another thread may have chained a block meanwhile
+    Block* head = mHead.load(std::memory_order_acquire);
+    if (head != full)
+        return head;
+
+    const size_t bytes = std::max({ mBlockSize, size + align, full ? full->size * 2 : 0 });
+    Block* b = new Block(bytes, full);
+    mHeapAllocations++;
+    mHead.store(b, std::memory_order_release);
+    return b;
+}
+
+void FrameArena::reset()
+{
+    const size_t frame = used();
+    mLastFrame = frame;
+    mPeak = std::max(mPeak, frame);
+
+    Block* head = mHead.load(std::memory_order_relaxed);
+    if (head == nullptr)
+        return;
+
+    // a chain becomes one block that holds all of it
+    if (head->prev != nullptr) {
+        const size_t bytes = capacity();
+        for (Block* b = head; b != nullptr;) {
+            Block* prev = b->prev;
+            delete b;
+            b = prev;
+        }
+        head = new Block(bytes, nullptr);
+        mHeapAllocations++;
+        mHead.store(head, std::memory_order_relaxed);
+    }
+    head->used.store(0, std::memory_order_relaxed);
+}
+
+size_t FrameArena::used() const
+{
+    size_t bytes = 0;
+    for (const Block* b = mHead.load(std::memory_order_acquire); b != nullptr; b = b->prev)
+        bytes += b->used.load(std::memory_order_relaxed);
+    return bytes;
+}
+
+size_t FrameArena::capacity() const
+{
+    size_t bytes = 0;
+    for (const Block* b = mHead.load(std::memory_order_acquire); b != nullptr; b = b->prev)
+        bytes += b->size;
+    return bytes;
+}
+
+FrameArena& frameArena()
+{
+    static FrameArena arena;
+    return arena;
+}
+
+void InstallFrameArena(ImGuiContext* ctx, FrameArena& arena)
+{
+    ImGuiContextHook hook;
+    hook.Type = ImGuiContextHookType_NewFramePre;
+    hook.Callback = [](ImGuiContext*, ImGuiContextHook* h) { static_cast<FrameArena*>(h->UserData)->reset(); };
+    hook.UserData = &arena;
+    ImGui::AddContextHook(ctx, &hook);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <type_traits>
+
+struct ImGuiContext;
+
+// Bump allocator for scratch memory that lives until the next frame, such as
+// sampled curves and points scaled to the screen. Allocating is a pointer
+// bump, safe from several threads, and nothing is freed on its own: reset()
+// releases everything at once, and InstallFrameArena() has ImGui::NewFrame()
+// do so.
+//
+//     const std::span<float> t = frameArena().allocate<float>(n);
+//
+// A frame that outgrows the arena chains another block from the heap;
+// reset() then replaces the chain with a single block for the whole frame,
+// so a steady frame stops allocating from the heap after the first one.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t blockSize = size_t(1) << 20);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // size bytes aligned to align, a power of two; thread safe
+    void* allocate(size_t size, size_t align);
+
+    // uninitialized storage for count elements; thread safe
+    template <typename T>
+    std::span<T> allocate(size_t count, size_t align = alignof(T))
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "the arena never runs destructors");
+        return { static_cast<T*>(allocate(count * sizeof(T), align)), count };
+    }
+
+    // Invalidates every allocation and starts the next frame. Not thread
+    // safe, nothing may allocate meanwhile.
+    void reset();
+
+    // bytes handed out since the last reset(), alignment padding included
+    size_t used() const;
+    // bytes the blocks hold
+    size_t capacity() const;
+    // most used() by any frame so far, and by the last finished one
+    size_t peak() const { return mPeak; }
+    size_t lastFrame() const { return mLastFrame; }
+    // blocks taken from the heap since construction
+    size_t heapAllocations() const { return mHeapAllocations; }
+
+private:
+    struct Block;
+    Block* grow(Block* full, size_t size, size_t align);
+
+    std::atomic<Block*> mHead{ nullptr };   // the block allocations come from
+    std::mutex mGrow;
+    size_t mBlockSize;
+    size_t mPeak = 0;
+    size_t mLastFrame = 0;
+    size_t mHeapAllocations = 0;
+};
+
+// the app's arena for plot scratch
+FrameArena& frameArena();
+
+// Resets `arena` at the start of every ImGui::NewFrame() of `ctx`, before
+// anything of the new frame is drawn
+void InstallFrameArena(ImGuiContext* ctx, FrameArena& arena = frameArena());
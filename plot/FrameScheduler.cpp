@@ -0,0 +1,115 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <imgui_internal.h>
+#include "../profiler/Profiler.h"
+
+namespace {
+
+// ImGui shows the text cursor for 0.8 s of every 1.2 s
+const double CURSOR_BLINK = 0.4;
+
+bool equal(ImVec2 a, ImVec2 b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+} // namespace
+
+FrameScheduler::Input FrameScheduler::capture(const ImGuiIO& io)
+{
+    Input in;
+    in.displaySize = io.DisplaySize;
+    in.mousePos = io.MousePos;
+    in.mouseWheel = io.MouseWheel;
+    in.mouseWheelH = io.MouseWheelH;
+    memcpy(in.mouseDown, io.MouseDown, sizeof(in.mouseDown));
+    memcpy(in.keysDown, io.KeysDown, sizeof(in.keysDown));
+    in.keyMods[0] = io.KeyCtrl;
+    in.keyMods[1] = io.KeyShift;
+    in.keyMods[2] = io.KeyAlt;
+    in.keyMods[3] = io.KeySuper;
+    in.characters = io.InputQueueCharacters.Size;
+    memcpy(in.navInputs, io.NavInputs, sizeof(in.navInputs));
+    return in;
+}
+
+bool FrameScheduler::inputChanged(const ImGuiIO& io) const
+{
+    if (!mHaveInput)
+        return true;
+    const Input in = capture(io);
+    return !equal(in.displaySize, mInput.displaySize) || !equal(in.mousePos, mInput.mousePos)
+        || in.mouseWheel != mInput.mouseWheel || in.mouseWheelH != mInput.mouseWheelH
+        || memcmp(in.mouseDown, mInput.mouseDown, sizeof(in.mouseDown)) != 0
+        || memcmp(in.keysDown, mInput.keysDown, sizeof(in.keysDown)) != 0
+        || memcmp(in.keyMods, mInput.keyMods, sizeof(in.keyMods)) != 0
+        || in.characters != mInput.characters
+        || memcmp(in.navInputs, mInput.navInputs, sizeof(in.navInputs)) != 0;
+}
+
+void FrameScheduler::requestFrame(double seconds)
+{
+    const uint64_t at = profiler::now() + uint64_t(std::max(seconds, 0.0) * 1e9);
+    mDeadline = std::min(mDeadline, at);
+}
+
+bool FrameScheduler::frameDue(const ImGuiIO& io)
+{
+    const bool due = !mEnabled || mWake || mSettle > 0 || profiler::now() >= mDeadline || inputChanged(io);
+    if (!due)
+        mFramesSkipped++;
+    return due;
+}
+
+void FrameScheduler::beginFrame(ImGuiIO& io)
+{
+    const uint64_t now = profiler::now();
+    if (mWake || inputChanged(io))
+        mSettle = SETTLE_FRAMES;
+    else if (mSettle > 0)
+        mSettle--;
+    mWake = false;
+    if (now >= mDeadline)
+        mDeadline = UINT64_MAX;
+
+    // the backend measured from its last poll, which may not have drawn
+    if (mLastFrame != 0)
+        io.DeltaTime = std::max(float(double(now - mLastFrame) * 1e-9), 1e-6f);
+    mLastFrame = now;
+    mFramesDrawn++;
+}
+
+void FrameScheduler::endFrame(const ImGuiIO& io)
+{
+    // wheel and characters as EndFrame() cleared them
+    mInput = capture(io);
+    mHaveInput = true;
+
+    // an item held with the mouse repeats, scrolls or counts its hold time
+    // without further input
+    const ImGuiContext& g = *GImGui;
+    if (g.ActiveId != 0 && ImGui::IsAnyMouseDown())
+        requestFrame();
+    if (io.WantTextInput && io.ConfigInputTextCursorBlink)
+        requestFrame(CURSOR_BLINK);
+    if (g.SettingsDirtyTimer > 0.f && io.IniFilename != NULL)
+        requestFrame(g.SettingsDirtyTimer);
+}
+
+uint64_t FrameScheduler::timeout() const
+{
+    if (!mEnabled || mWake || mSettle > 0)
+        return 0;
+    if (mDeadline == UINT64_MAX)
+        return UINT64_MAX;
+    const uint64_t now = profiler::now();
+    return mDeadline > now ? mDeadline - now : 0;
+}
+
+FrameScheduler& frameScheduler()
+{
+    static FrameScheduler scheduler;
+    return scheduler;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <imgui.h>
+
+// Idle mode for the main loop: frames are only drawn when something could
+// have changed, so an instance showing static plots sleeps until an input
+// event or an animation needs it.
+//
+//     for (;;) {
+//         ... handle messages, then have the platform backend fill io ...
+//         if (!frameScheduler().frameDue(io)) {
+//             ... wait for a message or frameScheduler().timeout() ...
+//             continue;
+//         }
+//         frameScheduler().beginFrame(io);
+//         ImGui::NewFrame();
+//         ...
+//         ImGui::Render();
+//         frameScheduler().endFrame(io);
+//         ... present ...
+//     }
+//
+// A frame is due when the input ImGui would see differs from what the last
+// frame saw (mouse, keys, characters, wheel, display size), for a few frames
+// after such a change since ImGui reacts to some of it a frame late, while
+// an item is held with the mouse, when wake() was called or a frame asked
+// for with requestFrame() comes due. Text input blinks its cursor and
+// unsaved window settings are written through requested frames as well.
+//
+// Main thread only, like the ImGui context it watches.
+class FrameScheduler
+{
+public:
+    // frames drawn after the input changed
+    enum { SETTLE_FRAMES = 2 };
+
+    // draw the next frame whatever the input, e.g. after the window was
+    // resized or uncovered
+    void wake() { mWake = true; }
+
+    // Draw a frame within `seconds`. Animations call it every frame they
+    // run, a plot polling for data once per period.
+    void requestFrame(double seconds = 0.0);
+
+    // whether the next frame has to be drawn, with io as the backend filled it
+    bool frameDue(const ImGuiIO& io);
+
+    // before ImGui::NewFrame(): sets io.DeltaTime to the time since the last
+    // drawn frame, skipped polls included
+    void beginFrame(ImGuiIO& io);
+    // after ImGui::Render(): takes the input the frame consumed and asks for
+    // the frames ImGui's state still needs
+    void endFrame(const ImGuiIO& io);
+
+    // nanoseconds the loop may wait for input before a frame comes due,
+    // UINT64_MAX when only input can wake it
+    uint64_t timeout() const;
+
+    // false draws every frame, for profiling and benchmarks
+    void setEnabled(bool enabled) { mEnabled = enabled; }
+    bool enabled() const { return mEnabled; }
+
+    uint64_t framesDrawn() const { return mFramesDrawn; }
+    // frameDue() calls that returned false
+    uint64_t framesSkipped() const { return mFramesSkipped; }
+
+private:
+    // what of ImGuiIO a frame reads as input
+    struct Input
+    {
+        ImVec2 displaySize;
+        ImVec2 mousePos;
+        float mouseWheel;
+        float mouseWheelH;
+        bool mouseDown[5];
+        bool keysDown[512];
+        bool keyMods[4];
+        int characters;
+        float navInputs[ImGuiNavInput_COUNT];
+    };
+    static Input capture(const ImGuiIO& io);
+    bool inputChanged(const ImGuiIO& io) const;
+
+    Input mInput;                   // as the last drawn frame left it
+    bool mHaveInput = false;
+    bool mWake = false;
+    int mSettle = 0;                // frames still to draw after a change
+    uint64_t mDeadline = UINT64_MAX;    // profiler::now() of the next requested frame
+    uint64_t mLastFrame = 0;
+    bool mEnabled = true;
+    uint64_t mFramesDrawn = 0;
+    uint64_t mFramesSkipped = 0;
+};
+
+// the app's scheduler, which animated plots ask for frames
+FrameScheduler& frameScheduler();
@@ -0,0 +1,462 @@
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "ImGuiGrid.h"
+#include "FrameArena.h"
+#include "Markers.h"
+#include "WorkerPool.h"
+#include "../profiler/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// drawPolyline() strides over the components
+static_assert(sizeof(vec2) == 2 * sizeof(float) && sizeof(vec3) == 3 * sizeof(float));
+
+bool ImGuiGrid::drawGrid()
+{
+    if (!layoutGrid())
+        return false;
+    drawBackground();
+    return true;
+}
+
+bool ImGuiGrid::layoutGrid()
+{
+    using namespace ImGui;
+
+    // prepare canvas
+    const float avail = GetContentRegionAvailWidth();
+    const float dim = AREA_WIDTH > 0 ? float(AREA_WIDTH) : avail;
+
+    ImVec2 Canvas(dim, dim);
+
+    ImGuiWindow* Window = GetCurrentWindow();
+    if (Window->SkipItems)
+        return false;
+
+    ImRect bb = ImRect(Window->DC.CursorPos, Window->DC.CursorPos + Canvas);
+    ItemSize(bb);
+    if (!ItemAdd(bb, 0))
+        return false;
+
+    mbb = bb;
+    mCanvas = Canvas;
+
+    return true;
+}
+
+void ImGuiGrid::drawBackground()
+{
+    using namespace ImGui;
+
+    const ImGuiStyle& Style = GetStyle();
+    ImDrawList* DrawList = GetWindowDrawList();
+    const ImRect bb = mbb;
+    const ImVec2 Canvas = mCanvas;
+
+    RenderFrame(bb.Min, bb.Max, GetColorU32(ImGuiCol_FrameBg, 1), true, Style.FrameRounding);
+
+    // background grid
+    for (int i = 0; i <= Canvas.x; i += (Canvas.x / 8)) {
+        DrawList->AddLine(
+            ImVec2(bb.Min.x + i, bb.Min.y),
+            ImVec2(bb.Min.x + i, bb.Max.y),
+            GetColorU32(ImGuiCol_TextDisabled));
+    }
+    for (int i = 0; i <= Canvas.y; i += (Canvas.y / 8)) {
+        DrawList->AddLine(
+            ImVec2(bb.Min.x, bb.Min.y + i),
+            ImVec2(bb.Max.x, bb.Min.y + i),
+            GetColorU32(ImGuiCol_TextDisabled));
+    }
+}
+
+ImU32 ImGuiGrid::cacheKey(ImU32 seed) const
+{
+    using namespace ImGui;
+
+    const ImDrawList* DrawList = GetWindowDrawList();
+    const ImGuiStyle& Style = GetStyle();
+    auto hash = [&seed](const auto& value) { seed = ImHashData(&value, sizeof(value), seed); };
+
+    // placement
+    hash(mgmin);
+    hash(mgmax);
+    hash(mbb);
+    // tessellation settings and the colors the grid takes from the style
+    hash(DrawList->Flags);
+    hash(DrawList->_Data->TexUvWhitePixel);
+    hash(DrawList->_Data->CurveTessellationTol);
+    hash(DrawList->_Data->CircleSegmentMaxError);
+    hash(Style.FrameRounding);
+    hash(GetColorU32(ImGuiCol_FrameBg, 1));
+    hash(GetColorU32(ImGuiCol_TextDisabled));
+    hash(GetColorU32(ImGuiCol_Text));
+    return seed;
+}
+
+bool ImGuiGrid::drawLine(vec2 a, vec2 b, vec4 c)
+{
+    using namespace ImGui;
+
+    ImDrawList* DrawList = drawList();
+
+    float luma = IsItemActive() || IsItemHovered() ? 0.5f : 1.0f;
+
+    ImVec2 p1 = scalePosition(a);
+    ImVec2 p2 = scalePosition(b);
+    ImColor color(c.r, c.g, c.b, c.a);
+
+    DrawList->AddLine(p1, p2, color, LINE_WIDTH);
+
+    return true;
+}
+
+bool ImGuiGrid::drawPoint(vec2 p, vec4 c)
+{
+    using namespace ImGui;
+
+    ImVec4 white(GetStyle().Colors[ImGuiCol_Text]);
+
+    ImVec2 pos = scalePosition(p);
+    ImColor color(c.r, c.g, c.b, c.a);
+
+    addMarkers(&pos, 1, GRAB_RADIUS, ImColor(white));
+    addMarkers(&pos, 1, float(GRAB_RADIUS) - float(GRAB_BORDER), color);
+
+    return true;
+}
+
+bool ImGuiGrid::dragPoint(int id, vec3& p)
+{
+    using namespace ImGui;
+
+    ImGuiContext& g = *GImGui;
+    ImGuiWindow* Window = GetCurrentWindow();
+    const ImGuiID Id = Window->GetID(id);
+    const ImVec2 pos = scalePosition(vec2(p));
+    const ImVec2 radius(GRAB_RADIUS, GRAB_RADIUS);
+    const ImRect bb(pos - radius, pos + radius);
+
+    // on top of the grid item, which takes no input
+    if (!ItemAdd(bb, Id))
+        return false;
+    bool hovered, held;
+    ButtonBehavior(bb, Id, &hovered, &held);
+    if (hovered || held)
+        SetMouseCursor(ImGuiMouseCursor_ResizeAll);
+    if (!held)
+        return false;
+
+    // the handle keeps the offset the mouse grabbed it at
+    ImVec2 center = g.IO.MousePos - g.ActiveIdClickOffset + radius;
+    if (AREA_CONSTRAINED)
+        center = ImClamp(center, mbb.Min, mbb.Max);
+    if (center.x == pos.x && center.y == pos.y)
+        return false;
+
+    const vec2 moved = unscalePosition(center);
+    p = vec3(moved.x, moved.y, p.z);
+    MarkItemEdited(Id);
+    return true;
+}
+
+bool ImGuiGrid::drawHandle(int id, vec3 p, vec4 c)
+{
+    using namespace ImGui;
+
+    const ImGuiContext& g = *GImGui;
+    const ImGuiID Id = GetCurrentWindow()->GetID(id);
+    float luma = g.ActiveId == Id || g.HoveredId == Id ? 0.5f : 1.0f;
+
+    return drawPoint(p, vec4(c.r * luma, c.g * luma, c.b * luma, c.a));
+}
+
+bool ImGuiGrid::drawLine(vec3 a, vec3 b, vec4 c)
+{
+    return drawLine(vec2(a), vec2(b), c);
+}
+
+bool ImGuiGrid::drawPoint(vec3 p, vec4 c)
+{
+    return drawPoint(vec2(p), c);
+}
+
+bool ImGuiGrid::drawSmallPoint(vec3 p, vec4 c)
+{
+    using namespace ImGui;
+
+    ImVec2 pos = scalePosition(p);
+    ImColor color(c.r, c.g, c.b, c.a);
+
+    addMarkers(&pos, 1, GRAB_SMALL_RADIUS, color);
+
+    return true;
+}
+
+template <size_t STRIDE>
+void ImGuiGrid::scalePositions(const float* x, const float* y, size_t n)
+{
+    // scalePosition() folded into one multiply add per coordinate
+    const ImVec2 size = mbb.Max - mbb.Min;
+    const float sx = size.x / (mgmax.x - mgmin.x);
+    const float sy = -size.y / (mgmax.y - mgmin.y);
+    const float ox = mbb.Min.x - mgmin.x * sx;
+    const float oy = mbb.Max.y - mgmin.y * sy;
+
+    mPoints = frameArena().allocate<ImVec2>(n);
+    ImVec2* out = mPoints.data();
+    for (size_t i = 0; i < n; ++i)
+        out[i] = ImVec2(x[i * STRIDE] * sx + ox, y[i * STRIDE] * sy + oy);
+}
+
+ImDrawList* ImGuiGrid::drawList() const
+{
+    return mTarget ? mTarget : ImGui::GetWindowDrawList();
+}
+
+bool ImGuiGrid::submitPolyline(vec4 c)
+{
+    if (mPoints.size() < 2)
+        return false;
+
+    ImDrawList* DrawList = drawList();
+    ImColor color(c.r, c.g, c.b, c.a);
+    DrawList->AddPolyline(mPoints.data(), int(mPoints.size()), color, false, LINE_WIDTH);
+
+    return true;
+}
+
+bool ImGuiGrid::drawPolyline(std::span<const vec2> points, vec4 c)
+{
+    if (points.empty())
+        return false;
+    scalePositions<2>(&points[0].x, &points[0].y, points.size());
+    return submitPolyline(c);
+}
+
+bool ImGuiGrid::drawPolyline(std::span<const vec3> points, vec4 c)
+{
+    if (points.empty())
+        return false;
+    scalePositions<3>(&points[0].x, &points[0].y, points.size());
+    return submitPolyline(c);
+}
+
+bool ImGuiGrid::drawPolyline(const gszauer::Vec3Stream& points, vec4 c)
+{
+    if (points.empty())
+        return false;
+    scalePositions<1>(points.x(), points.y(), points.size());
+    return submitPolyline(c);
+}
+
+void ImGuiGrid::addMarkers(const ImVec2* centers, int n, float radius, ImU32 color)
+{
+    ImDrawList* DrawList = drawList();
+
+    const MarkerSprite* sprite = FindMarkerSprite(radius);
+    if (!sprite) {
+        for (int i = 0; i < n; i++)
+            DrawList->AddCircleFilled(centers[i], radius, color);
+        return;
+    }
+
+    // One quad per marker. Reserving in chunks keeps every chunk within the
+    // 16 bit index range, PrimReserve() moves the vertex offset in between
+    // when the backend supports it.
+    enum { CHUNK = 8192 };
+    const ImVec2 half(sprite->size * 0.5f, sprite->size * 0.5f);
+    for (int begin = 0; begin < n; begin += CHUNK) {
+        const int end = std::min(n, begin + CHUNK);
+        DrawList->PrimReserve((end - begin) * 6, (end - begin) * 4);
+        for (int i = begin; i < end; i++)
+            DrawList->PrimRectUV(centers[i] - half, centers[i] + half, sprite->uv0, sprite->uv1, color);
+    }
+}
+
+bool ImGuiGrid::drawPoints(std::span<const vec2> points, vec4 c, float radius)
+{
+    if (points.empty())
+        return false;
+    scalePositions<2>(&points[0].x, &points[0].y, points.size());
+    addMarkers(mPoints.data(), int(mPoints.size()), radius, ImColor(c.r, c.g, c.b, c.a));
+    return true;
+}
+
+bool ImGuiGrid::drawPoints(std::span<const vec3> points, vec4 c, float radius)
+{
+    if (points.empty())
+        return false;
+    scalePositions<3>(&points[0].x, &points[0].y, points.size());
+    addMarkers(mPoints.data(), int(mPoints.size()), radius, ImColor(c.r, c.g, c.b, c.a));
+    return true;
+}
+
+bool ImGuiGrid::drawCurve(const gszauer::Bezier<vec3>& curve, int segments, vec4 c)
+{
+    if (segments < 1)
+        return false;
+
+    FrameArena& arena = frameArena();
+    const size_t n = size_t(segments) + 1;
+    const std::span<float> t = arena.allocate<float>(n);
+    for (int i = 0; i <= segments; i++)
+        t[size_t(i)] = (float)i / segments;
+
+    // samples come back as SoA, so the scaling reads both axes contiguously
+    float* x = arena.allocate<float>(n).data();
+    float* y = arena.allocate<float>(n).data();
+    gszauer::interpolate(curve, t, x, y, arena.allocate<float>(n).data());
+    scalePositions<1>(x, y, n);
+    return submitPolyline(c);
+}
+
+bool ImGuiGrid::drawCurves(std::span<const gszauer::Bezier<vec3>> curves, int segments, vec4 c,
+    ParallelSplitter& splitter, size_t threads)
+{
+    if (curves.empty() || segments < 1)
+        return false;
+
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    const size_t channels = std::min(threads, curves.size() / CURVE_GRAIN);
+    if (channels <= 1) {
+        for (const gszauer::Bezier<vec3>& curve : curves)
+            drawCurve(curve, segments, c);
+        return true;
+    }
+
+    // a contiguous run of curves per channel, so the merge keeps their order
+    ImDrawList* DrawList = ImGui::GetWindowDrawList();
+    splitter.split(DrawList, int(channels));
+    auto firstCurve = [&](size_t i) { return curves.size() * i / channels; };
+    // ImGui's current window isn't for workers, they get the placement and
+    // their channel
+    auto channelGrid = [&](size_t i) {
+        ImGuiGrid grid;
+        grid.mgmin = mgmin;
+        grid.mgmax = mgmax;
+        grid.mbb = mbb;
+        grid.mCanvas = mCanvas;
+        grid.mTarget = splitter.channel(int(i));
+        return grid;
+    };
+
+    // Every curve takes as many vertices and indices as the first, drawn
+    // here to measure them, so the channels can be reserved for their share
+    // before the workers start.
+    channelGrid(0).drawCurve(curves[0], segments, c);
+    const ImDrawList* first = splitter.channel(0);
+    const int share = int((curves.size() + channels - 1) / channels);   // curves of the largest channel
+    splitter.reserve(share * first->VtxBuffer.Size, share * first->IdxBuffer.Size);
+
+    workerPool().run(channels, [&](size_t i) {
+        PROFILE_SCOPE("curve channel");
+        ImGuiGrid worker = channelGrid(i);
+        for (size_t k = std::max<size_t>(firstCurve(i), 1); k < firstCurve(i + 1); ++k)
+            worker.drawCurve(curves[k], segments, c);
+    });
+    splitter.merge(DrawList);
+
+    return true;
+}
+
+bool ImGuiGrid::drawSeries(const SeriesPyramid& series, vec4 c)
+{
+    const size_t first = series.lowerBound(mgmin.x);
+    const size_t last = series.lowerBound(std::nextafter(mgmax.x, INFINITY));
+    if (last - first < 2)
+        return false;
+
+    const int columns = std::max(1, int(mbb.GetWidth()));
+    const float* x = series.x();
+    const float* y = series.y();
+
+    if (last - first <= size_t(columns) * 2) {
+        scalePositions<1>(x + first, y + first, last - first);
+        return submitPolyline(c);
+    }
+
+    // The min and max per column, filled as a band with a low and a high
+    // vertex on every column edge. An edge spans both columns it separates,
+    // so each column is covered from its min to its max, a single sample
+    // spike included. A polyline zigzagging between min and max instead
+    // would fold back on itself at every column, which anti aliased joins
+    // render as broken hairpins.
+    const float step = (mgmax.x - mgmin.x) / float(columns);
+    // a column adds at most its own edge and the one closing a run before it
+    const std::span<vec2> band = frameArena().allocate<vec2>(4 * size_t(columns) + 2);
+    size_t vertices = 0;
+    auto edge = [&](float ex, float lo, float hi) {
+        band[vertices++] = vec2(ex, lo);
+        band[vertices++] = vec2(ex, hi);
+    };
+    int prev = -1;
+    SeriesPyramid::Range pr = {};
+    size_t begin = first;
+    for (int col = 0; col < columns && begin < last; ++col) {
+        const float right = col + 1 == columns ? std::nextafter(mgmax.x, INFINITY) : mgmin.x + step * float(col + 1);
+        const size_t end = size_t(std::lower_bound(x + begin, x + last, right) - x);
+        if (end == begin)
+            continue;
+
+        // empty columns in between are bridged by the band
+        const SeriesPyramid::Range r = series.range(begin, end);
+        const float left = mgmin.x + step * float(col);
+        if (prev == col - 1) {
+            edge(left, std::min(r.min, pr.min), std::max(r.max, pr.max));
+        } else {
+            if (prev >= 0)
+                edge(mgmin.x + step * float(prev + 1), pr.min, pr.max);
+            edge(left, r.min, r.max);
+        }
+        prev = col;
+        pr = r;
+        begin = end;
+    }
+    if (prev < 0)
+        return false;
+    edge(mgmin.x + step * float(prev + 1), pr.min, pr.max);
+
+    // at least a pixel high, so quiet stretches still read as a line
+    scalePositions<2>(&band[0].x, &band[0].y, vertices);
+    ImVec2* p = mPoints.data();
+    const int count = int(mPoints.size());
+    for (int i = 0; i < count; i += 2) {
+        const float grow = std::max(0.f, 1.f - (p[i].y - p[i + 1].y)) * 0.5f;
+        p[i].y += grow;
+        p[i + 1].y -= grow;
+    }
+
+    ImDrawList* DrawList = drawList();
+    const ImU32 color = ImColor(c.r, c.g, c.b, c.a);
+    const ImVec2 uv = DrawList->_Data->TexUvWhitePixel;
+    DrawList->PrimReserve((count / 2 - 1) * 6, count);
+    const ImDrawIdx base = (ImDrawIdx)DrawList->_VtxCurrentIdx;
+    for (int i = 0; i < count; i++)
+        DrawList->PrimWriteVtx(p[i], uv, color);
+    for (int i = 0; i + 2 < count; i += 2) {
+        const ImDrawIdx k = (ImDrawIdx)(base + i);
+        DrawList->PrimWriteIdx(k);
+        DrawList->PrimWriteIdx((ImDrawIdx)(k + 1));
+        DrawList->PrimWriteIdx((ImDrawIdx)(k + 3));
+        DrawList->PrimWriteIdx(k);
+        DrawList->PrimWriteIdx((ImDrawIdx)(k + 3));
+        DrawList->PrimWriteIdx((ImDrawIdx)(k + 2));
+    }
+
+    return true;
+}
+
+ImVec2 ImGuiGrid::scalePosition(vec2 p)
+{
+    vec2 npos = (p - mgmin) / (mgmax - mgmin);
+    return ImVec2(npos.x, 1 - npos.y) * (mbb.Max - mbb.Min) + mbb.Min;
+}
+
+vec2 ImGuiGrid::unscalePosition(ImVec2 pos)
+{
+    ImVec2 npos = (pos - mbb.Min) / (mbb.Max - mbb.Min);
+    return mgmin + vec2(npos.x, 1 - npos.y) * (mgmax - mgmin);
+}
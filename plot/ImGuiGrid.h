@@ -0,0 +1,107 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "../gszauer/Vec2.h"
+#include "../gszauer/Vec3.h"
+#include "../gszauer/Vec4.h"
+#include "../gszauer/VecStream.h"
+#include "ParallelSplitter.h"
+#include "SeriesPyramid.h"
+
+// Square plot area with a background grid. drawGrid() lays out the area in
+// the current window, the other calls draw in plot coordinates [mgmin, mgmax].
+struct ImGuiGrid
+{
+    enum { LINE_WIDTH = 1 }; // handlers: small lines width
+    enum { GRAB_RADIUS = 8 }; // handlers: circle radius
+    enum { GRAB_BORDER = 2 }; // handlers: circle border width
+    enum { GRAB_SMALL_RADIUS = 3 };
+    enum { AREA_CONSTRAINED = true }; // should grabbers be constrained to grid area?
+    enum { AREA_WIDTH = 256 }; // area width in pixels. 0 for adaptive size (will use max avail width)
+    enum { CURVE_GRAIN = 32 }; // drawCurves(): fewest curves worth a thread
+
+    // layoutGrid() followed by drawBackground()
+    bool drawGrid();
+    // reserves the area in the window, false if it is clipped
+    bool layoutGrid();
+    // frame and grid lines of the laid out area
+    void drawBackground();
+
+    // Hash of what the geometry drawn by this grid depends on besides the
+    // caller's data: placement, draw list settings and style colors. Seed
+    // it with the data to key a PlotCache.
+    ImU32 cacheKey(ImU32 seed = 0) const;
+
+    bool drawLine(vec2 a, vec2 b, vec4 c);
+    bool drawLine(vec3 a, vec3 b, vec4 c);
+    bool drawPoint(vec2 p, vec4 c);
+    bool drawPoint(vec3 p, vec4 c);
+    bool drawSmallPoint(vec3 p, vec4 c);
+
+    // One AddPolyline for the whole span, scaled to screen space in a single
+    // pass. Joints share their vertices, unlike a chain of drawLine calls.
+    bool drawPolyline(std::span<const vec2> points, vec4 c);
+    bool drawPolyline(std::span<const vec3> points, vec4 c);
+    bool drawPolyline(const gszauer::Vec3Stream& points, vec4 c);
+
+    // Filled discs at the points, a quad each textured with a sprite from
+    // AddMarkerSprites() when the atlas has one for the radius, else
+    // AddCircleFilled. drawPoint() and drawSmallPoint() go the same way.
+    bool drawPoints(std::span<const vec2> points, vec4 c, float radius = GRAB_SMALL_RADIUS);
+    bool drawPoints(std::span<const vec3> points, vec4 c, float radius = GRAB_SMALL_RADIUS);
+
+    // the curve as a polyline through segments + 1 evenly spaced samples
+    bool drawCurve(const gszauer::Bezier<vec3>& curve, int segments, vec4 c);
+
+    // drawCurve() for every curve, tessellated on up to `threads` threads (0
+    // for one per core), the caller's and those of workerPool(), into the
+    // channels of `splitter`, which are merged
+    // into the window draw list in curve order. Less than CURVE_GRAIN curves
+    // per thread aren't worth one, so small sets stay on the caller's thread.
+    bool drawCurves(std::span<const gszauer::Bezier<vec3>> curves, int segments, vec4 c,
+        ParallelSplitter& splitter, size_t threads = 0);
+
+    // The samples between mgmin.x and mgmax.x reduced to two vertices per
+    // pixel column, the min and max of the samples in it, and filled as an
+    // envelope; the cost follows the plot width rather than the series
+    // length. When zoomed in to fewer samples than that they are drawn as
+    // they are, as a polyline.
+    bool drawSeries(const SeriesPyramid& series, vec4 c);
+
+    // Handle of GRAB_RADIUS at p that the mouse drags, kept within the area
+    // if AREA_CONSTRAINED; true when it moved p. Only takes the input, so
+    // what the point shapes can be drawn from where it ends up this frame,
+    // drawHandle() then draws it on top. `id` is unique among the handles
+    // of the window.
+    bool dragPoint(int id, vec3& p);
+    // drawPoint() of the dragPoint() handle, dimmed while hovered or dragged
+    bool drawHandle(int id, vec3 p, vec4 c);
+
+    ImVec2 scalePosition(vec2 p);
+    // plot coordinates of a screen position
+    vec2 unscalePosition(ImVec2 pos);
+
+    vec2 mgmin = vec2(0.f);
+    vec2 mgmax = vec2(1.f);
+
+    ImVec2 mCanvas;
+    ImRect mbb;
+
+private:
+    // scalePosition() of n points, x and y STRIDE floats apart, into mPoints
+    template <size_t STRIDE>
+    void scalePositions(const float* x, const float* y, size_t n);
+    bool submitPolyline(vec4 c);
+    void addMarkers(const ImVec2* centers, int n, float radius, ImU32 color);
+
+    // the window draw list unless drawing into a drawCurves() channel
+    ImDrawList* drawList() const;
+    ImDrawList* mTarget = nullptr;
+
+    // points of the last scalePositions(), from the frame arena
+    std::span<ImVec2> mPoints;
+};
@@ -0,0 +1,85 @@
+#include "Markers.h"
+#include "FontAtlasCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct MarkerSprites
+{
+    const ImFontAtlas* atlas = nullptr;
+    const unsigned int* pixels = nullptr;   // the painted RGBA32 data
+    int rects[MARKER_MAX_RADIUS + 1] = {};
+    MarkerSprite sprites[MARKER_MAX_RADIUS + 1] = {};
+};
+
+MarkerSprites gMarkers;
+
+int spriteSize(int radius)
+{
+    // a pixel of margin for the anti aliased edge
+    return 2 * radius + 2;
+}
+
+// coverage of a disc of radius r, falling off over one pixel
+void paintSprites(ImFontAtlas* atlas)
+{
+    unsigned int* pixels = atlas->TexPixelsRGBA32;
+    const int width = atlas->TexWidth;
+    for (int r = 1; r <= MARKER_MAX_RADIUS; r++) {
+        const ImFontAtlasCustomRect* rect = atlas->GetCustomRectByIndex(gMarkers.rects[r]);
+        const int size = spriteSize(r);
+        const float center = float(size) * 0.5f;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const float d = std::hypot(float(x) + 0.5f - center, float(y) + 0.5f - center);
+                const float alpha = std::clamp(float(r) + 0.5f - d, 0.f, 1.f);
+                pixels[(rect->Y + y) * width + rect->X + x] = IM_COL32(255, 255, 255, (int)(alpha * 255.f + 0.5f));
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool AddMarkerSprites(ImFontAtlas* atlas, const char* cachePath)
+{
+    for (int r = 1; r <= MARKER_MAX_RADIUS; r++)
+        gMarkers.rects[r] = atlas->AddCustomRectRegular(spriteSize(r), spriteSize(r));
+
+    // rebuilt with the rects packed in, the default font if none was added
+    bool cached = false;
+    if (cachePath) {
+        cached = LoadOrBuildFontAtlas(atlas, cachePath, paintSprites);
+    } else {
+        unsigned char* data = nullptr;
+        int width = 0, height = 0;
+        atlas->ClearTexData();
+        atlas->GetTexDataAsRGBA32(&data, &width, &height);
+        paintSprites(atlas);
+    }
+
+    for (int r = 1; r <= MARKER_MAX_RADIUS; r++) {
+        MarkerSprite& sprite = gMarkers.sprites[r];
+        atlas->CalcCustomRectUV(atlas->GetCustomRectByIndex(gMarkers.rects[r]), &sprite.uv0, &sprite.uv1);
+        sprite.size = float(spriteSize(r));
+    }
+    gMarkers.atlas = atlas;
+    gMarkers.pixels = atlas->TexPixelsRGBA32;
+    return cached;
+}
+
+const MarkerSprite* FindMarkerSprite(float radius)
+{
+    // the atlas of another context, or one rebuilt since the sprites were
+    // painted, doesn't have them
+    const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    if (atlas != gMarkers.atlas || atlas->TexPixelsRGBA32 != gMarkers.pixels || gMarkers.pixels == nullptr)
+        return nullptr;
+
+    const int r = (int)std::lround(radius);
+    if (r < 1 || r > MARKER_MAX_RADIUS)
+        return nullptr;
+    return &gMarkers.sprites[r];
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <imgui.h>
+
+// Anti aliased discs baked into the font atlas as custom rects, so a plot
+// marker is one textured quad in the font texture's draw command instead of
+// a tessellated circle. ImGuiGrid falls back to AddCircleFilled when the
+// atlas has no sprites.
+
+// largest baked radius, discs come in whole pixel radii from 1
+static constexpr int MARKER_MAX_RADIUS = 16;
+
+struct MarkerSprite
+{
+    ImVec2 uv0, uv1;
+    float size;     // side of the quad in pixels, the disc centered in it
+};
+
+// Registers the discs, builds the atlas and paints them into its RGBA32
+// data. Call once after adding fonts and before the renderer uploads the
+// texture, i.e. before the backend's first NewFrame or
+// headless::createFontsTexture(). Rebuilding the atlas later drops them.
+// With a cachePath the built atlas, sprites included, goes through
+// LoadOrBuildFontAtlas(); returns true when it came from the cache.
+bool AddMarkerSprites(ImFontAtlas* atlas, const char* cachePath = nullptr);
+
+// Sprite for the radius rounded to whole pixels, nullptr if the current
+// context's atlas has none for it.
+const MarkerSprite* FindMarkerSprite(float radius);
@@ -0,0 +1,128 @@
+#include "ParallelSplitter.h"
+
+#include <cstring>
+
+namespace {
+
+bool sameHeader(const ImDrawCmd& a, const ImVec4& clipRect, ImTextureID texture, unsigned int vtxOffset)
+{
+    return a.UserCallback == NULL && a.TextureId == texture && a.VtxOffset == vtxOffset
+        && memcmp(&a.ClipRect, &clipRect, sizeof(ImVec4)) == 0;
+}
+
+// adds `count` indices at the end of the index buffer to the last command
+// if it draws with the same settings, else to a new one
+void appendCmd(ImDrawList* drawList, const ImDrawCmd& src, unsigned int vtxOffset, unsigned int count)
+{
+    const unsigned int idxOffset = (unsigned int)drawList->IdxBuffer.Size - count;
+    ImDrawCmd& last = drawList->CmdBuffer.back();
+    if (last.ElemCount == 0 && last.UserCallback == NULL) {
+        last.ClipRect = src.ClipRect;
+        last.TextureId = src.TextureId;
+        last.VtxOffset = vtxOffset;
+        last.IdxOffset = idxOffset;
+        last.ElemCount = count;
+    } else if (sameHeader(last, src.ClipRect, src.TextureId, vtxOffset) && last.IdxOffset + last.ElemCount == idxOffset) {
+        last.ElemCount += count;
+    } else {
+        ImDrawCmd cmd;
+        cmd.ClipRect = src.ClipRect;
+        cmd.TextureId = src.TextureId;
+        cmd.VtxOffset = vtxOffset;
+        cmd.IdxOffset = idxOffset;
+        cmd.ElemCount = count;
+        drawList->CmdBuffer.push_back(cmd);
+    }
+}
+
+} // namespace
+
+void ParallelSplitter::split(ImDrawList* drawList, int count)
+{
+    IM_ASSERT(count > 0);
+    while (mChannels.size() < size_t(count))
+        mChannels.push_back(std::make_unique<ImDrawList>(drawList->_Data));
+    mCount = count;
+
+    const ImVec4& clip = drawList->_CmdHeader.ClipRect;
+    for (int i = 0; i < count; i++) {
+        ImDrawList* ch = channel(i);
+        ch->_Data = drawList->_Data;
+        ch->_ResetForNewFrame();
+        ch->Flags = drawList->Flags;
+        ch->PushClipRect(ImVec2(clip.x, clip.y), ImVec2(clip.z, clip.w));
+        ch->PushTextureID(drawList->_CmdHeader.TextureId);
+    }
+}
+
+void ParallelSplitter::reserve(int vertices, int indices)
+{
+    for (int i = 0; i < mCount; i++) {
+        ImDrawList* ch = channel(i);
+        ch->VtxBuffer.reserve(vertices);
+        ch->IdxBuffer.reserve(indices);
+        // PrimReserve() opens a command when a vertex offset runs out of 16
+        // bit indices, after at least 32K vertices for primitives up to that
+        ch->CmdBuffer.reserve(ch->CmdBuffer.Size + 2 + vertices / 0x8000);
+    }
+}
+
+void ParallelSplitter::merge(ImDrawList* drawList)
+{
+    // there's always a trailing command outside of the splitters
+    IM_ASSERT(drawList->CmdBuffer.Size > 0);
+    const unsigned int base = drawList->_CmdHeader.VtxOffset;
+    const bool vtxOffset = (drawList->Flags & ImDrawListFlags_AllowVtxOffset) != 0;
+
+    for (int i = 0; i < mCount; i++) {
+        ImDrawList* ch = channel(i);
+        ch->_PopUnusedDrawCmd();
+        if (ch->CmdBuffer.Size == 0 || ch->VtxBuffer.Size == 0)
+            continue;
+
+        const unsigned int vtxStart = (unsigned int)drawList->VtxBuffer.Size;
+        drawList->VtxBuffer.resize(drawList->VtxBuffer.Size + ch->VtxBuffer.Size);
+        memcpy(drawList->VtxBuffer.Data + vtxStart, ch->VtxBuffer.Data, size_t(ch->VtxBuffer.Size) * sizeof(ImDrawVert));
+
+        // Rebasing onto the current vertex offset keeps small channels in
+        // the current command. A channel past the 16 bit index range moves
+        // under its own offset instead, its indices copied unchanged.
+        const bool rebase = sizeof(ImDrawIdx) == 4 || !vtxOffset
+            || vtxStart - base + (unsigned int)ch->VtxBuffer.Size <= 0x10000;
+        IM_ASSERT((sizeof(ImDrawIdx) == 4 || vtxOffset || vtxStart + ch->VtxBuffer.Size <= 0x10000)
+            && "Too many vertices in ImDrawList using 16-bit indices, see ImGuiBackendFlags_RendererHasVtxOffset");
+
+        for (const ImDrawCmd& cmd : ch->CmdBuffer) {
+            IM_ASSERT(cmd.UserCallback == NULL && "ParallelSplitter channels can't take callbacks");
+            const int idxStart = drawList->IdxBuffer.Size;
+            drawList->IdxBuffer.resize(idxStart + int(cmd.ElemCount));
+            const ImDrawIdx* src = ch->IdxBuffer.Data + cmd.IdxOffset;
+            ImDrawIdx* dst = drawList->IdxBuffer.Data + idxStart;
+            if (rebase) {
+                const unsigned int shift = vtxStart + cmd.VtxOffset - base;
+                for (unsigned int k = 0; k < cmd.ElemCount; k++)
+                    dst[k] = (ImDrawIdx)(src[k] + shift);
+                appendCmd(drawList, cmd, base, cmd.ElemCount);
+            } else {
+                memcpy(dst, src, size_t(cmd.ElemCount) * sizeof(ImDrawIdx));
+                appendCmd(drawList, cmd, vtxStart + cmd.VtxOffset, cmd.ElemCount);
+            }
+        }
+    }
+
+    // Continue on the list's own settings after the merged geometry.
+    // PrimReserve() opens a new vertex offset if the index range is used up.
+    drawList->_VtxCurrentIdx = (unsigned int)drawList->VtxBuffer.Size - base;
+    drawList->_VtxWritePtr = drawList->VtxBuffer.Data + drawList->VtxBuffer.Size;
+    drawList->_IdxWritePtr = drawList->IdxBuffer.Data + drawList->IdxBuffer.Size;
+    const ImDrawCmd& last = drawList->CmdBuffer.back();
+    if (!sameHeader(last, drawList->_CmdHeader.ClipRect, drawList->_CmdHeader.TextureId, base))
+        drawList->AddDrawCmd();
+    mCount = 0;
+}
+
+void ParallelSplitter::clearFreeMemory()
+{
+    mChannels.clear();
+    mCount = 0;
+}
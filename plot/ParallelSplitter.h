@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <imgui.h>
+
+// ImDrawListSplitter for threads. ImGui's channels share the vertex buffer
+// of their draw list, so only one thread can fill them; here every channel
+// is an ImDrawList of its own with the clip rect, texture and flags of the
+// target, and channels can be filled concurrently, one thread per channel.
+// merge() appends them to the target in channel order.
+//
+//     static ParallelSplitter splitter;
+//     splitter.split(drawList, n);
+//     splitter.reserve(vertices, indices);
+//     workerPool().run(n, [&](size_t i) {
+//         ... draw to splitter.channel(int(i)) ...
+//     });
+//     splitter.merge(drawList);
+//
+// Threads must not allocate through ImGui, which counts allocations in its
+// context without a lock. The channels keep their buffers between frames,
+// so what the previous frame used is already there, and reserve() makes
+// room for what the caller expects beyond that. Keep the splitter alive
+// across frames, like a PlotCache.
+class ParallelSplitter
+{
+public:
+    // Resets `count` channels to the current state of `drawList`
+    void split(ImDrawList* drawList, int count);
+
+    // Grows every channel to hold `vertices` and `indices` in all, with the
+    // draw commands 16 bit indices split them into, so that threads filling
+    // the channels up to that don't allocate. On the thread that split().
+    void reserve(int vertices, int indices);
+
+    // Appends the channels to `drawList`, vertices copied and indices rebased
+    // onto its current vertex offset while they fit in ImDrawIdx, else moved
+    // as they are under a new vertex offset. Commands with equal settings
+    // are joined, so small channels end up in the current draw command.
+    void merge(ImDrawList* drawList);
+
+    // channel i < count() of the last split(), to be filled by one thread
+    ImDrawList* channel(int i) { return mChannels[size_t(i)].get(); }
+    int count() const { return mCount; }
+
+    // releases the channels' buffers
+    void clearFreeMemory();
+
+private:
+    std::vector<std::unique_ptr<ImDrawList>> mChannels;
+    int mCount = 0;
+};
@@ -0,0 +1,60 @@
+#include "PlotCache.h"
+
+#include <cstring>
+
+bool PlotCache::begin(ImDrawList* drawList, ImU32 key)
+{
+    IM_ASSERT(mDrawList == nullptr && "PlotCache::begin() without end()");
+
+    if (mValid && mKey == key) {
+        // PrimReserve may open a new command when 16 bit indices run out,
+        // so the base index is only known after it
+        drawList->PrimReserve(mIndices.Size, mVertices.Size);
+        const ImDrawIdx base = (ImDrawIdx)drawList->_VtxCurrentIdx;
+        memcpy(drawList->_VtxWritePtr, mVertices.Data, size_t(mVertices.Size) * sizeof(ImDrawVert));
+        for (int i = 0; i < mIndices.Size; i++)
+            drawList->_IdxWritePtr[i] = (ImDrawIdx)(base + mIndices[i]);
+        drawList->_VtxWritePtr += mVertices.Size;
+        drawList->_IdxWritePtr += mIndices.Size;
+        drawList->_VtxCurrentIdx += (unsigned int)mVertices.Size;
+        return false;
+    }
+
+    mKey = key;
+    mValid = false;
+    mDrawList = drawList;
+    mCmdCount = drawList->CmdBuffer.Size;
+    mVtxStart = drawList->VtxBuffer.Size;
+    mIdxStart = drawList->IdxBuffer.Size;
+    mVtxBase = drawList->_VtxCurrentIdx;
+    return true;
+}
+
+void PlotCache::end()
+{
+    IM_ASSERT(mDrawList != nullptr && "PlotCache::end() without begin()");
+    ImDrawList* drawList = mDrawList;
+    mDrawList = nullptr;
+
+    // a new command means a clip rect or texture change, which a replay
+    // into the current command couldn't reproduce
+    if (drawList->CmdBuffer.Size != mCmdCount)
+        return;
+
+    const int vtxCount = drawList->VtxBuffer.Size - mVtxStart;
+    const int idxCount = drawList->IdxBuffer.Size - mIdxStart;
+    mVertices.resize(vtxCount);
+    mIndices.resize(idxCount);
+    if (vtxCount > 0)
+        memcpy(mVertices.Data, drawList->VtxBuffer.Data + mVtxStart, size_t(vtxCount) * sizeof(ImDrawVert));
+    for (int i = 0; i < idxCount; i++)
+        mIndices[i] = (ImDrawIdx)(drawList->IdxBuffer[mIdxStart + i] - mVtxBase);
+    mValid = true;
+}
+
+void PlotCache::clear()
+{
+    mValid = false;
+    mVertices.clear();
+    mIndices.clear();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <imgui.h>
+
+// Retained geometry for a section of a draw list that only changes with its
+// inputs, such as a plot of fixed curves. The first frame records the
+// vertices and indices it emits, later frames with the same key copy them
+// back instead of tessellating again.
+//
+//     static PlotCache cache;
+//     if (cache.begin(drawList, key)) {
+//         ... draw ...
+//         cache.end();
+//     }
+//
+// The key has to cover everything the geometry depends on, screen position
+// included; ImGuiGrid::cacheKey() hashes the grid transform and style. A
+// section is only retained when it stays within one draw command, i.e. it
+// doesn't change clip rect or texture.
+class PlotCache
+{
+public:
+    // Replays the geometry recorded for `key` and returns false, or returns
+    // true and records everything drawn to `drawList` until end().
+    bool begin(ImDrawList* drawList, ImU32 key);
+    void end();
+
+    // forgets the recorded geometry, the next begin() records again
+    void clear();
+
+    bool valid() const { return mValid; }
+    int vertexCount() const { return mVertices.Size; }
+    int indexCount() const { return mIndices.Size; }
+
+private:
+    ImU32 mKey = 0;
+    bool mValid = false;
+
+    // recording state between begin() and end()
+    ImDrawList* mDrawList = nullptr;
+    int mCmdCount = 0;
+    int mVtxStart = 0;
+    int mIdxStart = 0;
+    unsigned int mVtxBase = 0;
+
+    ImVector<ImDrawVert> mVertices;
+    ImVector<ImDrawIdx> mIndices;     // relative to the first vertex
+};
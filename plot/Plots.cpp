@@ -0,0 +1,287 @@
+#include "Plots.h"
+#include <cmath>
+#include <random>
+#include "BezierSpline.h"
+#include "FrameScheduler.h"
+#include "ImGuiGrid.h"
+#include "ParallelSplitter.h"
+#include "PlotCache.h"
+#include "SeriesPyramid.h"
+#include "../profiler/Profiler.h"
+
+const vec4 white(1.f, 1.f, 1.f, 1.f);
+const vec4 pink(1.00f, 0.00f, 0.75f, 1.0f);
+const vec4 cyan(0.00f, 0.75f, 1.00f, 1.0f);
+
+namespace {
+
+// segments spanning -5 to 5, with their controls arching up and down in
+// turn; a single one is the curve the plot started out with
+std::vector<vec3> splinePoints(int segments)
+{
+    std::vector<vec3> points;
+    const float w = 10.f / segments;
+    for (int i = 0; i < segments; i++) {
+        const float x = -5.f + w * i;
+        const float h = i % 2 ? -1.f : 1.f;
+        points.push_back(vec3(x, 0.f, 0.f));
+        points.push_back(vec3(x + w * 0.3f, h, 0.f));
+        points.push_back(vec3(x + w * 0.7f, h, 0.f));
+    }
+    points.push_back(vec3(+5.f, 0.f, 0.f));
+    return points;
+}
+
+} // namespace
+
+void ShowBezierPlot()
+{
+    PROFILE_SCOPE("ShowBezierPlot");
+
+    static const int samples = 200;
+    static int segments = 1;
+    static BezierSpline spline(splinePoints(segments), samples);
+
+    // what re-tessellating the segments a drag touched cost, summed over
+    // the frames of the drag
+    struct DragCost
+    {
+        int moves = 0;
+        size_t segments = 0;
+        uint64_t time = 0;
+    };
+    static DragCost drag;
+    static bool dragging = false;
+
+    ImGui::Begin("Bezier curve");
+    ImGui::Text("Curve");
+    if (ImGui::SliderInt("segments", &segments, 1, 64))
+        spline.assign(splinePoints(segments), samples);
+    ImGui::Text("drag: %d moves, %zu of %zu segments in %.3f ms", drag.moves, drag.segments,
+        size_t(drag.moves) * spline.segmentCount(), double(drag.time) * 1e-6);
+
+    auto red = vec4(1.f, 0.f, 0.f, 1.f);
+    auto green = vec4(0.f, 1.f, 0.f, 1.f);
+    auto magenta = vec4(1.f, 0.f, 1.f, 1.f);
+
+    ImGuiGrid grid;
+    grid.mgmin = vec2(-5.f);
+    grid.mgmax = vec2(+5.f);
+    if (!grid.layoutGrid()) {
+        ImGui::End();
+        return;
+    }
+
+    // handles first, the curve follows them in the same frame; an anchor
+    // takes its controls along
+    const std::span<const vec3> points = spline.points();
+    bool moved = false;
+    for (size_t i = 0; i < points.size(); i++) {
+        vec3 p = points[i];
+        if (!grid.dragPoint(int(i), p))
+            continue;
+        const vec3 delta = p - points[i];
+        spline.setPoint(i, p);
+        if (i % 3 == 0 && i > 0)
+            spline.setPoint(i - 1, points[i - 1] + delta);
+        if (i % 3 == 0 && i + 1 < points.size())
+            spline.setPoint(i + 1, points[i + 1] + delta);
+        moved = true;
+    }
+    const size_t redone = spline.tessellate();
+    PROFILE_COUNTER("tessellated segments", double(redone));
+    if (moved) {
+        if (!dragging)
+            drag = DragCost();
+        drag.moves++;
+        drag.segments += redone;
+        drag.time += spline.lastTime();
+    }
+    dragging = moved || (dragging && ImGui::IsMouseDown(ImGuiMouseButton_Left));
+
+    // drawn again only when the spline or the grid placement changes
+    static PlotCache cache;
+    const ImU32 key = ImHashData(points.data(), points.size_bytes(), grid.cacheKey(ImU32(samples)));
+    if (cache.begin(ImGui::GetWindowDrawList(), key)) {
+        grid.drawBackground();
+        {
+            PROFILE_SCOPE("curve");
+            grid.drawPolyline(spline.samples(), magenta);
+        }
+        for (size_t i = 0; i + 1 < points.size(); i += 3) {
+            grid.drawLine(points[i], points[i + 1], white);
+            grid.drawLine(points[i + 3], points[i + 2], white);
+        }
+        cache.end();
+    }
+    for (size_t i = 0; i < points.size(); i++)
+        grid.drawHandle(int(i), points[i], i % 3 ? green : red);
+
+    ImGui::End();
+}
+
+void ShowSlerpPlot()
+{
+    using gszauer::slerp;
+
+    PROFILE_SCOPE("ShowSlerpPlot");
+
+    ImGuiGrid grid;
+    grid.mgmin = vec2(0.f);
+    grid.mgmax = vec2(+10.f);
+    if (!grid.layoutGrid())
+        return;
+
+    // the points are constant, only the grid placement invalidates them
+    static PlotCache cache;
+    if (!cache.begin(ImGui::GetWindowDrawList(), grid.cacheKey()))
+        return;
+    grid.drawBackground();
+
+    auto o = vec3(0.f, 0.f, 0.f);
+    auto s = vec3(0.f, 10.f, 0.f);
+    auto e = vec3(10.f, 0.f, 0.f);
+    auto l = len(s - o);
+
+    static const int k = 30;
+    float d = 1.f / k;
+    vec3 a[k], b[k];
+    for (int i = 0; i < k; i++) {
+        a[i] = slerp(s, e, d*i) * (l * 0.9f);
+        b[i] = nlerp(s, e, d*i) * l;
+    }
+    grid.drawPoints(b, cyan);
+    grid.drawPoints(a, pink);
+    cache.end();
+}
+
+void ShowTrackPlot()
+{
+    PROFILE_SCOPE("ShowTrackPlot");
+
+    // a recording at 1 kHz: slow drift, noise and a spike every 100k samples
+    static const SeriesPyramid track = [] {
+        const size_t count = size_t(1) << 20;
+        std::vector<float> x(count), y(count);
+        std::mt19937 gen(7);
+        std::normal_distribution<float> noise(0.f, 0.1f);
+        for (size_t i = 0; i < count; i++) {
+            x[i] = float(i) * 1e-3f;
+            y[i] = 0.8f * std::sin(x[i] * 0.01f) + noise(gen);
+            if (i % 100000 == 50000)
+                y[i] = 1.8f;
+        }
+        return SeriesPyramid(x, y);
+    }();
+
+    static float zoom = 1.f;
+    static float center = 0.5f;
+    static bool play = false;
+
+    ImGui::Begin("Track");
+    ImGui::SliderFloat("zoom", &zoom, 1.f, 10000.f, "%.0fx", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderFloat("center", &center, 0.f, 1.f);
+    ImGui::Checkbox("play", &play);
+
+    // scrolls a tenth of the view per second, drawing every frame meanwhile
+    if (play) {
+        center = std::fmod(center + ImGui::GetIO().DeltaTime * 0.1f / zoom, 1.f);
+        frameScheduler().requestFrame();
+    }
+
+    const float duration = track.x()[track.size() - 1];
+    const float span = duration / zoom;
+    ImGuiGrid grid;
+    grid.mgmin = vec2(center * duration - span * 0.5f, -2.f);
+    grid.mgmax = vec2(center * duration + span * 0.5f, +2.f);
+    if (grid.layoutGrid()) {
+        static PlotCache cache;
+        if (cache.begin(ImGui::GetWindowDrawList(), grid.cacheKey())) {
+            grid.drawBackground();
+            {
+                PROFILE_SCOPE("series");
+                grid.drawSeries(track, cyan);
+            }
+            cache.end();
+        }
+    }
+
+    ImGui::End();
+}
+
+void ShowScatterPlot()
+{
+    PROFILE_SCOPE("ShowScatterPlot");
+
+    // two overlapping clusters, enough points to show the marker cost
+    static const std::vector<vec2> points = [] {
+        std::vector<vec2> p(100000);
+        std::mt19937 gen(11);
+        std::normal_distribution<float> spread(0.f, 1.2f);
+        for (size_t i = 0; i < p.size(); i++) {
+            const float cx = i % 3 ? -1.5f : 2.f;
+            const float cy = i % 3 ? -1.f : 1.5f;
+            p[i] = vec2(cx + spread(gen), cy + spread(gen));
+        }
+        return p;
+    }();
+
+    static int count = 100000;
+
+    ImGui::Begin("Scatter");
+    ImGui::SliderInt("points", &count, 1000, int(points.size()));
+
+    ImGuiGrid grid;
+    grid.mgmin = vec2(-5.f);
+    grid.mgmax = vec2(+5.f);
+    if (grid.layoutGrid()) {
+        grid.drawBackground();
+        ImGui::PushClipRect(grid.mbb.Min, grid.mbb.Max, true);
+        {
+            PROFILE_SCOPE("markers");
+            grid.drawPoints(std::span(points).first(size_t(count)), vec4(cyan.r, cyan.g, cyan.b, 0.5f), 1.f);
+        }
+        ImGui::PopClipRect();
+    }
+
+    ImGui::End();
+}
+
+void ShowCurvesPlot()
+{
+    PROFILE_SCOPE("ShowCurvesPlot");
+
+    static int count = 4000;
+    static int threads = 0;
+    static std::vector<gszauer::Bezier<vec3>> curves;
+    static ParallelSplitter splitter;
+
+    ImGui::Begin("Curves");
+    ImGui::SliderInt("curves", &count, 100, 10000);
+    ImGui::SliderInt("threads", &threads, 0, 16, threads == 0 ? "all" : "%d");
+
+    // a bundle fanning out from the left edge, the same for every count
+    if (curves.size() != size_t(count)) {
+        std::mt19937 gen(5);
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        curves.resize(size_t(count));
+        for (gszauer::Bezier<vec3>& curve : curves) {
+            const float end = u(gen) * 4.f;
+            curve.P1 = vec3(-5.f, u(gen) * 0.5f, 0.f);
+            curve.C1 = vec3(-2.f, end * 0.25f + u(gen), 0.f);
+            curve.C2 = vec3(+2.f, end + u(gen), 0.f);
+            curve.P2 = vec3(+5.f, end, 0.f);
+        }
+    }
+
+    ImGuiGrid grid;
+    grid.mgmin = vec2(-5.f);
+    grid.mgmax = vec2(+5.f);
+    if (grid.layoutGrid()) {
+        grid.drawBackground();
+        PROFILE_SCOPE("curves");
+        grid.drawCurves(curves, 32, vec4(pink.r, pink.g, pink.b, 0.25f), splitter, size_t(threads));
+    }
+
+    ImGui::End();
+}
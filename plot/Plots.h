@@ -0,0 +1,22 @@
+#pragma once
+
+// The plots of the app, shared by the Win32 app (main.cpp) and the headless
+// renderer (headless/main.cpp). Call between ImGui::NewFrame() and
+// ImGui::Render().
+
+// Bezier spline with draggable control points, in its own window; shows
+// what re-tessellating after each drag cost
+void ShowBezierPlot();
+
+// slerp against nlerp between two axes, in the current window
+void ShowSlerpPlot();
+
+// a million sample track with zoom, in its own window; asks the frame
+// scheduler for frames while it plays
+void ShowTrackPlot();
+
+// a hundred thousand markers, in its own window
+void ShowScatterPlot();
+
+// thousands of curves tessellated on worker threads, in its own window
+void ShowCurvesPlot();
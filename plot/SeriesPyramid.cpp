@@ -0,0 +1,64 @@
+#include "SeriesPyramid.h"
+
+#include <algorithm>
+#include <cassert>
+
+void SeriesPyramid::assign(std::span<const float> x, std::span<const float> y)
+{
+    assert(x.size() == y.size());
+    mX.assign(x.begin(), x.end());
+    mY.assign(y.begin(), y.end());
+    mLevels.clear();
+
+    if (mY.size() < 2)
+        return;
+
+    // level 1 pairs the samples, every further level pairs the blocks below
+    std::vector<Range> level((mY.size() + 1) / 2);
+    for (size_t i = 0; i < level.size(); ++i) {
+        const size_t last = std::min(2 * i + 1, mY.size() - 1);
+        level[i] = { std::min(mY[2 * i], mY[last]), std::max(mY[2 * i], mY[last]) };
+    }
+    mLevels.push_back(std::move(level));
+
+    while (mLevels.back().size() > 1) {
+        const std::vector<Range>& below = mLevels.back();
+        std::vector<Range> next((below.size() + 1) / 2);
+        for (size_t i = 0; i < next.size(); ++i) {
+            const Range& a = below[2 * i];
+            const Range& b = below[std::min(2 * i + 1, below.size() - 1)];
+            next[i] = { std::min(a.min, b.min), std::max(a.max, b.max) };
+        }
+        mLevels.push_back(std::move(next));
+    }
+}
+
+size_t SeriesPyramid::lowerBound(float value) const
+{
+    return size_t(std::lower_bound(mX.begin(), mX.end(), value) - mX.begin());
+}
+
+SeriesPyramid::Range SeriesPyramid::range(size_t begin, size_t end) const
+{
+    assert(begin < end && end <= size());
+
+    Range r = { mY[begin], mY[begin] };
+    auto merge = [&r](const Range& b) {
+        r.min = std::min(r.min, b.min);
+        r.max = std::max(r.max, b.max);
+    };
+    auto block = [this](size_t level, size_t i) {
+        return level == 0 ? Range{ mY[i], mY[i] } : mLevels[level - 1][i];
+    };
+
+    // bottom up: an odd bound is a block its parent only half covers
+    for (size_t level = 0; begin < end; ++level) {
+        if (begin & 1)
+            merge(block(level, begin++));
+        if (end & 1)
+            merge(block(level, --end));
+        begin >>= 1;
+        end >>= 1;
+    }
+    return r;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Sample series with a min/max pyramid for plotting at any zoom. Level k
+// holds the y range of every aligned block of 2^k samples, so the range of
+// any run of samples is the union of at most two blocks per level, found in
+// O(log n). ImGuiGrid::drawSeries() uses it to reduce what falls into a pixel
+// column to its min and max, whatever the series length.
+class SeriesPyramid
+{
+public:
+    struct Range
+    {
+        float min;
+        float max;
+    };
+
+    SeriesPyramid() = default;
+    SeriesPyramid(std::span<const float> x, std::span<const float> y) { assign(x, y); }
+
+    // x must be non-decreasing and as long as y; builds the pyramid
+    void assign(std::span<const float> x, std::span<const float> y);
+
+    size_t size() const { return mX.size(); }
+    bool empty() const { return mX.empty(); }
+    const float* x() const { return mX.data(); }
+    const float* y() const { return mY.data(); }
+
+    // index of the first sample with x >= value, or size()
+    size_t lowerBound(float value) const;
+
+    // y range of the samples [begin, end), which must not be empty
+    Range range(size_t begin, size_t end) const;
+
+private:
+    std::vector<float> mX;
+    std::vector<float> mY;
+    // mLevels[k - 1] holds the blocks of level k, level 0 is mY itself
+    std::vector<std::vector<Range>> mLevels;
+};
@@ -0,0 +1,97 @@
+#include "WorkerPool.h"
+
+#include <string>
+#include "../profiler/Profiler.h"
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(mLock);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (std::thread& t : mThreads)
+        t.join();
+}
+
+size_t WorkerPool::size() const
+{
+    std::lock_guard<std::mutex> guard(mLock);
+    return mThreads.size();
+}
+
+void WorkerPool::runTasks(size_t count, Task task, void* fn)
+{
+    if (count == 0)
+        return;
+    if (count == 1) {
+        task(fn, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mLock);
+        while (mThreads.size() < count - 1) {
+            const size_t index = mThreads.size() + 1;
+            mThreads.emplace_back([this, index] { work(index); });
+        }
+        mTask = task;
+        mFn = fn;
+        mCount = count;
+        mNext.store(0, std::memory_order_relaxed);
+        mSeats = count - 1;
+        mGeneration++;
+    }
+    mWake.notify_all();
+
+    drain();
+
+    // Workers that wake up from now on would find nothing left, close the
+    // job to them and wait for those still on a task.
+    std::unique_lock<std::mutex> lock(mLock);
+    mSeats = 0;
+    mDone.wait(lock, [this] { return mBusy == 0; });
+    mTask = nullptr;
+    mFn = nullptr;
+}
+
+void WorkerPool::drain()
+{
+    for (;;) {
+        const size_t i = mNext.fetch_add(1, std::memory_order_relaxed);
+        if (i >= mCount)
+            return;
+        mTask(mFn, i);
+    }
+}
+
+void WorkerPool::work(size_t index)
+{
+    profiler::setThreadName((std::string(mName) + " " + std::to_string(index)).c_str());
+
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mLock);
+    for (;;) {
+        mWake.wait(lock, [&] { return mStop || mGeneration != seen; });
+        if (mStop)
+            return;
+        seen = mGeneration;
+        if (mSeats == 0)
+            continue;
+        mSeats--;
+        mBusy++;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        if (--mBusy == 0)
+            mDone.notify_one();
+    }
+}
+
+WorkerPool& workerPool()
+{
+    static WorkerPool pool("draw worker");
+    return pool;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Threads kept for the parallel parts of a frame, such as drawCurves().
+// Starting a thread costs about as much as tessellating the curves it would
+// take, and each thread that records a profiler scope registers a ring of
+// its own, so the workers are started once and reused frame after frame.
+//
+//     workerPool().run(n, [&](size_t i) {
+//         ... task i ...
+//     });
+//
+// run() hands tasks 0 to n - 1 to the calling thread and up to n - 1
+// workers, and returns when all of them are done. Workers are started the
+// first time a run() needs them and otherwise sleep. One run() at a time,
+// from the thread that owns the pool.
+class WorkerPool
+{
+public:
+    // workers show in the profiler as "<name> 1", "<name> 2", ...
+    explicit WorkerPool(const char* name = "worker") : mName(name) {}
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    template <typename F>
+    void run(size_t count, F&& fn)
+    {
+        using Fn = std::remove_reference_t<F>;
+        runTasks(count, [](void* f, size_t i) { (*static_cast<Fn*>(f))(i); }, (void*)&fn);
+    }
+
+    // workers started so far
+    size_t size() const;
+
+private:
+    using Task = void (*)(void* fn, size_t i);
+    void runTasks(size_t count, Task task, void* fn);
+    void drain();
+    void work(size_t index);
+
+    const char* const mName;
+    mutable std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    std::vector<std::thread> mThreads;
+    bool mStop = false;
+
+    // the running job; workers take a seat under the lock, then tasks
+    uint64_t mGeneration = 0;
+    size_t mSeats = 0;              // workers that may still join
+    size_t mBusy = 0;               // workers in drain()
+    Task mTask = nullptr;
+    void* mFn = nullptr;
+    size_t mCount = 0;
+    std::atomic<size_t> mNext{ 0 };
+};
+
+// the app's pool for draw list generation
+WorkerPool& workerPool();
@@ -0,0 +1,202 @@
+#include "ChromeTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+
+namespace profiler {
+
+namespace {
+
+// pseudo thread id of the frame track, past any real thread index
+constexpr uint32_t FRAME_TRACK = 0xffff;
+
+void writeString(std::ostream& out, const char* s)
+{
+    out << '"';
+    for (; *s; ++s) {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            out << '\\' << char(c);
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out << buf;
+        } else {
+            out << char(c);
+        }
+    }
+    out << '"';
+}
+
+// microseconds since the start of the trace, the unit of "ts" and "dur"
+void writeTime(std::ostream& out, uint64_t ns)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03u",
+        static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+    out << buf;
+}
+
+// counter values, with all the digits a double needs to read back the same
+void writeNumber(std::ostream& out, double value)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", value);
+    out << buf;
+}
+
+struct Capture
+{
+    std::mutex lock;
+    size_t remaining = 0;
+    std::string path;
+    Trace trace;
+};
+
+Capture& capture()
+{
+    static Capture* c = new Capture;
+    return *c;
+}
+
+void captureFrame(const Frame& frame)
+{
+    Capture& c = capture();
+    std::lock_guard<std::mutex> guard(c.lock);
+    if (!c.remaining)
+        return;
+
+    // the scopes that started in this frame, later ones go with later frames
+    for (const Event& e : collect(frame.begin, frame.end))
+        if (e.begin >= frame.begin)
+            c.trace.events.push_back(e);
+    const std::vector<Counter> samples = counters(frame.begin, frame.end);
+    c.trace.counters.insert(c.trace.counters.end(), samples.begin(), samples.end());
+    c.trace.frames.push_back(frame);
+
+    if (--c.remaining)
+        return;
+    // still under the lock, captureActive() waits for the file
+    setFrameHook(nullptr);
+    writeChromeTrace(c.path, c.trace);
+    c.trace = Trace();
+}
+
+} // namespace
+
+void writeChromeTrace(std::ostream& out, const Trace& trace)
+{
+    uint64_t origin = UINT64_MAX;
+    for (const Event& e : trace.events)
+        origin = std::min(origin, e.begin);
+    for (const Frame& f : trace.frames)
+        origin = std::min(origin, f.begin);
+    for (const Counter& c : trace.counters)
+        origin = std::min(origin, c.time);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto next = [&]() -> std::ostream& {
+        if (!first)
+            out << ",\n";
+        first = false;
+        return out;
+    };
+
+    // thread names, for the threads that appear
+    std::vector<const ThreadBuffer*> buffers = threads();
+    std::vector<bool> used(buffers.size());
+    for (const Event& e : trace.events)
+        if (e.thread < used.size())
+            used[e.thread] = true;
+    for (const Counter& c : trace.counters)
+        if (c.thread < used.size())
+            used[c.thread] = true;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (!used[i])
+            continue;
+        next() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+        writeString(out, buffers[i]->name().c_str());
+        out << "}}";
+    }
+    if (!trace.frames.empty())
+        next() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << FRAME_TRACK
+               << ",\"args\":{\"name\":\"frames\"}}";
+
+    for (const Frame& f : trace.frames) {
+        next() << "{\"ph\":\"X\",\"name\":\"frame " << f.index << "\",\"pid\":1,\"tid\":" << FRAME_TRACK
+               << ",\"ts\":";
+        writeTime(out, f.begin - origin);
+        out << ",\"dur\":";
+        writeTime(out, f.end - f.begin);
+        out << '}';
+    }
+
+    for (const Event& e : trace.events) {
+        next() << "{\"ph\":\"X\",\"name\":";
+        writeString(out, e.name);
+        out << ",\"pid\":1,\"tid\":" << e.thread << ",\"ts\":";
+        writeTime(out, e.begin - origin);
+        out << ",\"dur\":";
+        writeTime(out, e.end - e.begin);
+        out << '}';
+    }
+
+    for (const Counter& c : trace.counters) {
+        next() << "{\"ph\":\"C\",\"name\":";
+        writeString(out, c.name);
+        out << ",\"pid\":1,\"tid\":" << c.thread << ",\"ts\":";
+        writeTime(out, c.time - origin);
+        // JSON has no NaN or infinity
+        out << ",\"args\":{\"value\":";
+        writeNumber(out, std::isfinite(c.value) ? c.value : 0.0);
+        out << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+bool writeChromeTrace(const std::string& path, const Trace& trace)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    writeChromeTrace(file, trace);
+    return bool(file.flush());
+}
+
+bool dumpChromeTrace(const std::string& path)
+{
+    Trace trace;
+    trace.frames = frames(SIZE_MAX);
+    if (!trace.frames.empty() && trace.frames.back().end == 0)
+        trace.frames.back().end = now();
+    if (!trace.frames.empty()) {
+        trace.events = collect(trace.frames.front().begin, trace.frames.back().end);
+        trace.counters = counters(trace.frames.front().begin, trace.frames.back().end);
+    }
+    return writeChromeTrace(path, trace);
+}
+
+void captureChromeTrace(size_t frames, std::string path)
+{
+    Capture& c = capture();
+    std::lock_guard<std::mutex> guard(c.lock);
+    c.remaining = frames;
+    c.path = std::move(path);
+    c.trace = Trace();
+    setFrameHook(frames ? captureFrame : nullptr);
+}
+
+bool captureActive()
+{
+    Capture& c = capture();
+    std::lock_guard<std::mutex> guard(c.lock);
+    return c.remaining != 0;
+}
+
+} // namespace profiler
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "Profiler.h"
+
+// Export of recorded scopes, frames and counters in the Chrome Trace Event
+// format, for chrome://tracing and ui.perfetto.dev. Scopes become complete
+// ("X") events on their thread, frames complete events on a separate
+// "frames" track and counters counter ("C") tracks.
+
+namespace profiler {
+
+struct Trace
+{
+    std::vector<Event> events;
+    std::vector<Frame> frames;
+    std::vector<Counter> counters;
+};
+
+void writeChromeTrace(std::ostream& out, const Trace& trace);
+bool writeChromeTrace(const std::string& path, const Trace& trace);
+
+// Writes whatever the rings still hold for the frames in the viewer
+// history, the last few seconds. Returns false if the file can't be written.
+bool dumpChromeTrace(const std::string& path);
+
+// Records the next `frames` complete frames and writes them to `path` once
+// the last one ends. Frames are drained from the rings as they complete, so
+// captures can be far longer than the ring capacity. Replaces a pending
+// capture. Costs nothing while no capture is pending.
+void captureChromeTrace(size_t frames, std::string path);
+
+// true from captureChromeTrace() until its file has been written
+bool captureActive();
+
+} // namespace profiler
@@ -0,0 +1,256 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace profiler {
+
+namespace details {
+std::atomic<bool> gEnabled{ true };
+}
+
+namespace {
+
+// frame history kept for the viewer, a few seconds at 60 Hz
+constexpr size_t FRAME_HISTORY = 1024;
+constexpr size_t COUNTER_HISTORY = 64 * 1024;
+
+struct Registry
+{
+    std::mutex lock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::deque<Frame> frames;
+    std::deque<Counter> counters;
+    uint64_t nextFrame = 0;
+};
+
+std::atomic<void (*)(const Frame&)> gFrameHook{ nullptr };
+
+// never destroyed, threads may still record while statics are torn down
+Registry& registry()
+{
+    static Registry* r = new Registry;
+    return *r;
+}
+
+thread_local ThreadBuffer* tBuffer = nullptr;
+
+ThreadBuffer& registerThread(const char* name)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    const uint32_t index = uint32_t(r.buffers.size());
+    std::string label = name ? name : "thread " + std::to_string(index);
+    r.buffers.push_back(std::make_unique<ThreadBuffer>(index, std::move(label)));
+    return *r.buffers.back();
+}
+
+} // namespace
+
+uint64_t now()
+{
+    using namespace std::chrono;
+    return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+ThreadBuffer::ThreadBuffer(uint32_t index, std::string name)
+    : mIndex(index), mName(std::move(name)), mEvents(CAPACITY)
+{
+}
+
+static_assert(std::atomic_ref<const char*>::is_always_lock_free &&
+    std::atomic_ref<uint64_t>::is_always_lock_free &&
+    std::atomic_ref<uint32_t>::is_always_lock_free, "push() must not take a lock");
+
+Event ThreadBuffer::load(Event& slot)
+{
+    Event e;
+    e.name = std::atomic_ref<const char*>(slot.name).load(std::memory_order_relaxed);
+    e.begin = std::atomic_ref<uint64_t>(slot.begin).load(std::memory_order_relaxed);
+    e.end = std::atomic_ref<uint64_t>(slot.end).load(std::memory_order_relaxed);
+    e.depth = std::atomic_ref<uint32_t>(slot.depth).load(std::memory_order_relaxed);
+    e.thread = std::atomic_ref<uint32_t>(slot.thread).load(std::memory_order_relaxed);
+    return e;
+}
+
+void ThreadBuffer::copy(uint64_t since, std::vector<Event>& out) const
+{
+    const uint64_t head = mHead.load(std::memory_order_acquire);
+    const uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+    const size_t start = out.size();
+    for (uint64_t i = first; i < head; ++i)
+        out.push_back(load(mEvents[i % CAPACITY]));
+
+    // The writer may have wrapped around onto the oldest slots while we
+    // copied, and may be halfway through the slot after its head. Those
+    // copies can be torn, drop them. The fence pairs with the one in push():
+    // if we read a field the writer stored for slot n, the head we load next
+    // is at least n.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = mHead.load(std::memory_order_relaxed) + 1;
+    const uint64_t valid = after > CAPACITY ? after - CAPACITY : 0;
+    const size_t stale = size_t(std::min(head, std::max(valid, first)) - first);
+    out.erase(out.begin() + start, out.begin() + start + stale);
+
+    out.erase(std::remove_if(out.begin() + start, out.end(),
+        [since](const Event& e) { return e.end <= since; }), out.end());
+}
+
+ThreadBuffer& threadBuffer()
+{
+    if (!tBuffer)
+        tBuffer = &registerThread(nullptr);
+    return *tBuffer;
+}
+
+void setThreadName(const char* name)
+{
+    if (!tBuffer)
+        tBuffer = &registerThread(name);
+}
+
+std::vector<const ThreadBuffer*> threads()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    std::vector<const ThreadBuffer*> result;
+    for (const auto& b : r.buffers)
+        result.push_back(b.get());
+    return result;
+}
+
+void setEnabled(bool enabled)
+{
+    details::gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void beginFrame()
+{
+    const uint64_t t = now();
+    Registry& r = registry();
+    Frame done = { 0, 0, 0 };
+    {
+        std::lock_guard<std::mutex> guard(r.lock);
+        if (!r.frames.empty()) {
+            r.frames.back().end = t;
+            done = r.frames.back();
+        }
+        if (r.frames.size() == FRAME_HISTORY)
+            r.frames.pop_front();
+        r.frames.push_back({ r.nextFrame++, t, 0 });
+    }
+
+    // outside the lock, the hook reads the rings and counters
+    if (auto hook = gFrameHook.load(std::memory_order_acquire); hook && done.end)
+        hook(done);
+}
+
+void setFrameHook(void (*hook)(const Frame& frame))
+{
+    gFrameHook.store(hook, std::memory_order_release);
+}
+
+void counter(const char* name, double value)
+{
+    const uint32_t thread = threadBuffer().index();
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (r.counters.size() == COUNTER_HISTORY)
+        r.counters.pop_front();
+    // timed under the lock so the history stays sorted
+    r.counters.push_back({ name, now(), value, thread });
+}
+
+std::vector<Counter> counters(uint64_t begin, uint64_t end)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    auto first = std::lower_bound(r.counters.begin(), r.counters.end(), begin,
+        [](const Counter& c, uint64_t t) { return c.time < t; });
+    auto last = std::lower_bound(first, r.counters.end(), end,
+        [](const Counter& c, uint64_t t) { return c.time < t; });
+    return std::vector<Counter>(first, last);
+}
+
+std::vector<Frame> frames(size_t count)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    count = std::min(count, r.frames.size());
+    return std::vector<Frame>(r.frames.end() - count, r.frames.end());
+}
+
+std::vector<Event> collect(uint64_t begin, uint64_t end)
+{
+    std::vector<Event> events;
+    for (const ThreadBuffer* b : threads()) {
+        const size_t start = events.size();
+        b->copy(begin, events);
+        events.erase(std::remove_if(events.begin() + start, events.end(),
+            [end](const Event& e) { return e.begin >= end; }), events.end());
+        // a ring holds events in completion order, inner scopes first
+        std::sort(events.begin() + start, events.end(), [](const Event& a, const Event& b) {
+            return a.begin < b.begin || (a.begin == b.begin && a.depth < b.depth);
+        });
+    }
+    return events;
+}
+
+std::vector<ScopeStats> scopeStats(const std::vector<Frame>& frames)
+{
+    if (frames.empty())
+        return {};
+
+    // time and call count of every scope in every frame
+    struct PerFrame
+    {
+        std::vector<uint64_t> time;
+        std::vector<uint32_t> calls;
+    };
+    auto less = [](const char* a, const char* b) { return std::strcmp(a, b) < 0; };
+    std::map<const char*, PerFrame, decltype(less)> scopes(less);
+
+    for (const Event& e : collect(frames.front().begin, frames.back().end)) {
+        // the frame the scope started in
+        auto f = std::upper_bound(frames.begin(), frames.end(), e.begin,
+            [](uint64_t t, const Frame& frame) { return t < frame.begin; });
+        if (f == frames.begin() || e.begin >= (f - 1)->end)
+            continue;
+        const size_t index = size_t(f - frames.begin()) - 1;
+        PerFrame& p = scopes[e.name];
+        if (p.time.empty()) {
+            p.time.resize(frames.size());
+            p.calls.resize(frames.size());
+        }
+        p.time[index] += e.end - e.begin;
+        ++p.calls[index];
+    }
+
+    std::vector<ScopeStats> stats;
+    for (const auto& [name, p] : scopes) {
+        uint64_t total = 0, calls = 0, count = 0;
+        uint64_t lo = UINT64_MAX, hi = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (!p.calls[i])
+                continue;
+            total += p.time[i];
+            calls += p.calls[i];
+            lo = std::min(lo, p.time[i]);
+            hi = std::max(hi, p.time[i]);
+            ++count;
+        }
+        stats.push_back({ name, uint32_t((calls + count / 2) / count),
+            double(lo) * 1e-6, double(total) / double(count) * 1e-6, double(hi) * 1e-6 });
+    }
+    std::sort(stats.begin(), stats.end(), [](const ScopeStats& a, const ScopeStats& b) {
+        return a.avgMs > b.avgMs;
+    });
+    return stats;
+}
+
+} // namespace profiler
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped CPU timers for the hot paths of the app.
+//
+//     void ShowBezierPlot()
+//     {
+//         PROFILE_SCOPE("ShowBezierPlot");
+//         ...
+//     }
+//
+// Every thread records into its own fixed size ring buffer, so a scope costs
+// two clock reads and one store and never takes a lock. The main loop marks
+// frames with beginFrame(); the viewer in ProfilerWindow.h reads the buffers
+// back per frame. Old events are overwritten once a ring is full.
+//
+// Define PROFILER_DISABLE to compile the scopes out entirely; at run time
+// setEnabled(false) reduces them to one relaxed load.
+
+namespace profiler {
+
+// nanoseconds on a monotonic clock
+uint64_t now();
+
+struct Event
+{
+    const char* name;   // must outlive the profiler, usually a literal
+    uint64_t begin;
+    uint64_t end;
+    uint32_t depth;     // nesting level within the thread, 0 for outermost
+    uint32_t thread;    // index into threads()
+};
+
+struct Frame
+{
+    uint64_t index;
+    uint64_t begin;
+    uint64_t end;       // 0 while the frame is still running
+};
+
+// a sampled value, e.g. vertices per frame
+struct Counter
+{
+    const char* name;   // must outlive the profiler, usually a literal
+    uint64_t time;
+    double value;
+    uint32_t thread;
+};
+
+// Single writer ring of events owned by one thread. Readers on other threads
+// copy a snapshot and drop whatever the writer may have overwritten meanwhile.
+// The slots are accessed field by field through relaxed atomics, like a
+// seqlock: a reader may see a torn event but never races on one, and finds
+// out from the head whether it has to discard it.
+class ThreadBuffer
+{
+public:
+    static constexpr size_t CAPACITY = 16 * 1024;
+
+    ThreadBuffer(uint32_t index, std::string name);
+
+    void push(const Event& e)
+    {
+        const uint64_t head = mHead.load(std::memory_order_relaxed);
+        // a reader that sees any field of this slot also sees head, and so
+        // knows the slot is being overwritten
+        std::atomic_thread_fence(std::memory_order_release);
+        store(mEvents[head % CAPACITY], e);
+        mHead.store(head + 1, std::memory_order_release);
+    }
+
+    // Appends the retained events that ended after `since`, oldest first. The
+    // newest CAPACITY - 1 are retained, the slot after them may be mid-write.
+    void copy(uint64_t since, std::vector<Event>& out) const;
+
+    uint32_t index() const { return mIndex; }
+    const std::string& name() const { return mName; }
+
+    // nesting level of the next scope, only touched by the owner
+    uint32_t depth = 0;
+
+private:
+    static void store(Event& slot, const Event& e)
+    {
+        std::atomic_ref<const char*>(slot.name).store(e.name, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(slot.begin).store(e.begin, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(slot.end).store(e.end, std::memory_order_relaxed);
+        std::atomic_ref<uint32_t>(slot.depth).store(e.depth, std::memory_order_relaxed);
+        std::atomic_ref<uint32_t>(slot.thread).store(e.thread, std::memory_order_relaxed);
+    }
+
+    static Event load(Event& slot);
+
+    const uint32_t mIndex;
+    const std::string mName;
+    std::atomic<uint64_t> mHead{ 0 };
+    mutable std::vector<Event> mEvents;    // atomic_ref needs non-const slots
+};
+
+// buffer of the calling thread, registered on first use
+ThreadBuffer& threadBuffer();
+
+// names the calling thread in the viewer, call before its first scope
+void setThreadName(const char* name);
+
+// every buffer registered so far, indexed by Event::thread
+std::vector<const ThreadBuffer*> threads();
+
+namespace details {
+extern std::atomic<bool> gEnabled;
+}
+
+// Runtime switch, on by default. Scopes already open when it flips are
+// still recorded so nesting stays consistent.
+void setEnabled(bool enabled);
+
+inline bool enabled()
+{
+    return details::gEnabled.load(std::memory_order_relaxed);
+}
+
+// Ends the running frame and starts the next one. Call once per iteration of
+// the main loop, before any of its scopes.
+void beginFrame();
+
+// the last `count` frames, oldest first; the running one comes last
+std::vector<Frame> frames(size_t count);
+
+// Called from beginFrame() with every frame that completes, on the thread
+// that ends it. nullptr removes the hook. Used by the trace capture in
+// ChromeTrace.h.
+void setFrameHook(void (*hook)(const Frame& frame));
+
+// Records a counter sample. Counters go through a lock, so sample them a
+// few times per frame rather than per item.
+void counter(const char* name, double value);
+
+// counter samples in [begin, end), oldest first
+std::vector<Counter> counters(uint64_t begin, uint64_t end);
+
+// events of all threads that overlap [begin, end), sorted by thread, begin
+std::vector<Event> collect(uint64_t begin, uint64_t end);
+
+// per scope timings across frames, a scope's time in one frame being the
+// sum of all its calls in that frame
+struct ScopeStats
+{
+    const char* name;
+    uint32_t calls;     // per frame, averaged
+    double minMs;
+    double avgMs;
+    double maxMs;
+};
+
+// Statistics over the given complete frames, ordered by avgMs descending.
+// Frames in which a scope did not run are left out of its numbers.
+std::vector<ScopeStats> scopeStats(const std::vector<Frame>& frames);
+
+class Scope
+{
+public:
+    explicit Scope(const char* name)
+    {
+        if (!enabled())
+            return;
+        mBuffer = &threadBuffer();
+        mName = name;
+        mDepth = mBuffer->depth++;
+        mBegin = now();
+    }
+
+    ~Scope()
+    {
+        if (!mBuffer)
+            return;
+        mBuffer->push({ mName, mBegin, now(), mDepth, mBuffer->index() });
+        --mBuffer->depth;
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    ThreadBuffer* mBuffer = nullptr;
+    const char* mName = nullptr;
+    uint64_t mBegin = 0;
+    uint32_t mDepth = 0;
+};
+
+} // namespace profiler
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+#if defined(PROFILER_DISABLE)
+#   define PROFILE_SCOPE(name) do {} while (0)
+#   define PROFILE_COUNTER(name, value) do {} while (0)
+#else
+#   define PROFILE_SCOPE(name) ::profiler::Scope PROFILER_CONCAT(profileScope_, __LINE__)(name)
+#   define PROFILE_COUNTER(name, value) \
+        do { if (::profiler::enabled()) ::profiler::counter(name, double(value)); } while (0)
+#endif
@@ -0,0 +1,315 @@
+#include "ProfilerWindow.h"
+#include "ChromeTrace.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <imgui.h>
+
+namespace profiler {
+
+namespace {
+
+// frames in the graph and the statistics
+constexpr size_t HISTORY = 240;
+
+constexpr float ROW_HEIGHT = 18.f;
+
+struct ViewerState
+{
+    bool paused = false;
+    int captureFrames = 600;
+    char tracePath[256] = "profile.json";
+    const char* traceStatus = "";
+    int selected = -1;                  // index into frames, -1 follows the newest
+    std::vector<Frame> frames;          // complete frames only
+    std::vector<Event> events;          // everything in frames
+    std::vector<ScopeStats> stats;
+};
+
+ViewerState& state()
+{
+    static ViewerState s;
+    return s;
+}
+
+double toMs(uint64_t ns)
+{
+    return double(ns) * 1e-6;
+}
+
+// stable colour per scope name
+ImU32 scopeColor(const char* name)
+{
+    uint32_t h = 2166136261u;
+    for (const char* c = name; *c; ++c)
+        h = (h ^ uint8_t(*c)) * 16777619u;
+    const float hue = float(h % 360) / 360.f;
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB(hue, 0.55f, 0.85f, r, g, b);
+    return ImGui::GetColorU32(ImVec4(r, g, b, 1.f));
+}
+
+// filled box with the label clipped to it; returns whether it is hovered
+bool drawBox(ImDrawList* dl, ImVec2 a, ImVec2 b, const char* label, ImU32 color)
+{
+    if (b.x - a.x < 1.f)
+        b.x = a.x + 1.f;
+    dl->AddRectFilled(a, b, color);
+    dl->AddRect(a, b, IM_COL32(0, 0, 0, 96));
+    if (b.x - a.x > 16.f) {
+        dl->PushClipRect(a, b, true);
+        dl->AddText(ImVec2(a.x + 3.f, a.y + 2.f), IM_COL32(0, 0, 0, 255), label);
+        dl->PopClipRect();
+    }
+    return ImGui::IsMouseHoveringRect(a, b);
+}
+
+void refresh(ViewerState& s)
+{
+    std::vector<Frame> f = frames(HISTORY + 1);
+    if (!f.empty() && f.back().end == 0)
+        f.pop_back();
+    s.frames = std::move(f);
+    s.events = s.frames.empty() ? std::vector<Event>()
+        : collect(s.frames.front().begin, s.frames.back().end);
+    s.stats = scopeStats(s.frames);
+}
+
+void showFrameGraph(ViewerState& s)
+{
+    std::vector<float> ms(s.frames.size());
+    for (size_t i = 0; i < s.frames.size(); ++i)
+        ms[i] = float(toMs(s.frames[i].end - s.frames[i].begin));
+    const float peak = ms.empty() ? 1.f : *std::max_element(ms.begin(), ms.end());
+
+    ImGui::PlotHistogram("##frames", ms.data(), int(ms.size()), 0, "frame time (ms)",
+        0.f, std::max(peak, 16.7f), ImVec2(ImGui::GetContentRegionAvail().x, 60.f));
+
+    // click a bar to pick the frame
+    if (ImGui::IsItemClicked() && !ms.empty()) {
+        const float x = ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x;
+        const float w = ImGui::GetItemRectSize().x;
+        s.selected = std::clamp(int(x / w * float(ms.size())), 0, int(ms.size()) - 1);
+        s.paused = true;
+    }
+}
+
+// one lane per thread, one row per nesting level
+void showTimeline(const ViewerState& s, const Frame& frame)
+{
+    const std::vector<const ThreadBuffer*> buffers = threads();
+    const double span = double(frame.end - frame.begin);
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    const float width = ImGui::GetContentRegionAvail().x;
+    const Event* hovered = nullptr;
+
+    for (const ThreadBuffer* b : buffers) {
+        uint32_t rows = 0;
+        for (const Event& e : s.events)
+            if (e.thread == b->index() && e.end > frame.begin && e.begin < frame.end)
+                rows = std::max(rows, e.depth + 1);
+        if (!rows)
+            continue;
+
+        ImGui::TextUnformatted(b->name().c_str());
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(ImVec2(width, ROW_HEIGHT * float(rows)));
+        for (const Event& e : s.events) {
+            if (e.thread != b->index() || e.end <= frame.begin || e.begin >= frame.end)
+                continue;
+            const double x0 = (double(std::max(e.begin, frame.begin)) - double(frame.begin)) / span;
+            const double x1 = (double(std::min(e.end, frame.end)) - double(frame.begin)) / span;
+            const ImVec2 a(origin.x + float(x0) * width, origin.y + ROW_HEIGHT * float(e.depth));
+            const ImVec2 c(origin.x + float(x1) * width, a.y + ROW_HEIGHT - 1.f);
+            if (drawBox(dl, a, c, e.name, scopeColor(e.name)))
+                hovered = &e;
+        }
+    }
+
+    if (hovered)
+        ImGui::SetTooltip("%s\n%.3f ms", hovered->name, toMs(hovered->end - hovered->begin));
+}
+
+// Calls merged by call path and laid out by total time, outermost on top.
+void showFlame(const ViewerState& s, const Frame& frame)
+{
+    struct Node
+    {
+        const char* name;
+        int parent;
+        uint32_t depth;
+        uint32_t calls;
+        uint64_t time;
+    };
+    std::vector<Node> nodes;
+    std::vector<int> stack;
+    uint64_t rootTime = 0;
+
+    // events arrive per thread sorted by begin, parents before children
+    uint32_t thread = UINT32_MAX;
+    for (const Event& e : s.events) {
+        if (e.begin < frame.begin || e.begin >= frame.end)
+            continue;
+        if (e.thread != thread) {
+            thread = e.thread;
+            stack.clear();
+        }
+        stack.resize(std::min<size_t>(stack.size(), e.depth));
+        const int parent = stack.empty() ? -1 : stack.back();
+        int node = -1;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].parent == parent && std::strcmp(nodes[i].name, e.name) == 0) {
+                node = int(i);
+                break;
+            }
+        }
+        if (node < 0) {
+            node = int(nodes.size());
+            nodes.push_back({ e.name, parent, uint32_t(stack.size()), 0, 0 });
+        }
+        nodes[node].calls += 1;
+        nodes[node].time += e.end - e.begin;
+        if (parent < 0)
+            rootTime += e.end - e.begin;
+        stack.push_back(node);
+    }
+    if (nodes.empty()) {
+        ImGui::TextDisabled("no scopes in this frame");
+        return;
+    }
+
+    uint32_t depth = 0;
+    for (const Node& n : nodes)
+        depth = std::max(depth, n.depth + 1);
+
+    // the frame spans the full width, the gaps are untracked time
+    const double scale = double(ImGui::GetContentRegionAvail().x)
+        / double(std::max(rootTime, frame.end - frame.begin));
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(ImGui::GetContentRegionAvail().x, ROW_HEIGHT * float(depth)));
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+
+    // children start at their parent's left edge, in first call order
+    std::vector<float> left(nodes.size()), cursor(nodes.size());
+    float rootCursor = origin.x;
+    int hovered = -1;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& n = nodes[i];
+        float& next = n.parent < 0 ? rootCursor : cursor[n.parent];
+        left[i] = next;
+        cursor[i] = next;
+        next += float(double(n.time) * scale);
+
+        const ImVec2 a(left[i], origin.y + ROW_HEIGHT * float(n.depth));
+        const ImVec2 b(left[i] + float(double(n.time) * scale), a.y + ROW_HEIGHT - 1.f);
+        if (drawBox(dl, a, b, n.name, scopeColor(n.name)))
+            hovered = int(i);
+    }
+
+    if (hovered >= 0) {
+        const Node& n = nodes[hovered];
+        ImGui::SetTooltip("%s\n%.3f ms in %u call%s", n.name, toMs(n.time), n.calls,
+            n.calls == 1 ? "" : "s");
+    }
+}
+
+void showStats(const ViewerState& s)
+{
+    ImGui::Text("%zu frames", s.frames.size());
+    ImGui::Columns(5, "scopes");
+    ImGui::Separator();
+    for (const char* title : { "scope", "calls", "min ms", "avg ms", "max ms" }) {
+        ImGui::TextUnformatted(title);
+        ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    for (const ScopeStats& st : s.stats) {
+        ImGui::TextUnformatted(st.name);
+        ImGui::NextColumn();
+        ImGui::Text("%u", st.calls);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", st.minMs);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", st.avgMs);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", st.maxMs);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
+} // namespace
+
+void ShowProfilerWindow(bool* open)
+{
+    PROFILE_SCOPE("ShowProfilerWindow");
+
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ViewerState& s = state();
+    bool record = enabled();
+    if (ImGui::Checkbox("Record", &record))
+        setEnabled(record);
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Pause", &s.paused) && !s.paused)
+        s.selected = -1;
+
+    // Chrome trace export, the rings now or the next N frames
+    ImGui::SetNextItemWidth(200.f);
+    ImGui::InputText("##trace", s.tracePath, sizeof(s.tracePath));
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace"))
+        s.traceStatus = dumpChromeTrace(s.tracePath) ? "saved" : "write failed";
+    ImGui::SameLine();
+    if (captureActive()) {
+        ImGui::TextUnformatted("capturing...");
+    } else {
+        if (ImGui::Button("Capture"))
+            captureChromeTrace(size_t(std::max(s.captureFrames, 1)), s.tracePath);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80.f);
+        ImGui::InputInt("frames", &s.captureFrames, 0);
+    }
+    ImGui::SameLine();
+    ImGui::TextUnformatted(s.traceStatus);
+
+    if (!s.paused)
+        refresh(s);
+
+    showFrameGraph(s);
+    if (s.frames.empty()) {
+        ImGui::End();
+        return;
+    }
+
+    const int index = s.selected < 0 ? int(s.frames.size()) - 1
+        : std::min(s.selected, int(s.frames.size()) - 1);
+    const Frame& frame = s.frames[index];
+    ImGui::Text("frame %llu: %.3f ms", (unsigned long long)frame.index, toMs(frame.end - frame.begin));
+
+    if (ImGui::BeginTabBar("views")) {
+        if (ImGui::BeginTabItem("Timeline")) {
+            showTimeline(s, frame);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Flame")) {
+            showFlame(s, frame);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Scopes")) {
+            showStats(s);
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
+
+    ImGui::End();
+}
+
+} // namespace profiler
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace profiler {
+
+// ImGui viewer for the recorded scopes: a frame time graph, per scope
+// min/avg/max over the recent frames, and timeline and flame views of the
+// selected frame. Call between ImGui::NewFrame() and ImGui::Render().
+void ShowProfilerWindow(bool* open = nullptr);
+
+} // namespace profiler
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "gszauer/VecStream.h"
+#include "math/el_dispatch.h"
+#include "math/el_vec4.h"
+
+// Error of the float kernels and the templated math against a wider
+// reference, in units in the last place. float results are checked against
+// double and double results against long double. A vector's error is taken
+// relative to the ulp of its largest reference component, so a component
+// that cancels to nearly zero does not dominate the statistics.
+//
+// Every check prints max and mean ulp together with the time per item, the
+// numbers a fast path has to come with. The asserted bounds sit a little
+// above what current x86-64 hardware measures.
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+template <typename T>
+using reference_t = std::conditional_t<std::is_same_v<T, float>, double, long double>;
+
+template <typename T>
+double ulpOf(reference_t<T> magnitude)
+{
+    const T m = T(std::fabs(magnitude));
+    if (m == T(0))
+        return double(std::numeric_limits<T>::denorm_min());
+    return double(std::nextafter(m, std::numeric_limits<T>::infinity()) - m);
+}
+
+template <typename T, typename R>
+double ulpError(const T* got, const R* ref, size_t n)
+{
+    R scale = 0;
+    for (size_t i = 0; i < n; ++i)
+        scale = std::max(scale, R(std::fabs(ref[i])));
+    const double ulp = ulpOf<T>(scale);
+    double err = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!std::isfinite(got[i]))
+            return std::numeric_limits<double>::infinity();
+        err = std::max(err, double(std::fabs(R(got[i]) - ref[i])) / ulp);
+    }
+    return err;
+}
+
+struct UlpStats
+{
+    double max = 0;
+    double sum = 0;
+    size_t count = 0;
+
+    void add(double ulp)
+    {
+        max = std::max(max, ulp);
+        sum += ulp;
+        ++count;
+    }
+
+    double mean() const { return count ? sum / double(count) : 0; }
+};
+
+// best of a few runs, f processes `items` items per call
+template <typename F>
+double nsPerItem(size_t items, F&& f)
+{
+    using clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 5; ++run) {
+        const auto start = clock::now();
+        f();
+        const std::chrono::duration<double, std::nano> ns = clock::now() - start;
+        best = std::min(best, ns.count() / double(std::max<size_t>(items, 1)));
+    }
+    return best;
+}
+
+void report(const char* name, const char* type, const UlpStats& stats, double ns)
+{
+    std::printf("[ ACCURACY ] %-28s %-7s max %10.3f ulp  mean %8.3f ulp  %8.2f ns/item\n",
+        name, type, stats.max, stats.mean(), ns);
+}
+
+template <typename T>
+const char* typeName() { return std::is_same_v<T, float> ? "float" : "double"; }
+
+//------------------------------------------------------------------------------
+// references, written against plain arrays so they share no code with the
+// functions under test
+
+template <typename R>
+struct Ref3
+{
+    R v[3];
+};
+
+template <typename R>
+R refDot(const Ref3<R>& a, const Ref3<R>& b)
+{
+    return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2];
+}
+
+template <typename R>
+Ref3<R> refScaled(const Ref3<R>& a, R s)
+{
+    return { { a.v[0] * s, a.v[1] * s, a.v[2] * s } };
+}
+
+template <typename R>
+Ref3<R> refNormalized(const Ref3<R>& a)
+{
+    return refScaled(a, R(1) / std::sqrt(refDot(a, a)));
+}
+
+// the angle from atan2 stays accurate for nearly parallel inputs, where
+// acos of the dot product loses half the digits
+template <typename R>
+Ref3<R> refSlerp(const Ref3<R>& s, const Ref3<R>& e, R t)
+{
+    const Ref3<R> a = refNormalized(s);
+    const Ref3<R> b = refNormalized(e);
+    const Ref3<R> c = { {
+        a.v[1] * b.v[2] - a.v[2] * b.v[1],
+        a.v[2] * b.v[0] - a.v[0] * b.v[2],
+        a.v[0] * b.v[1] - a.v[1] * b.v[0] } };
+    const R theta = std::atan2(std::sqrt(refDot(c, c)), refDot(a, b));
+    if (theta == R(0))
+        return a;
+    if (std::sqrt(refDot(c, c)) < std::numeric_limits<R>::epsilon() && refDot(a, b) < R(0)) {
+        // opposite, half way round through the axis a is least aligned with;
+        // with contracted multiply-adds the cross product is only nearly zero
+        const int k = std::fabs(a.v[0]) <= std::fabs(a.v[1]) && std::fabs(a.v[0]) <= std::fabs(a.v[2]) ? 0
+            : std::fabs(a.v[1]) <= std::fabs(a.v[2]) ? 1 : 2;
+        Ref3<R> p = { { 0, 0, 0 } };
+        p.v[(k + 1) % 3] = a.v[(k + 2) % 3];
+        p.v[(k + 2) % 3] = -a.v[(k + 1) % 3];
+        p = refNormalized(p);
+        const R angle = t * R(PI);
+        return { { a.v[0] * std::cos(angle) + p.v[0] * std::sin(angle),
+            a.v[1] * std::cos(angle) + p.v[1] * std::sin(angle),
+            a.v[2] * std::cos(angle) + p.v[2] * std::sin(angle) } };
+    }
+    const R wa = std::sin((1 - t) * theta) / std::sin(theta);
+    const R wb = std::sin(t * theta) / std::sin(theta);
+    return { { a.v[0] * wa + b.v[0] * wb, a.v[1] * wa + b.v[1] * wb, a.v[2] * wa + b.v[2] * wb } };
+}
+
+// Bernstein form, independent of the de Casteljau order the kernels use
+template <typename R>
+R refBezier(const R p[4], R t)
+{
+    const R s = 1 - t;
+    return s * s * s * p[0] + 3 * s * s * t * p[1] + 3 * s * t * t * p[2] + t * t * t * p[3];
+}
+
+template <typename T>
+Ref3<reference_t<T>> toRef(const gszauer::TVec3<T>& v)
+{
+    using R = reference_t<T>;
+    return { { R(v.x), R(v.y), R(v.z) } };
+}
+
+//------------------------------------------------------------------------------
+// input sets
+
+// random vectors in a cube, plus a dense sweep of directions at lengths from
+// 2^-8 to 2^8
+template <typename T>
+std::vector<gszauer::TVec3<T>> vectorSet()
+{
+    std::vector<gszauer::TVec3<T>> v;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-4, 4);
+    for (int i = 0; i < 4096; ++i)
+        v.emplace_back(T(dist(gen)), T(dist(gen)), T(dist(gen)));
+    for (int l = -8; l <= 8; ++l) {
+        const double len = std::ldexp(1.0, l);
+        for (int a = 0; a < 64; ++a) {
+            for (int b = 0; b < 32; ++b) {
+                const double phi = a * (2 * PI / 64), theta = (b + 0.5) * (PI / 32);
+                v.emplace_back(T(len * std::sin(theta) * std::cos(phi)),
+                    T(len * std::sin(theta) * std::sin(phi)), T(len * std::cos(theta)));
+            }
+        }
+    }
+    return v;
+}
+
+struct Pair
+{
+    double s[3], e[3];
+};
+
+enum class PairKind { Random, NearParallel, Opposite };
+
+// random pairs, pairs whose angle shrinks from 0.1 down to 1e-7 radians, and
+// pairs pointing exactly opposite ways
+std::vector<Pair> slerpPairs(PairKind kind)
+{
+    std::vector<Pair> pairs;
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    for (int i = 0; i < 512; ++i) {
+        double a[3] = { dist(gen), dist(gen), dist(gen) + 2 };
+        const double n = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        for (double& c : a)
+            c /= n;
+        if (kind == PairKind::Random) {
+            pairs.push_back({ { a[0], a[1], a[2] }, { dist(gen), dist(gen), dist(gen) + 2 } });
+            continue;
+        }
+        if (kind == PairKind::Opposite) {
+            pairs.push_back({ { a[0], a[1], a[2] }, { -a[0], -a[1], -a[2] } });
+            continue;
+        }
+        // rotate a about an axis orthogonal to it
+        double u[3] = { -a[1], a[0], 0 };
+        const double un = std::sqrt(u[0] * u[0] + u[1] * u[1]);
+        for (double& c : u)
+            c /= un;
+        const double angle = std::pow(10.0, -1 - 6 * double(i) / 511);
+        const double ca = std::cos(angle), sa = std::sin(angle);
+        pairs.push_back({ { a[0], a[1], a[2] },
+            { a[0] * ca + u[0] * sa, a[1] * ca + u[1] * sa, a[2] * ca + u[2] * sa } });
+    }
+    return pairs;
+}
+
+} // namespace
+
+template <typename T>
+class AccuracyTestT : public ::testing::Test {
+public:
+};
+
+typedef ::testing::Types<float, double> AccuracyValueTypes;
+
+TYPED_TEST_SUITE(AccuracyTestT, AccuracyValueTypes);
+
+TYPED_TEST(AccuracyTestT, Normalized) {
+    typedef gszauer::TVec3<TypeParam> V3T;
+    typedef reference_t<TypeParam> R;
+
+    const std::vector<V3T> in = vectorSet<TypeParam>();
+    std::vector<V3T> out(in.size());
+    const double ns = nsPerItem(in.size(), [&] {
+        for (size_t i = 0; i < in.size(); ++i)
+            out[i] = gszauer::normalized(in[i]);
+    });
+
+    UlpStats stats;
+    for (size_t i = 0; i < in.size(); ++i) {
+        const Ref3<R> ref = refNormalized(toRef(in[i]));
+        stats.add(ulpError(out[i].v, ref.v, 3));
+    }
+    report("normalized", typeName<TypeParam>(), stats, ns);
+    EXPECT_LE(stats.max, 3.0);
+}
+
+TYPED_TEST(AccuracyTestT, Slerp) {
+    typedef gszauer::TVec3<TypeParam> V3T;
+    typedef reference_t<TypeParam> R;
+
+    for (PairKind kind : { PairKind::Random, PairKind::NearParallel, PairKind::Opposite }) {
+        const std::vector<Pair> pairs = slerpPairs(kind);
+        std::vector<V3T> s, e;
+        for (const Pair& p : pairs) {
+            s.emplace_back(TypeParam(p.s[0]), TypeParam(p.s[1]), TypeParam(p.s[2]));
+            e.emplace_back(TypeParam(p.e[0]), TypeParam(p.e[1]), TypeParam(p.e[2]));
+        }
+
+        // dense in t, including both ends
+        const int STEPS = 64;
+        std::vector<V3T> out(pairs.size() * (STEPS + 1));
+        const double ns = nsPerItem(out.size(), [&] {
+            for (size_t i = 0; i < pairs.size(); ++i)
+                for (int k = 0; k <= STEPS; ++k)
+                    out[i * (STEPS + 1) + k] = gszauer::slerp(s[i], e[i], float(k) / STEPS);
+        });
+
+        UlpStats stats;
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            for (int k = 0; k <= STEPS; ++k) {
+                const float t = float(k) / STEPS;
+                const Ref3<R> ref = refSlerp(toRef(s[i]), toRef(e[i]), R(t));
+                stats.add(ulpError(out[i * (STEPS + 1) + k].v, ref.v, 3));
+            }
+        }
+        report(kind == PairKind::Random ? "slerp" : kind == PairKind::NearParallel ? "slerp near-parallel"
+            : "slerp opposite", typeName<TypeParam>(), stats, ns);
+        EXPECT_LE(stats.max, 8.0);
+        EXPECT_LE(stats.mean(), 2.0);
+    }
+}
+
+TYPED_TEST(AccuracyTestT, Interpolate) {
+    typedef gszauer::TVec3<TypeParam> V3T;
+    typedef reference_t<TypeParam> R;
+
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> dist(-10, 10);
+    UlpStats stats;
+    double ns = 0;
+    for (int c = 0; c < 64; ++c) {
+        gszauer::Bezier<V3T> curve;
+        for (V3T* p : { &curve.P1, &curve.C1, &curve.C2, &curve.P2 })
+            *p = V3T(TypeParam(dist(gen)), TypeParam(dist(gen)), TypeParam(dist(gen)));
+
+        const int STEPS = 256;
+        std::vector<V3T> out(STEPS + 1);
+        ns += nsPerItem(out.size(), [&] {
+            for (int k = 0; k <= STEPS; ++k)
+                out[k] = gszauer::interpolate(curve, float(k) / STEPS);
+        });
+
+        for (int k = 0; k <= STEPS; ++k) {
+            R ref[3];
+            for (size_t i = 0; i < 3; ++i) {
+                const R p[4] = { R(curve.P1[i]), R(curve.C1[i]), R(curve.C2[i]), R(curve.P2[i]) };
+                ref[i] = refBezier(p, R(float(k) / STEPS));
+            }
+            stats.add(ulpError(out[k].v, ref, 3));
+        }
+    }
+    report("interpolate", typeName<TypeParam>(), stats, ns / 64);
+    EXPECT_LE(stats.max, 8.0);
+}
+
+TYPED_TEST(AccuracyTestT, Inverse) {
+    typedef el::details::TMat44<TypeParam> M44T;
+    typedef reference_t<TypeParam> R;
+
+    // rotation, non-uniform scale and translation: what the inverses see in
+    // practice and well conditioned enough for ulp counts to be meaningful
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> dist(-1, 1);
+    std::vector<M44T> in;
+    for (int i = 0; i < 1024; ++i) {
+        const double a = dist(gen) * PI, c = std::cos(a), s = std::sin(a);
+        const double sx = 1.5 + dist(gen), sy = 1.5 + dist(gen), sz = 1.5 + dist(gen);
+        in.push_back(M44T(
+            TypeParam(c * sx), TypeParam(s * sx), 0, 0,
+            TypeParam(-s * sy), TypeParam(c * sy), 0, 0,
+            0, 0, TypeParam(sz), 0,
+            TypeParam(dist(gen) * 10), TypeParam(dist(gen) * 10), TypeParam(dist(gen) * 10), 1));
+    }
+
+    auto check = [&](const char* name, M44T (*inv)(const M44T&)) {
+        std::vector<M44T> out(in.size());
+        const double ns = nsPerItem(in.size(), [&] {
+            for (size_t i = 0; i < in.size(); ++i)
+                out[i] = inv(in[i]);
+        });
+
+        // Gauss-Jordan with partial pivoting in the reference type
+        UlpStats stats;
+        for (size_t i = 0; i < in.size(); ++i) {
+            R a[4][8];
+            for (size_t r = 0; r < 4; ++r)
+                for (size_t c = 0; c < 4; ++c) {
+                    a[r][c] = R(in[i][c][r]);
+                    a[r][c + 4] = r == c ? 1 : 0;
+                }
+            for (size_t k = 0; k < 4; ++k) {
+                size_t p = k;
+                for (size_t r = k + 1; r < 4; ++r)
+                    if (std::fabs(a[r][k]) > std::fabs(a[p][k]))
+                        p = r;
+                std::swap(a[k], a[p]);
+                for (size_t r = 0; r < 4; ++r) {
+                    if (r == k)
+                        continue;
+                    const R f = a[r][k] / a[k][k];
+                    for (size_t c = k; c < 8; ++c)
+                        a[r][c] -= f * a[k][c];
+                }
+            }
+            for (size_t c = 0; c < 4; ++c) {
+                R ref[4];
+                TypeParam got[4];
+                for (size_t r = 0; r < 4; ++r) {
+                    ref[r] = a[r][c + 4] / a[r][r];
+                    got[r] = out[i][c][r];
+                }
+                stats.add(ulpError(got, ref, 4));
+            }
+        }
+        report(name, typeName<TypeParam>(), stats, ns);
+        EXPECT_LE(stats.max, 8.0);
+    };
+    check("inverse", el::details::inverse<TypeParam>);
+    check("affineInverse", el::details::affineInverse<TypeParam>);
+}
+
+// The dispatched float kernels, at every level this machine supports.
+class AccuracyTest : public testing::Test {
+protected:
+    void TearDown() override { el::setSimdLevel(el::bestSimdLevel()); }
+
+    template <typename F>
+    static void forEachLevel(F&& f) {
+        for (el::SimdLevel level : { el::SimdLevel::Baseline, el::SimdLevel::AVX2, el::SimdLevel::AVX512 }) {
+            if (level > el::bestSimdLevel())
+                break;
+            el::setSimdLevel(level);
+            f(el::toString(level));
+        }
+    }
+};
+
+TEST_F(AccuracyTest, NormalizeStream) {
+    const std::vector<vec3> in = vectorSet<float>();
+    gszauer::Vec3Stream s;
+    for (auto policy : { gszauer::NormalizePolicy::Precise, gszauer::NormalizePolicy::Fast }) {
+        const bool fast = policy == gszauer::NormalizePolicy::Fast;
+        forEachLevel([&](const char* level) {
+            gszauer::fromAoS(in, s);
+            gszauer::normalize(s, policy);
+
+            UlpStats stats;
+            for (size_t i = 0; i < in.size(); ++i) {
+                const Ref3<double> ref = refNormalized(toRef(in[i]));
+                const vec3 got = gszauer::get(s, i);
+                stats.add(ulpError(got.v, ref.v, 3));
+            }
+            // already unit length on every pass but the first; the kernels
+            // have no data dependent branches
+            const double ns = nsPerItem(s.size(), [&] { gszauer::normalize(s, policy); });
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "normalize %s %s", fast ? "fast" : "precise", level);
+            report(name, "float", stats, ns);
+            EXPECT_LE(stats.max, fast ? 4.0 : 3.0) << level;
+        });
+    }
+}
+
+TEST_F(AccuracyTest, InterpolateStream) {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> dist(-10, 10);
+    gszauer::Bezier<vec3> curve;
+    for (vec3* p : { &curve.P1, &curve.C1, &curve.C2, &curve.P2 })
+        *p = vec3(float(dist(gen)), float(dist(gen)), float(dist(gen)));
+
+    std::vector<float> t(4097);
+    for (size_t k = 0; k < t.size(); ++k)
+        t[k] = float(k) / float(t.size() - 1);
+
+    forEachLevel([&](const char* level) {
+        gszauer::Vec3Stream out;
+        const double ns = nsPerItem(t.size(), [&] { gszauer::interpolate(curve, t, out); });
+
+        UlpStats stats;
+        for (size_t k = 0; k < t.size(); ++k) {
+            double ref[3];
+            for (size_t i = 0; i < 3; ++i) {
+                const double p[4] = { curve.P1[i], curve.C1[i], curve.C2[i], curve.P2[i] };
+                ref[i] = refBezier(p, double(t[k]));
+            }
+            stats.add(ulpError(gszauer::get(out, k).v, ref, 3));
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "interpolate stream %s", level);
+        report(name, "float", stats, ns);
+        EXPECT_LE(stats.max, 4.0) << level;
+    });
+}
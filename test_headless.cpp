@@ -0,0 +1,717 @@
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "headless/SoftRenderer.h"
+#include "plot/FontAtlasCache.h"
+#include "plot/FrameArena.h"
+#include "plot/FrameScheduler.h"
+#include "plot/ImGuiGrid.h"
+#include "plot/Markers.h"
+#include "plot/ParallelSplitter.h"
+#include "plot/PlotCache.h"
+#include "plot/Plots.h"
+#include "profiler/Profiler.h"
+
+// An ImGui context at a fixed display size whose frames render into `target`.
+class HeadlessTest : public testing::Test {
+protected:
+    static constexpr int SIZE = 64;
+
+    void SetUp() override {
+        InstallFrameArena(ImGui::CreateContext());
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = NULL;
+        io.DisplaySize = ImVec2(float(SIZE), float(SIZE));
+        io.DeltaTime = 1.f / 60.f;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+        AddMarkerSprites(io.Fonts);
+        headless::createFontsTexture(*io.Fonts, fonts);
+        target = headless::Image(SIZE, SIZE);
+    }
+
+    void TearDown() override {
+        ImGui::DestroyContext();
+    }
+
+    void render() {
+        ImGui::Render();
+        headless::clear(target, ImVec4(0.f, 0.f, 0.f, 1.f));
+        headless::renderDrawData(*ImGui::GetDrawData(), target);
+    }
+
+    size_t count(ImU32 color) const {
+        return size_t(std::count(target.pixels.begin(), target.pixels.end(), color));
+    }
+
+    static constexpr ImU32 BLACK = IM_COL32(0, 0, 0, 255);
+    static constexpr ImU32 RED = IM_COL32(255, 0, 0, 255);
+
+    headless::Image fonts;
+    headless::Image target;
+};
+
+TEST_F(HeadlessTest, FilledRect) {
+    ImGui::NewFrame();
+    ImGui::GetForegroundDrawList()->AddRectFilled(ImVec2(8.f, 8.f), ImVec2(24.f, 20.f), RED);
+    render();
+
+    EXPECT_EQ(target.at(8, 8), RED);
+    EXPECT_EQ(target.at(23, 19), RED);
+    EXPECT_EQ(target.at(7, 8), BLACK);
+    EXPECT_EQ(target.at(24, 19), BLACK);
+    EXPECT_EQ(target.at(23, 20), BLACK);
+    EXPECT_EQ(count(RED), 16u * 12u);
+}
+
+TEST_F(HeadlessTest, TranslucentSeams) {
+    // the diagonal of the two triangles must not be blended twice
+    ImGui::NewFrame();
+    ImGui::GetForegroundDrawList()->AddRectFilled(ImVec2(0.f, 0.f), ImVec2(32.f, 32.f), IM_COL32(255, 0, 0, 128));
+    render();
+
+    const ImU32 half = target.at(20, 4);
+    EXPECT_NE(half, BLACK);
+    for (int i = 0; i < 32; ++i)
+        EXPECT_EQ(target.at(i, i), half) << i;
+    EXPECT_EQ(count(half), 32u * 32u);
+}
+
+TEST_F(HeadlessTest, ClipRect) {
+    ImGui::NewFrame();
+    ImDrawList* draw = ImGui::GetForegroundDrawList();
+    draw->PushClipRect(ImVec2(16.f, 16.f), ImVec2(32.f, 32.f));
+    draw->AddRectFilled(ImVec2(0.f, 0.f), ImVec2(64.f, 64.f), RED);
+    draw->PopClipRect();
+    render();
+
+    EXPECT_EQ(count(RED), 16u * 16u);
+    EXPECT_EQ(target.at(16, 16), RED);
+    EXPECT_EQ(target.at(15, 16), BLACK);
+    EXPECT_EQ(target.at(32, 31), BLACK);
+}
+
+TEST_F(HeadlessTest, Text) {
+    // glyphs sample the font atlas, so only some pixels of the text box are lit
+    ImGui::NewFrame();
+    ImGui::GetForegroundDrawList()->AddText(ImVec2(2.f, 2.f), IM_COL32_WHITE, "Curve");
+    render();
+
+    const size_t lit = SIZE * SIZE - count(BLACK);
+    EXPECT_GT(lit, 20u);
+    EXPECT_LT(lit, 5u * 7u * 13u);
+    EXPECT_EQ(target.at(2, 30), BLACK);
+}
+
+TEST_F(HeadlessTest, Plots) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(640.f, 480.f);
+    target = headless::Image(640, 480);
+
+    // the first frames lay the windows out
+    for (int frame = 0; frame < 3; ++frame) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(320.f, 20.f), ImGuiCond_FirstUseEver);
+        ShowBezierPlot();
+        ShowSlerpPlot();
+        render();
+    }
+
+    // the curve is solid magenta, the slerp points pink
+    EXPECT_GT(count(IM_COL32(255, 0, 255, 255)), 200u);
+    EXPECT_GT(count(IM_COL32(255, 0, 191, 255)), 30u);
+}
+
+TEST_F(HeadlessTest, Curve) {
+    ImGui::GetIO().DisplaySize = ImVec2(300.f, 300.f);
+    target = headless::Image(300, 300);
+
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = vec3(-5.f, 0.f, 0.f);
+    curve.C1 = vec3(-2.f, 4.f, 0.f);
+    curve.C2 = vec3(+2.f, -4.f, 0.f);
+    curve.P2 = vec3(+5.f, 0.f, 0.f);
+    const vec4 magenta(1.f, 0.f, 1.f, 1.f);
+    const int segments = 200;
+
+    // returns the vertex count and the curve's pixels
+    auto frame = [&](bool polyline) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("curve");
+        ImGuiGrid grid;
+        grid.mgmin = vec2(-5.f);
+        grid.mgmax = vec2(+5.f);
+        grid.drawGrid();
+        if (polyline) {
+            grid.drawCurve(curve, segments, magenta);
+        } else {
+            for (int i = 0; i < segments; i++)
+                grid.drawLine(interpolate(curve, float(i) / segments), interpolate(curve, float(i + 1) / segments), magenta);
+        }
+        ImGui::End();
+        render();
+        return std::make_pair(ImGui::GetDrawData()->TotalVtxCount, count(IM_COL32(255, 0, 255, 255)));
+    };
+
+    frame(false);
+    const auto lines = frame(false);
+    const auto polyline = frame(true);
+
+    // shared joints, two vertices per sample instead of four per segment
+    EXPECT_EQ(lines.first - polyline.first, 4 * segments - 2 * (segments + 1));
+    EXPECT_GT(polyline.second, 200u);
+    EXPECT_NEAR(double(polyline.second), double(lines.second), 0.1 * lines.second);
+}
+
+TEST_F(HeadlessTest, PlotCache) {
+    ImGui::GetIO().DisplaySize = ImVec2(300.f, 300.f);
+    target = headless::Image(300, 300);
+
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = vec3(-5.f, 0.f, 0.f);
+    curve.C1 = vec3(-2.f, 4.f, 0.f);
+    curve.C2 = vec3(+2.f, -4.f, 0.f);
+    curve.P2 = vec3(+5.f, 0.f, 0.f);
+
+    PlotCache cache;
+    int recorded = 0;
+    // the rendered image; `clip` adds a second draw command to the section
+    auto frame = [&](float extent, bool clip) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("cached");
+        ImGuiGrid grid;
+        grid.mgmax = vec2(extent);
+        grid.mgmin = vec2(-extent);
+        if (grid.layoutGrid() && cache.begin(ImGui::GetWindowDrawList(), ImHashData(&clip, 1, grid.cacheKey()))) {
+            ++recorded;
+            grid.drawBackground();
+            grid.drawCurve(curve, 100, vec4(1.f, 0.f, 1.f, 1.f));
+            if (clip) {
+                ImGui::PushClipRect(ImVec2(0.f, 0.f), ImVec2(100.f, 100.f), true);
+                ImGui::GetWindowDrawList()->AddLine(ImVec2(0.f, 0.f), ImVec2(100.f, 100.f), RED);
+                ImGui::PopClipRect();
+            }
+            cache.end();
+        }
+        ImGui::End();
+        render();
+        return target.pixels;
+    };
+
+    frame(5.f, false);
+    const auto drawn = frame(5.f, false);
+    const int before = recorded;
+    const auto replayed = frame(5.f, false);
+    EXPECT_EQ(recorded, before);
+    EXPECT_TRUE(cache.valid());
+    EXPECT_GT(cache.vertexCount(), 0);
+    EXPECT_TRUE(drawn == replayed);
+
+    // a new transform records again
+    frame(6.f, false);
+    EXPECT_EQ(recorded, before + 1);
+    frame(6.f, false);
+    EXPECT_EQ(recorded, before + 1);
+
+    // sections spanning draw commands are never retained
+    frame(6.f, true);
+    EXPECT_FALSE(cache.valid());
+    frame(6.f, true);
+    EXPECT_EQ(recorded, before + 3);
+}
+
+TEST_F(HeadlessTest, Series) {
+    ImGui::GetIO().DisplaySize = ImVec2(300.f, 300.f);
+    target = headless::Image(300, 300);
+
+    // a million flat samples and one spike, which plain subsampling would miss
+    const size_t count = size_t(1) << 20;
+    const size_t spike = 123457;
+    std::vector<float> x(count), y(count, 0.f);
+    for (size_t i = 0; i < count; ++i)
+        x[i] = float(i);
+    y[spike] = 4.f;
+    const SeriesPyramid series(x, y);
+
+    // returns the vertex count; top is the spike's and highest the topmost
+    // vertex's screen y
+    float top = 0.f, highest = 0.f, spikeX = 0.f;
+    auto frame = [&](float from, float to) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("series");
+        ImGuiGrid grid;
+        grid.mgmin = vec2(from, -5.f);
+        grid.mgmax = vec2(to, +5.f);
+        const int before = ImGui::GetWindowDrawList()->VtxBuffer.Size;
+        int vertices = 0;
+        if (grid.layoutGrid()) {
+            top = grid.scalePosition(vec2(float(spike), 4.f)).y;
+            spikeX = grid.scalePosition(vec2(float(spike), 4.f)).x;
+            grid.drawSeries(series, vec4(1.f, 0.f, 0.f, 1.f));
+            const ImVector<ImDrawVert>& vtx = ImGui::GetWindowDrawList()->VtxBuffer;
+            vertices = vtx.Size - before;
+            highest = FLT_MAX;
+            for (int i = before; i < vtx.Size; ++i)
+                highest = std::min(highest, vtx[i].pos.y);
+        }
+        ImGui::End();
+        render();
+        return vertices;
+    };
+
+    frame(0.f, float(count));
+    const int all = frame(0.f, float(count));
+    // two per column edge
+    EXPECT_GT(all, 0);
+    EXPECT_LE(all, 2 * (ImGuiGrid::AREA_WIDTH + 1));
+
+    // the envelope reaches the top of the spike
+    EXPECT_NEAR(highest, top, 1.f);
+    EXPECT_EQ(target.at(int(spikeX), int(top) + 2), RED);
+
+    // zoomed in to a few samples they are drawn as they are
+    EXPECT_EQ(frame(float(spike) - 10.f, float(spike) + 10.f), 2 * 21);
+}
+
+TEST_F(HeadlessTest, Markers) {
+    ImGui::GetIO().DisplaySize = ImVec2(300.f, 300.f);
+    target = headless::Image(300, 300);
+
+    // returns the vertex count of what draw adds to the window
+    auto frame = [&](auto draw) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("markers", NULL, ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoDecoration);
+        ImGuiGrid grid;
+        ImDrawList* DrawList = ImGui::GetWindowDrawList();
+        const int before = DrawList->VtxBuffer.Size;
+        if (grid.layoutGrid())
+            draw(grid, DrawList);
+        const int vertices = DrawList->VtxBuffer.Size - before;
+        ImGui::End();
+        render();
+        return vertices;
+    };
+    const vec4 red(1.f, 0.f, 0.f, 1.f);
+    const vec2 center[] = { vec2(0.5f) };
+
+    frame([](ImGuiGrid&, ImDrawList*) {});
+    ASSERT_NE(FindMarkerSprite(5.f), nullptr);
+    EXPECT_EQ(FindMarkerSprite(float(MARKER_MAX_RADIUS + 1)), nullptr);
+
+    // a quad per marker, two for a grab handle
+    ImVec2 pos;
+    EXPECT_EQ(frame([&](ImGuiGrid& grid, ImDrawList*) {
+        grid.drawPoints(center, red, 5.f);
+        pos = grid.scalePosition(center[0]);
+    }), 4);
+    EXPECT_EQ(target.at(int(pos.x), int(pos.y)), RED);
+    const size_t sprite = count(RED);
+    EXPECT_EQ(frame([&](ImGuiGrid& grid, ImDrawList*) { grid.drawPoint(center[0], red); }), 8);
+
+    // covers about what the tessellated circle does
+    frame([&](ImGuiGrid&, ImDrawList* DrawList) {
+        DrawList->AddCircleFilled(pos, 5.f, RED);
+    });
+    EXPECT_NEAR(double(sprite), double(count(RED)), 0.15 * double(count(RED)));
+    EXPECT_NEAR(double(sprite), 3.14159 * 5 * 5, 20.);
+
+    // a scatter plot's worth, split across vertex offsets for 16 bit indices
+    std::vector<vec2> points(100000);
+    for (size_t i = 0; i < points.size(); ++i)
+        points[i] = vec2(float(i % 317) / 317.f, float(i % 331) / 331.f);
+    unsigned int offset = 0;
+    EXPECT_EQ(frame([&](ImGuiGrid& grid, ImDrawList* DrawList) {
+        grid.drawPoints(points, red, 1.f);
+        offset = DrawList->_CmdHeader.VtxOffset;
+    }), 4 * 100000);
+    EXPECT_GT(offset, 0u);
+}
+
+TEST_F(HeadlessTest, ParallelCurves) {
+    ImGui::GetIO().DisplaySize = ImVec2(300.f, 300.f);
+    target = headless::Image(300, 300);
+
+    std::vector<gszauer::Bezier<vec3>> curves(4 * ImGuiGrid::CURVE_GRAIN);
+    for (size_t i = 0; i < curves.size(); ++i) {
+        const float y = float(i) / float(curves.size());
+        curves[i].P1 = vec3(0.f, y, 0.f);
+        curves[i].C1 = vec3(0.3f, 1.f - y, 0.f);
+        curves[i].C2 = vec3(0.6f, y, 0.f);
+        curves[i].P2 = vec3(1.f, 1.f - y, 0.f);
+    }
+
+    // the triangles of the window, every index resolved to its vertex
+    ParallelSplitter splitter;
+    int commands = 0;
+    auto frame = [&](int segments, size_t threads) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("curves", NULL, ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoDecoration);
+        ImDrawList* DrawList = ImGui::GetWindowDrawList();
+        const int cmdStart = DrawList->CmdBuffer.Size;
+        ImGuiGrid grid;
+        if (grid.layoutGrid())
+            grid.drawCurves(curves, segments, vec4(1.f, 0.f, 0.f, 0.5f), splitter, threads);
+        commands = DrawList->CmdBuffer.Size - cmdStart;
+        // something drawn after the merge lands after the curves
+        DrawList->AddRectFilled(ImVec2(280.f, 280.f), ImVec2(284.f, 284.f), RED);
+        std::vector<float> triangles;
+        for (const ImDrawCmd& cmd : DrawList->CmdBuffer)
+            for (unsigned int k = 0; k < cmd.ElemCount; ++k) {
+                const ImDrawVert& v = DrawList->VtxBuffer[cmd.VtxOffset + DrawList->IdxBuffer[cmd.IdxOffset + k]];
+                triangles.insert(triangles.end(), { v.pos.x, v.pos.y, float(v.col) });
+            }
+        ImGui::End();
+        render();
+        return triangles;
+    };
+
+    frame(16, 1);
+    const std::vector<float> serial = frame(16, 1);
+    const std::vector<uint32_t> image = target.pixels;
+    EXPECT_EQ(frame(16, 4), serial);
+    EXPECT_EQ(target.pixels, image);
+    // rebased into the window's current command
+    EXPECT_LE(commands, 1);
+
+    // channels past 16 bit indices, merged under vertex offsets of their own
+    const std::vector<float> large = frame(1000, 1);
+    const std::vector<uint32_t> largeImage = target.pixels;
+    EXPECT_EQ(frame(1000, 4), large);
+    EXPECT_EQ(target.pixels, largeImage);
+    EXPECT_GT(commands, 1);
+    EXPECT_EQ(target.at(282, 282), RED);
+
+    // Workers must not allocate through ImGui, whose counters take no lock,
+    // even on the first frame of a splitter. The pool keeps its threads, so
+    // the profiler doesn't register new ones frame after frame either.
+    static std::thread::id main;
+    static std::atomic<int> foreign;
+    main = std::this_thread::get_id();
+    foreign = 0;
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void*) {
+            if (std::this_thread::get_id() != main)
+                foreign++;
+            return malloc(size);
+        },
+        [](void* ptr, void*) { free(ptr); });
+    const size_t threads = profiler::threads().size();
+    for (int segments : { 16, 1000, 2000 }) {
+        splitter.clearFreeMemory();
+        frame(segments, 4);
+    }
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void*) { return malloc(size); },
+        [](void* ptr, void*) { free(ptr); });
+    EXPECT_EQ(foreign, 0);
+    EXPECT_EQ(profiler::threads().size(), threads);
+}
+
+TEST_F(HeadlessTest, FrameArena) {
+    ImGui::GetIO().DisplaySize = ImVec2(640.f, 480.f);
+    target = headless::Image(640, 480);
+
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = vec3(0.f, 0.f, 0.f);
+    curve.C1 = vec3(0.f, 1.f, 0.f);
+    curve.C2 = vec3(1.f, 1.f, 0.f);
+    curve.P2 = vec3(1.f, 0.f, 0.f);
+
+    // NewFrame() resets the arena, ImGuiGrid takes its scratch from it
+    size_t heap = 0;
+    for (int frame = 0; frame < 4; ++frame) {
+        ImGui::NewFrame();
+        EXPECT_EQ(frameArena().used(), 0u);
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::Begin("arena");
+        ImGuiGrid grid;
+        if (grid.layoutGrid())
+            grid.drawCurve(curve, 100000, vec4(1.f));
+        ImGui::End();
+        if (frame > 0) {
+            EXPECT_GE(frameArena().used(), 100000u * 4 * sizeof(float));
+        }
+        render();
+        // steady once the windows are laid out
+        if (frame == 2)
+            heap = frameArena().heapAllocations();
+    }
+    EXPECT_EQ(frameArena().heapAllocations(), heap);
+    EXPECT_GE(frameArena().peak(), frameArena().lastFrame());
+}
+
+TEST_F(HeadlessTest, DragPoint) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(300.f, 300.f);
+
+    vec3 p(0.f, 0.f, 0.f);
+    ImVec2 center, min, max;
+    bool moved = false;
+    auto frame = [&] {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::SetNextWindowSize(ImVec2(300.f, 300.f));
+        ImGui::Begin("drag");
+        ImGuiGrid grid;
+        grid.mgmin = vec2(-5.f);
+        grid.mgmax = vec2(+5.f);
+        if (grid.layoutGrid()) {
+            moved = grid.dragPoint(0, p);
+            grid.drawHandle(0, p, vec4(1.f, 0.f, 0.f, 1.f));
+            center = grid.scalePosition(vec2(p));
+            min = grid.mbb.Min;
+            max = grid.mbb.Max;
+        }
+        ImGui::End();
+        render();
+    };
+
+    io.MousePos = ImVec2(-1.f, -1.f);
+    frame();
+    frame();
+    const ImVec2 start = center;
+    const float scale = (max.x - min.x) / 10.f;
+
+    // grabbed off center, the handle keeps that offset while dragged
+    io.MousePos = ImVec2(start.x + 3.f, start.y + 2.f);
+    frame();
+    io.MouseDown[0] = true;
+    frame();
+    EXPECT_FALSE(moved);
+    EXPECT_TRUE(ImGui::IsAnyItemActive());
+    // ImGui floors the mouse position
+    const float dx = std::floor(2.f * scale), dy = std::floor(scale);
+    io.MousePos = ImVec2(io.MousePos.x + dx, io.MousePos.y - dy);
+    frame();
+    EXPECT_TRUE(moved);
+    EXPECT_NEAR(p.x, dx / scale, 1e-4f);
+    EXPECT_NEAR(p.y, dy / scale, 1e-4f);
+
+    // held still it stays put, and it can't leave the area
+    frame();
+    EXPECT_FALSE(moved);
+    io.MousePos = ImVec2(1000.f, 1000.f);
+    frame();
+    EXPECT_NEAR(p.x, 5.f, 1e-4f);
+    EXPECT_NEAR(p.y, -5.f, 1e-4f);
+
+    // released it no longer follows the mouse
+    io.MouseDown[0] = false;
+    frame();
+    io.MousePos = start;
+    frame();
+    EXPECT_FALSE(moved);
+    EXPECT_NEAR(p.x, 5.f, 1e-4f);
+}
+
+TEST_F(HeadlessTest, FrameScheduler) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(200.f, 200.f);
+    io.MousePos = ImVec2(150.f, 150.f);
+    FrameScheduler scheduler;
+
+    // a window with a button under (30, 30) once laid out
+    auto frame = [&] {
+        scheduler.beginFrame(io);
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
+        ImGui::Begin("idle", NULL, ImGuiWindowFlags_NoTitleBar);
+        ImGui::Button("button", ImVec2(60.f, 60.f));
+        ImGui::End();
+        ImGui::Render();
+        scheduler.endFrame(io);
+    };
+    // polls the scheduler the way the main loop does, returns the frames drawn
+    auto run = [&](int polls) {
+        const uint64_t drawn = scheduler.framesDrawn();
+        for (int i = 0; i < polls; ++i)
+            if (scheduler.frameDue(io))
+                frame();
+        return int(scheduler.framesDrawn() - drawn);
+    };
+
+    // the first frame and the settling ones after it, then nothing
+    EXPECT_EQ(run(10), 1 + FrameScheduler::SETTLE_FRAMES);
+    EXPECT_FALSE(scheduler.frameDue(io));
+    EXPECT_EQ(scheduler.timeout(), UINT64_MAX);
+    EXPECT_EQ(run(10), 0);
+    EXPECT_GE(scheduler.framesSkipped(), 10u);
+
+    // input changes draw again
+    io.MousePos = ImVec2(30.f, 30.f);
+    EXPECT_EQ(run(10), 1 + FrameScheduler::SETTLE_FRAMES);
+    io.AddInputCharacter('a');
+    EXPECT_EQ(run(10), 1 + FrameScheduler::SETTLE_FRAMES);
+    io.MouseWheel = 1.f;
+    EXPECT_EQ(run(10), 1 + FrameScheduler::SETTLE_FRAMES);
+    EXPECT_EQ(io.MouseWheel, 0.f);
+
+    scheduler.wake();
+    EXPECT_EQ(scheduler.timeout(), 0u);
+    EXPECT_EQ(run(10), 1 + FrameScheduler::SETTLE_FRAMES);
+
+    // requested frames come due on time, one per request
+    scheduler.requestFrame();
+    EXPECT_EQ(run(10), 1);
+    scheduler.requestFrame(60.0);
+    EXPECT_EQ(run(10), 0);
+    EXPECT_GT(scheduler.timeout(), uint64_t(59e9));
+    EXPECT_LE(scheduler.timeout(), uint64_t(60e9));
+    scheduler.requestFrame(0.001);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    EXPECT_EQ(run(10), 1);
+
+    // the button held down draws every poll
+    io.MouseDown[0] = true;
+    EXPECT_EQ(run(10), 10);
+    EXPECT_TRUE(ImGui::IsAnyItemActive());
+    io.MouseDown[0] = false;
+    run(10);
+    EXPECT_FALSE(ImGui::IsAnyItemActive());
+    EXPECT_EQ(run(10), 0);
+
+    // the frames after an idle stretch see the time it took
+    io.MousePos = ImVec2(150.f, 150.f);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(scheduler.frameDue(io));
+    frame();
+    EXPECT_GE(io.DeltaTime, 0.02f);
+
+    // disabled it draws every poll
+    scheduler.setEnabled(false);
+    EXPECT_EQ(run(10), 10);
+}
+
+TEST_F(HeadlessTest, WriteImage) {
+    ImGui::NewFrame();
+    ImGui::GetForegroundDrawList()->AddRectFilled(ImVec2(0.f, 0.f), ImVec2(1.f, 1.f), RED);
+    render();
+
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string png = (dir / "headless_test.png").string();
+    const std::string ppm = (dir / "headless_test.ppm").string();
+    ASSERT_TRUE(headless::writeImage(png, target));
+    ASSERT_TRUE(headless::writeImage(ppm, target));
+
+    // stored blocks: signature, IHDR, zlib header, one block per 64 KiB, adler, IDAT and IEND
+    const size_t raw = size_t(SIZE) * (SIZE * 4 + 1);
+    EXPECT_EQ(std::filesystem::file_size(png), 8u + 25u + 12u + 2u + 5u + raw + 4u + 12u);
+    EXPECT_EQ(std::filesystem::file_size(ppm), 13u + size_t(SIZE) * SIZE * 3);
+
+    char header[24];
+    std::ifstream file(png, std::ios::binary);
+    file.read(header, sizeof(header));
+    EXPECT_EQ(std::string(header + 1, 3), "PNG");
+    EXPECT_EQ(std::string(header + 12, 4), "IHDR");
+    EXPECT_EQ(uint8_t(header[19]), SIZE);  // big endian width
+    EXPECT_EQ(uint8_t(header[23]), SIZE);
+
+    std::ifstream image(ppm, std::ios::binary);
+    std::string magic;
+    int w = 0, h = 0, depth = 0;
+    image >> magic >> w >> h >> depth;
+    image.get();
+    char first[3];
+    image.read(first, 3);
+    EXPECT_EQ(magic, "P6");
+    EXPECT_EQ(w, SIZE);
+    EXPECT_EQ(h, SIZE);
+    EXPECT_EQ(uint8_t(first[0]), 255);
+    EXPECT_EQ(uint8_t(first[1]), 0);
+
+    file.close();
+    image.close();
+    std::filesystem::remove(png);
+    std::filesystem::remove(ppm);
+}
+
+TEST(FontAtlasCacheTest, RoundTrip) {
+    const std::string path = (std::filesystem::temp_directory_path() / "font_atlas_test.bin").string();
+    std::filesystem::remove(path);
+
+    // a custom rect the paint callback fills, cached along with the glyphs
+    auto setup = [](ImFontAtlas& atlas, float size) {
+        ImFontConfig config;
+        config.SizePixels = size;
+        atlas.AddFontDefault(&config);
+        return atlas.AddCustomRectRegular(5, 7);
+    };
+    static int rect = -1;
+    auto paint = [](ImFontAtlas* atlas) {
+        const ImFontAtlasCustomRect* r = atlas->GetCustomRectByIndex(rect);
+        for (int y = 0; y < r->Height; ++y)
+            for (int x = 0; x < r->Width; ++x)
+                atlas->TexPixelsRGBA32[(r->Y + y) * atlas->TexWidth + r->X + x] = IM_COL32(0, 255, 0, 255);
+    };
+
+    ImFontAtlas built;
+    rect = setup(built, 13.f);
+    EXPECT_FALSE(LoadOrBuildFontAtlas(&built, path.c_str(), paint));
+    ASSERT_TRUE(std::filesystem::exists(path));
+
+    ImFontAtlas loaded;
+    EXPECT_EQ(setup(loaded, 13.f), rect);
+    EXPECT_TRUE(LoadOrBuildFontAtlas(&loaded, path.c_str(), paint));
+
+    // the same texture, rects and glyph tables as the build
+    ASSERT_TRUE(loaded.IsBuilt());
+    ASSERT_EQ(loaded.TexWidth, built.TexWidth);
+    ASSERT_EQ(loaded.TexHeight, built.TexHeight);
+    EXPECT_EQ(memcmp(loaded.TexPixelsRGBA32, built.TexPixelsRGBA32, size_t(built.TexWidth) * built.TexHeight * 4), 0);
+    EXPECT_EQ(loaded.TexUvWhitePixel.x, built.TexUvWhitePixel.x);
+    EXPECT_EQ(loaded.TexUvWhitePixel.y, built.TexUvWhitePixel.y);
+    EXPECT_EQ(memcmp(loaded.TexUvLines, built.TexUvLines, sizeof(built.TexUvLines)), 0);
+    ASSERT_EQ(loaded.CustomRects.Size, built.CustomRects.Size);
+    for (int i = 0; i < built.CustomRects.Size; ++i) {
+        EXPECT_EQ(loaded.CustomRects[i].X, built.CustomRects[i].X);
+        EXPECT_EQ(loaded.CustomRects[i].Y, built.CustomRects[i].Y);
+    }
+    EXPECT_EQ(loaded.PackIdMouseCursors, built.PackIdMouseCursors);
+    EXPECT_EQ(loaded.PackIdLines, built.PackIdLines);
+
+    const ImFont* a = built.Fonts[0];
+    const ImFont* b = loaded.Fonts[0];
+    ASSERT_EQ(b->Glyphs.Size, a->Glyphs.Size);
+    EXPECT_EQ(memcmp(b->Glyphs.Data, a->Glyphs.Data, size_t(a->Glyphs.Size) * sizeof(ImFontGlyph)), 0);
+    EXPECT_EQ(b->IndexAdvanceX.Size, a->IndexAdvanceX.Size);
+    EXPECT_EQ(b->FallbackGlyph->Codepoint, a->FallbackGlyph->Codepoint);
+    EXPECT_EQ(b->FontSize, a->FontSize);
+    EXPECT_EQ(b->Ascent, a->Ascent);
+    EXPECT_EQ(b->EllipsisChar, a->EllipsisChar);
+    const char* text = "Cached\tglyphs?";
+    EXPECT_EQ(b->CalcTextSizeA(13.f, FLT_MAX, 0.f, text).x, a->CalcTextSizeA(13.f, FLT_MAX, 0.f, text).x);
+
+    // another font size misses and replaces the file
+    ImFontAtlas larger;
+    rect = setup(larger, 20.f);
+    EXPECT_FALSE(LoadOrBuildFontAtlas(&larger, path.c_str(), paint));
+    ImFontAtlas again;
+    rect = setup(again, 20.f);
+    EXPECT_TRUE(LoadOrBuildFontAtlas(&again, path.c_str(), paint));
+
+    // a truncated file is rebuilt
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    ImFontAtlas truncated;
+    rect = setup(truncated, 20.f);
+    EXPECT_FALSE(LoadOrBuildFontAtlas(&truncated, path.c_str(), paint));
+    EXPECT_EQ(truncated.TexWidth, again.TexWidth);
+
+    std::filesystem::remove(path);
+}
@@ -1,8 +1,34 @@
 #include <math.h>
+#include <random>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "gszauer/Mat4.h"
 
+namespace {
+
+mat4 randomMat4(std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+    mat4 m;
+    for (size_t i = 0; i < 16; i++)
+        m.v[i] = dist(gen);
+    return m;
+}
+
+// plain triple loop, column-major: r[c][i] = sum_k a[k][i] * b[c][k]
+mat4 referenceMultiply(const mat4& a, const mat4& b)
+{
+    mat4 r(0.f);
+    for (size_t c = 0; c < 4; c++)
+        for (size_t i = 0; i < 4; i++)
+            for (size_t k = 0; k < 4; k++)
+                r[c][i] += a[k][i] * b[c][k];
+    return r;
+}
+
+} // namespace
+
 class MatTest : public testing::Test {
 };
 
@@ -35,3 +61,161 @@ TEST_F(MatTest, ArithmeticOps) {
     EXPECT_EQ(mat4(4), m1);
 #endif
 }
+
+TEST_F(MatTest, Multiply) {
+    const mat4 t(
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        5, 6, 7, 1);
+    const mat4 s(float4(2, 3, 4, 1));
+
+    // scale first, then translate
+    mat4 ts = t * s;
+    EXPECT_EQ(mat4(
+        2, 0, 0, 0,
+        0, 3, 0, 0,
+        0, 0, 4, 0,
+        5, 6, 7, 1), ts);
+
+    mat4 id;
+    EXPECT_EQ(ts, ts * id);
+    EXPECT_EQ(ts, id * ts);
+
+    std::mt19937 gen(42);
+    for (int i = 0; i < 100; i++) {
+        mat4 a = randomMat4(gen);
+        mat4 b = randomMat4(gen);
+        mat4 expected = referenceMultiply(a, b);
+        mat4 actual = a * b;
+        for (size_t k = 0; k < 16; k++)
+            EXPECT_NEAR(expected.v[k], actual.v[k], 1e-3f);
+
+        a *= b;
+        EXPECT_EQ(actual, a);
+    }
+}
+
+TEST_F(MatTest, MultiplyVector) {
+    const mat4 t(
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        5, 6, 7, 1);
+
+    vec4 p = t * vec4(1, 2, 3, 1);
+    EXPECT_FLOAT_EQ(p.x, 6);
+    EXPECT_FLOAT_EQ(p.y, 8);
+    EXPECT_FLOAT_EQ(p.z, 10);
+    EXPECT_FLOAT_EQ(p.w, 1);
+
+    // directions ignore the translation
+    vec4 d = t *= vec4(1, 2, 3, 0);
+    EXPECT_FLOAT_EQ(d.x, 1);
+    EXPECT_FLOAT_EQ(d.y, 2);
+    EXPECT_FLOAT_EQ(d.z, 3);
+    EXPECT_FLOAT_EQ(d.w, 0);
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+    for (int i = 0; i < 100; i++) {
+        mat4 m = randomMat4(gen);
+        vec4 v(dist(gen), dist(gen), dist(gen), dist(gen));
+        vec4 r = m * v;
+        for (size_t row = 0; row < 4; row++) {
+            float expected = 0;
+            for (size_t k = 0; k < 4; k++)
+                expected += m[k][row] * v[k];
+            EXPECT_NEAR(expected, r[row], 1e-3f);
+        }
+    }
+}
+
+TEST_F(MatTest, TransformPoints) {
+    const mat4 m(
+        0, 2, 0, 0,
+        -1, 0, 0, 0,
+        0, 0, 3, 0,
+        1, -2, 3, 1);
+
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    for (size_t count : { 0, 1, 7, 64, 50001 }) {
+        std::vector<vec3> in(count), points(count), vectors(count);
+        std::vector<float> x(count), y(count), z(count);
+        for (size_t i = 0; i < count; i++) {
+            in[i] = vec3(dist(gen), dist(gen), dist(gen));
+            x[i] = in[i].x;
+            y[i] = in[i].y;
+            z[i] = in[i].z;
+        }
+
+        gszauer::transformPoints(m, in.data(), points.data(), count, 0);
+        gszauer::transformVectors(m, in.data(), vectors.data(), count);
+        gszauer::transformPoints(m, x.data(), y.data(), z.data(),
+            x.data(), y.data(), z.data(), count, 3);
+
+        for (size_t i = 0; i < count; i++) {
+            vec4 p = m * vec4(in[i].x, in[i].y, in[i].z, 1.f);
+            vec4 v = m * vec4(in[i].x, in[i].y, in[i].z, 0.f);
+            for (size_t k = 0; k < 3; k++) {
+                EXPECT_NEAR(p[k], points[i][k], 1e-3f);
+                EXPECT_NEAR(v[k], vectors[i][k], 1e-3f);
+            }
+            EXPECT_NEAR(p.x, x[i], 1e-3f);
+            EXPECT_NEAR(p.y, y[i], 1e-3f);
+            EXPECT_NEAR(p.z, z[i], 1e-3f);
+        }
+    }
+}
+
+TEST_F(MatTest, Inverse) {
+    const mat4 id;
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    for (int i = 0; i < 100; i++) {
+        mat4 m = randomMat4(gen);
+        for (size_t c = 0; c < 4; c++)
+            m[c][c] += 40.f;
+
+        mat4 mi = inverse(m);
+        EXPECT_EQ(id, referenceMultiply(m, mi));
+        EXPECT_NEAR(1.f, determinant(m) * determinant(mi), 1e-4f);
+
+        mat4 a = m;
+        a[0][3] = a[1][3] = a[2][3] = 0.f;
+        a[3][3] = 1.f;
+        mat4 ai = affineInverse(a);
+        for (size_t k = 0; k < 16; k++)
+            EXPECT_NEAR(id.v[k], (a * ai).v[k], 1e-5f);
+    }
+
+    // 90 degrees about z, then translate
+    const mat4 rigid(
+        0, 1, 0, 0,
+        -1, 0, 0, 0,
+        0, 0, 1, 0,
+        3, 4, 5, 1);
+    EXPECT_EQ(id, rigid * rigidInverse(rigid));
+    EXPECT_EQ(inverse(rigid), rigidInverse(rigid));
+
+    std::vector<mat4> batch(100, rigid), out(batch.size());
+    rigidInverse(batch.data(), out.data(), batch.size(), 2);
+    inverse(batch.data(), batch.data(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++)
+        EXPECT_EQ(batch[i], out[i]);
+}
+
+TEST_F(MatTest, Determinant) {
+    EXPECT_FLOAT_EQ(1.f, determinant(mat4()));
+    EXPECT_FLOAT_EQ(24.f, determinant(mat4(float4(1, 2, 3, 4))));
+
+    // swapping two columns flips the sign
+    mat4 m(
+        2, 0, 0, 0,
+        0, 0, 3, 0,
+        0, 5, 0, 0,
+        1, 1, 1, 1);
+    EXPECT_FLOAT_EQ(-30.f, determinant(m));
+}
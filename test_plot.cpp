@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "plot/BezierSpline.h"
+#include "plot/FrameArena.h"
+#include "plot/SeriesPyramid.h"
+#include "plot/WorkerPool.h"
+
+TEST(SeriesPyramidTest, Range) {
+    // odd length so every level ends in a partial block
+    const size_t count = 1000 + 37;
+    std::vector<float> x(count), y(count);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = float(i);
+        y[i] = dist(gen);
+    }
+    const SeriesPyramid series(x, y);
+
+    std::uniform_int_distribution<size_t> index(0, count - 1);
+    for (int n = 0; n < 2000; ++n) {
+        size_t begin = index(gen), end = index(gen) + 1;
+        if (begin >= end)
+            std::swap(begin, end);
+        if (begin == end)
+            continue;
+        const auto r = series.range(begin, end);
+        EXPECT_EQ(r.min, *std::min_element(y.begin() + begin, y.begin() + end)) << begin << " " << end;
+        EXPECT_EQ(r.max, *std::max_element(y.begin() + begin, y.begin() + end)) << begin << " " << end;
+    }
+
+    const auto all = series.range(0, count);
+    EXPECT_EQ(all.min, *std::min_element(y.begin(), y.end()));
+    EXPECT_EQ(all.max, *std::max_element(y.begin(), y.end()));
+    EXPECT_EQ(series.range(count - 1, count).min, y.back());
+}
+
+TEST(SeriesPyramidTest, LowerBound) {
+    const float x[] = { 0.f, 1.f, 1.f, 2.f, 5.f };
+    const float y[] = { 0.f, 0.f, 0.f, 0.f, 0.f };
+    const SeriesPyramid series(x, y);
+
+    EXPECT_EQ(series.lowerBound(-1.f), 0u);
+    EXPECT_EQ(series.lowerBound(1.f), 1u);
+    EXPECT_EQ(series.lowerBound(1.5f), 3u);
+    EXPECT_EQ(series.lowerBound(6.f), 5u);
+}
+
+TEST(FrameArenaTest, Allocate) {
+    FrameArena arena(1024);
+    EXPECT_EQ(arena.used(), 0u);
+
+    const std::span<float> a = arena.allocate<float>(3);
+    const std::span<double> b = arena.allocate<double>(5, 32);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a.data()) % alignof(float), 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data()) % 32, 0u);
+    EXPECT_GE(reinterpret_cast<const char*>(b.data()), reinterpret_cast<const char*>(a.data() + 3));
+    EXPECT_GE(arena.used(), 3 * sizeof(float) + 5 * sizeof(double));
+    EXPECT_EQ(arena.heapAllocations(), 1u);
+
+    // the same memory again after a reset
+    const size_t used = arena.used();
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.lastFrame(), used);
+    EXPECT_EQ(arena.allocate<float>(3).data(), a.data());
+}
+
+TEST(FrameArenaTest, Grow) {
+    FrameArena arena(1024);
+
+    // outgrowing the block chains more, the reset folds them into one
+    for (int i = 0; i < 10; ++i)
+        arena.allocate<char>(700);
+    EXPECT_GE(arena.used(), 7000u);
+    EXPECT_GT(arena.heapAllocations(), 2u);
+    arena.reset();
+    EXPECT_GE(arena.peak(), 7000u);
+    EXPECT_GE(arena.capacity(), arena.peak());
+
+    // after which the same frame fits without the heap
+    const size_t heap = arena.heapAllocations();
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int i = 0; i < 10; ++i)
+            arena.allocate<char>(700);
+        arena.reset();
+    }
+    EXPECT_EQ(arena.heapAllocations(), heap);
+
+    // larger than a block
+    EXPECT_NE(arena.allocate<char>(1 << 20).data(), nullptr);
+}
+
+TEST(FrameArenaTest, Threads) {
+    FrameArena arena(4096);
+
+    // every thread fills its allocations with its own value; overlapping
+    // ones would overwrite each other
+    const int threads = 4, count = 2000;
+    std::vector<std::vector<std::span<int>>> spans(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < count; ++i) {
+                const std::span<int> s = arena.allocate<int>(size_t(1 + i % 7));
+                std::fill(s.begin(), s.end(), t);
+                spans[size_t(t)].push_back(s);
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    for (int t = 0; t < threads; ++t)
+        for (const std::span<int>& s : spans[size_t(t)])
+            EXPECT_EQ(std::count(s.begin(), s.end(), t), std::ptrdiff_t(s.size()));
+}
+
+TEST(WorkerPoolTest, Run) {
+    WorkerPool pool;
+    std::vector<std::atomic<int>> runs(8);
+    pool.run(runs.size(), [&](size_t i) { runs[i]++; });
+    for (const std::atomic<int>& r : runs)
+        EXPECT_EQ(r.load(), 1);
+    EXPECT_EQ(pool.size(), runs.size() - 1);
+
+    // the workers are kept, smaller runs leave some of them asleep
+    for (int k = 0; k < 100; ++k)
+        pool.run(3, [&](size_t i) { runs[i]++; });
+    EXPECT_EQ(runs[0].load(), 101);
+    EXPECT_EQ(runs[2].load(), 101);
+    EXPECT_EQ(runs[3].load(), 1);
+    EXPECT_EQ(pool.size(), runs.size() - 1);
+
+    pool.run(1, [&](size_t i) { runs[i]++; });
+    pool.run(0, [&](size_t i) { runs[i]++; });
+    EXPECT_EQ(runs[0].load(), 102);
+}
+
+TEST(BezierSplineTest, Incremental) {
+    std::vector<vec3> points;
+    for (int i = 0; i < 13; ++i)
+        points.push_back(vec3(float(i), float(i % 3), 0.f));
+    BezierSpline spline(points, 10);
+    ASSERT_EQ(spline.segmentCount(), 4u);
+    ASSERT_EQ(spline.samples().size(), 41u);
+    EXPECT_EQ(spline.tessellate(), 4u);
+    EXPECT_EQ(spline.tessellate(), 0u);
+
+    // a control shapes its own segment, an inner anchor the two meeting at it
+    auto move = [&](size_t i, vec3 p) {
+        points[i] = p;
+        spline.setPoint(i, p);
+        return spline.tessellate();
+    };
+    EXPECT_EQ(move(4, vec3(4.f, 5.f, 0.f)), 1u);
+    EXPECT_EQ(move(5, vec3(5.f, -5.f, 0.f)), 1u);
+    EXPECT_EQ(move(6, vec3(6.f, 2.f, 0.f)), 2u);
+    EXPECT_EQ(move(0, vec3(0.f, 1.f, 0.f)), 1u);
+    EXPECT_EQ(move(12, vec3(12.f, 3.f, 0.f)), 1u);
+
+    // the same samples as tessellating the moved points from scratch
+    BezierSpline fresh(points, 10);
+    fresh.tessellate();
+    for (size_t i = 0; i < fresh.samples().size(); ++i) {
+        EXPECT_EQ(spline.samples().x()[i], fresh.samples().x()[i]) << i;
+        EXPECT_EQ(spline.samples().y()[i], fresh.samples().y()[i]) << i;
+    }
+    // and the curves' own points at the sample positions
+    for (size_t s = 0; s < spline.segmentCount(); ++s) {
+        const vec3 mid = interpolate(spline.segment(s), 0.5f);
+        EXPECT_NEAR(spline.samples().x()[s * 10 + 5], mid.x, 1e-5f);
+        EXPECT_NEAR(spline.samples().y()[s * 10 + 5], mid.y, 1e-5f);
+    }
+    EXPECT_EQ(spline.samples().y()[40], 3.f);
+}
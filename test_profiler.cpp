@@ -0,0 +1,236 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "profiler/ChromeTrace.h"
+#include "profiler/Profiler.h"
+
+namespace {
+
+void busy(uint64_t ns)
+{
+    const uint64_t end = profiler::now() + ns;
+    while (profiler::now() < end) {
+    }
+}
+
+// the events of the calling thread since `since`
+std::vector<profiler::Event> recorded(uint64_t since)
+{
+    std::vector<profiler::Event> events;
+    profiler::threadBuffer().copy(since, events);
+    return events;
+}
+
+size_t occurrences(const std::string& text, const std::string& what)
+{
+    size_t count = 0;
+    for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+        ++count;
+    return count;
+}
+
+} // namespace
+
+TEST(ProfilerTest, NestedScopes) {
+    profiler::beginFrame();
+    {
+        PROFILE_SCOPE("outer");
+        for (int i = 0; i < 2; ++i) {
+            PROFILE_SCOPE("inner");
+            busy(20000);
+        }
+    }
+    profiler::beginFrame();
+
+    std::vector<profiler::Frame> frames = profiler::frames(2);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[1].end, 0u);
+    EXPECT_EQ(frames[0].end, frames[1].begin);
+    frames.pop_back();
+
+    const uint32_t thread = profiler::threadBuffer().index();
+    std::vector<profiler::Event> events;
+    for (const profiler::Event& e : profiler::collect(frames[0].begin, frames[0].end))
+        if (e.thread == thread)
+            events.push_back(e);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_STREQ(events[0].name, "outer");
+    EXPECT_EQ(events[0].depth, 0u);
+    for (int i = 1; i < 3; ++i) {
+        EXPECT_STREQ(events[i].name, "inner");
+        EXPECT_EQ(events[i].depth, 1u);
+        EXPECT_GE(events[i].begin, events[0].begin);
+        EXPECT_LE(events[i].end, events[0].end);
+        EXPECT_GE(events[i].end - events[i].begin, 20000u);
+    }
+    EXPECT_LE(events[1].end, events[2].begin);
+
+    const std::vector<profiler::ScopeStats> stats = profiler::scopeStats(frames);
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_STREQ(stats[0].name, "outer");
+    EXPECT_EQ(stats[0].calls, 1u);
+    EXPECT_STREQ(stats[1].name, "inner");
+    EXPECT_EQ(stats[1].calls, 2u);
+    EXPECT_GE(stats[1].minMs, 0.04);
+    EXPECT_EQ(stats[1].minMs, stats[1].maxMs);
+    EXPECT_GE(stats[0].avgMs, stats[1].avgMs);
+}
+
+TEST(ProfilerTest, Disabled) {
+    const uint64_t since = profiler::now();
+    profiler::setEnabled(false);
+    {
+        PROFILE_SCOPE("off");
+    }
+    profiler::setEnabled(true);
+    EXPECT_TRUE(recorded(since).empty());
+    EXPECT_EQ(profiler::threadBuffer().depth, 0u);
+}
+
+TEST(ProfilerTest, RingKeepsNewest) {
+    std::thread([] {
+        profiler::setThreadName("ring");
+        const uint64_t since = profiler::now();
+        const size_t count = profiler::ThreadBuffer::CAPACITY + 10;
+        for (size_t i = 0; i < count; ++i) {
+            PROFILE_SCOPE("tick");
+        }
+
+        const std::vector<profiler::Event> events = recorded(since);
+        // one slot is always reserved for the write in flight
+        ASSERT_EQ(events.size(), profiler::ThreadBuffer::CAPACITY - 1);
+        for (size_t i = 1; i < events.size(); ++i)
+            EXPECT_LE(events[i - 1].end, events[i].begin);
+        EXPECT_EQ(profiler::threadBuffer().name(), "ring");
+    }).join();
+}
+
+TEST(ProfilerTest, CopyWhileRecording) {
+    // events whose fields all derive from one number, so a torn copy shows
+    const auto consistent = [](const profiler::Event& e) {
+        return e.end == 2 * e.begin && e.depth == uint32_t(e.begin) && std::strcmp(e.name, "wrap") == 0;
+    };
+
+    std::atomic<const profiler::ThreadBuffer*> buffer{ nullptr };
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        profiler::ThreadBuffer& b = profiler::threadBuffer();
+        buffer.store(&b, std::memory_order_release);
+        for (uint64_t i = 1; i <= 16 * profiler::ThreadBuffer::CAPACITY; ++i)
+            b.push({ "wrap", i, 2 * i, uint32_t(i), b.index() });
+        done.store(true, std::memory_order_release);
+    });
+
+    while (!buffer.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    std::vector<profiler::Event> events;
+    size_t copies = 0;
+    while (!done.load(std::memory_order_acquire) || copies == 0) {
+        events.clear();
+        buffer.load()->copy(0, events);
+        for (size_t i = 0; i < events.size(); ++i) {
+            ASSERT_TRUE(consistent(events[i]));
+            if (i > 0) {
+                ASSERT_EQ(events[i].begin, events[i - 1].begin + 1);
+            }
+        }
+        ++copies;
+    }
+    writer.join();
+}
+
+TEST(ProfilerTest, Threads) {
+    const uint64_t since = profiler::now();
+    uint32_t worker = 0;
+    std::thread([&] {
+        profiler::setThreadName("worker");
+        worker = profiler::threadBuffer().index();
+        PROFILE_SCOPE("job");
+    }).join();
+
+    const std::vector<const profiler::ThreadBuffer*> threads = profiler::threads();
+    ASSERT_LT(worker, threads.size());
+    EXPECT_EQ(threads[worker]->name(), "worker");
+    EXPECT_NE(worker, profiler::threadBuffer().index());
+
+    size_t jobs = 0;
+    for (const profiler::Event& e : profiler::collect(since, profiler::now())) {
+        if (std::strcmp(e.name, "job") == 0) {
+            EXPECT_EQ(e.thread, worker);
+            ++jobs;
+        }
+    }
+    EXPECT_EQ(jobs, 1u);
+}
+
+TEST(ProfilerTest, ChromeTraceFormat) {
+    const uint32_t thread = profiler::threadBuffer().index();
+    profiler::Trace trace;
+    trace.frames.push_back({ 7, 1000, 11000, });
+    trace.events.push_back({ "a\"b", 2000, 3500, 0, thread });
+    trace.counters.push_back({ "vertices", 4000, 42, thread });
+
+    std::ostringstream out;
+    profiler::writeChromeTrace(out, trace);
+    const std::string json = out.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+
+    // times in microseconds from the earliest timestamp
+    EXPECT_EQ(occurrences(json, "\"name\":\"frame 7\",\"pid\":1,\"tid\":65535,\"ts\":0.000,\"dur\":10.000"), 1u);
+    EXPECT_EQ(occurrences(json, "{\"ph\":\"X\",\"name\":\"a\\\"b\",\"pid\":1,\"tid\":"
+        + std::to_string(thread) + ",\"ts\":1.000,\"dur\":1.500}"), 1u);
+    EXPECT_EQ(occurrences(json, "{\"ph\":\"C\",\"name\":\"vertices\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"ts\":3.000,\"args\":{\"value\":42}}"), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"thread_name\""), 2u);
+
+    // values read back exactly, large byte counts and fractions alike
+    for (double value : { 1234567891.0, 0.1, 1.0 / 3.0 }) {
+        profiler::Trace one;
+        one.counters.push_back({ "frame arena", 0, value, thread });
+        std::ostringstream text;
+        profiler::writeChromeTrace(text, one);
+        const std::string s = text.str();
+        const size_t at = s.find("\"value\":");
+        ASSERT_NE(at, std::string::npos);
+        EXPECT_EQ(std::strtod(s.c_str() + at + 8, nullptr), value);
+    }
+}
+
+TEST(ProfilerTest, ChromeTraceCapture) {
+    const std::string path = (std::filesystem::temp_directory_path() / "profiler_capture.json").string();
+    std::filesystem::remove(path);
+
+    profiler::beginFrame();
+    {
+        PROFILE_SCOPE("before");
+    }
+    profiler::captureChromeTrace(2, path);
+    EXPECT_TRUE(profiler::captureActive());
+    for (int frame = 0; frame < 3; ++frame) {
+        profiler::beginFrame();
+        PROFILE_SCOPE("captured");
+        PROFILE_COUNTER("frame", frame);
+    }
+    profiler::beginFrame();
+    EXPECT_FALSE(profiler::captureActive());
+
+    // the running frame when the capture started and the one after it
+    std::ifstream file(path);
+    ASSERT_TRUE(file.good());
+    std::stringstream text;
+    text << file.rdbuf();
+    const std::string json = text.str();
+    EXPECT_EQ(occurrences(json, "\"name\":\"before\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"captured\""), 1u);
+    EXPECT_EQ(occurrences(json, "{\"ph\":\"C\",\"name\":\"frame\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"frame "), 2u);
+    file.close();
+    std::filesystem::remove(path);
+}
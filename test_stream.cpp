@@ -0,0 +1,138 @@
+#include <math.h>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "gszauer/VecStream.h"
+
+class StreamTest : public testing::Test {
+protected:
+    // 37 elements: nine SIMD blocks and a scalar tail
+    static constexpr size_t COUNT = 37;
+
+    void SetUp() override {
+        std::mt19937 gen(3);
+        std::uniform_real_distribution<float> dist(-2.f, 2.f);
+        for (size_t i = 0; i < COUNT; ++i) {
+            a.push_back(vec3(dist(gen), dist(gen), dist(gen)));
+            b.push_back(vec3(dist(gen), dist(gen), dist(gen)));
+        }
+        a[5] = vec3(0.f);
+        gszauer::fromAoS(a, sa);
+        gszauer::fromAoS(b, sb);
+    }
+
+    static void expectNear(const vec3& l, const vec3& r) {
+        EXPECT_NEAR(l.x, r.x, 1e-5f);
+        EXPECT_NEAR(l.y, r.y, 1e-5f);
+        EXPECT_NEAR(l.z, r.z, 1e-5f);
+    }
+
+    std::vector<vec3> a, b;
+    gszauer::Vec3Stream sa, sb;
+};
+
+TEST_F(StreamTest, Layout) {
+    EXPECT_EQ(sa.size(), COUNT);
+    for (size_t c = 0; c < 3; ++c)
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(sa.component(c)) % gszauer::STREAM_ALIGN, 0u);
+
+    std::vector<vec3> back(COUNT);
+    gszauer::toAoS(sa, back);
+    for (size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(back[i].x, a[i].x);
+        EXPECT_EQ(back[i].y, a[i].y);
+        EXPECT_EQ(back[i].z, a[i].z);
+    }
+
+    gszauer::set(sa, 3, vec3(7.f, 8.f, 9.f));
+    EXPECT_EQ(gszauer::get(sa, 3).y, 8.f);
+}
+
+TEST_F(StreamTest, Arithmetic) {
+    gszauer::Vec3Stream r;
+    gszauer::add(sa, sb, r);
+    for (size_t i = 0; i < COUNT; ++i)
+        expectNear(gszauer::get(r, i), a[i] + b[i]);
+
+    gszauer::scale(sa, 3.f, r);
+    for (size_t i = 0; i < COUNT; ++i)
+        expectNear(gszauer::get(r, i), a[i] * 3.f);
+
+    gszauer::lerp(sa, sb, 0.25f, r);
+    for (size_t i = 0; i < COUNT; ++i)
+        expectNear(gszauer::get(r, i), gszauer::lerp(a[i], b[i], 0.25f));
+
+    // in place, out aliasing an input
+    r = sa;
+    gszauer::cross(r, sb, r);
+    for (size_t i = 0; i < COUNT; ++i)
+        expectNear(gszauer::get(r, i), gszauer::cross(a[i], b[i]));
+
+    std::vector<float> d(COUNT);
+    gszauer::dot(sa, sb, d.data());
+    for (size_t i = 0; i < COUNT; ++i)
+        EXPECT_NEAR(d[i], gszauer::dot(a[i], b[i]), 1e-5f);
+}
+
+TEST_F(StreamTest, Normalize) {
+    gszauer::normalize(sa);
+    for (size_t i = 0; i < COUNT; ++i) {
+        if (i == 5)
+            expectNear(gszauer::get(sa, i), vec3(0.f));
+        else
+            expectNear(gszauer::get(sa, i), gszauer::normalized(a[i]));
+    }
+
+    gszauer::normalize(sb, gszauer::NormalizePolicy::Fast);
+    for (size_t i = 0; i < COUNT; ++i) {
+        expectNear(gszauer::get(sb, i), gszauer::normalized(b[i]));
+        EXPECT_NEAR(gszauer::len(gszauer::get(sb, i)), 1.f, 1e-6f);
+    }
+}
+
+TEST_F(StreamTest, Transform) {
+    const mat4 m(
+        0.f, 2.f, 0.f, 0.f,
+        -1.f, 0.f, 0.f, 0.f,
+        0.f, 0.f, 3.f, 0.f,
+        1.f, -2.f, 3.f, 1.f);
+
+    gszauer::Vec3Stream r;
+    gszauer::transformPoints(m, sa, r);
+    for (size_t i = 0; i < COUNT; ++i) {
+        const vec4 p = m * vec4(a[i].x, a[i].y, a[i].z, 1.f);
+        expectNear(gszauer::get(r, i), vec3(p.x, p.y, p.z));
+    }
+
+    std::vector<vec4> a4;
+    for (const vec3& v : a)
+        a4.push_back(vec4(v.x, v.y, v.z, 0.5f));
+    gszauer::Vec4Stream s4;
+    gszauer::fromAoS(a4, s4);
+    gszauer::transform(m, s4, s4);
+    for (size_t i = 0; i < COUNT; ++i) {
+        const vec4 p = m * a4[i];
+        const vec4 q = gszauer::get(s4, i);
+        for (size_t k = 0; k < 4; ++k)
+            EXPECT_NEAR(q[k], p[k], 1e-5f);
+    }
+}
+
+TEST_F(StreamTest, Interpolate) {
+    gszauer::Bezier<vec3> curve;
+    curve.P1 = vec3(-5.f, 0.f, 1.f);
+    curve.C1 = vec3(-2.f, 4.f, 0.f);
+    curve.P2 = vec3(5.f, 0.f, -1.f);
+    curve.C2 = vec3(2.f, -4.f, 2.f);
+
+    std::vector<float> t(COUNT);
+    for (size_t i = 0; i < COUNT; ++i)
+        t[i] = float(i) / float(COUNT - 1);
+
+    gszauer::Vec3Stream r;
+    gszauer::interpolate(curve, t, r);
+    ASSERT_EQ(r.size(), COUNT);
+    for (size_t i = 0; i < COUNT; ++i)
+        expectNear(gszauer::get(r, i), gszauer::interpolate(curve, t[i]));
+}
@@ -0,0 +1,77 @@
+#include <math.h>
+#include <gtest/gtest.h>
+
+#include "gszauer/Transform.h"
+
+class TransformTest : public testing::Test {
+protected:
+    static vec3 origin(const mat4& m) {
+        return vec3(m[3].x, m[3].y, m[3].z);
+    }
+};
+
+TEST_F(TransformTest, ToMat4) {
+    Transform t(vec3(1, 2, 3), angleAxis(3.14159265f / 2, vec3(0, 0, 1)), vec3(2.f));
+    mat4 m = transformToMat4(t);
+
+    // x axis is scaled, turned onto +y, then moved
+    vec4 p = m * vec4(1, 0, 0, 1);
+    EXPECT_NEAR(p.x, 1.f, 1e-5f);
+    EXPECT_NEAR(p.y, 4.f, 1e-5f);
+    EXPECT_NEAR(p.z, 3.f, 1e-5f);
+    EXPECT_EQ(mat4(), transformToMat4(Transform()));
+}
+
+TEST_F(TransformTest, LazyPropagation) {
+    gszauer::TransformHierarchy h;
+    int root = h.add(gszauer::TransformHierarchy::NO_PARENT,
+        Transform(vec3(1, 0, 0), quat(), vec3(1.f)));
+    int child = h.add(root, Transform(vec3(0, 1, 0), quat(), vec3(1.f)));
+    int grandChild = h.add(child, Transform(vec3(0, 0, 1), quat(), vec3(1.f)));
+    int other = h.add(gszauer::TransformHierarchy::NO_PARENT);
+
+    EXPECT_TRUE(h.isDirty());
+    EXPECT_EQ(4u, h.update());
+    EXPECT_FALSE(h.isDirty());
+    EXPECT_EQ(0u, h.update());
+    EXPECT_EQ(vec3(1, 1, 1), origin(h.getWorld(grandChild)));
+
+    // only the edited node and what hangs below it are rebuilt
+    h.setLocal(child, Transform(vec3(0, 2, 0), quat(), vec3(1.f)));
+    EXPECT_EQ(2u, h.update());
+    EXPECT_EQ(vec3(1, 2, 1), origin(h.getWorld(grandChild)));
+    EXPECT_EQ(vec3(1, 0, 0), origin(h.getWorld(root)));
+
+    h.setLocal(other, Transform(vec3(5, 0, 0), quat(), vec3(1.f)));
+    EXPECT_EQ(vec3(5, 0, 0), origin(h.getWorld(other)));
+    EXPECT_FALSE(h.isDirty());
+}
+
+TEST_F(TransformTest, ParallelMatchesSerial) {
+    gszauer::TransformHierarchy serial, parallel;
+    const quat spin = angleAxis(0.1f, vec3(0, 1, 0));
+
+    // interleave several roots so subtrees are not contiguous
+    std::vector<int> roots;
+    for (int i = 0; i < 2000; i++) {
+        int parent = gszauer::TransformHierarchy::NO_PARENT;
+        if (i % 50 != 0)
+            parent = (i % 3 == 0) ? roots[i % roots.size()] : i - 1;
+        Transform t(vec3((float)(i % 7), 0.5f, 0.f), spin, vec3(1.f));
+        int a = serial.add(parent, t);
+        int b = parallel.add(parent, t);
+        EXPECT_EQ(a, b);
+        if (parent == gszauer::TransformHierarchy::NO_PARENT)
+            roots.push_back(a);
+    }
+
+    EXPECT_EQ(serial.update(), parallel.update(4));
+    for (int i = 0; i < (int)serial.size(); i += 37)
+        EXPECT_EQ(serial.getWorld(i), parallel.getWorld(i));
+
+    serial.setLocal(roots[3], Transform());
+    parallel.setLocal(roots[3], Transform());
+    EXPECT_EQ(serial.update(), parallel.update(0));
+    for (int i = 0; i < (int)serial.size(); i++)
+        EXPECT_EQ(serial.getWorld(i), parallel.getWorld(i));
+}
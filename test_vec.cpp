@@ -1,14 +1,65 @@
+#include <array>
 #include <math.h>
 #include <gtest/gtest.h>
 
 #include "gszauer/Vec3.h"
 #include "gszauer/Vec4.h"
+#include "gszauer/Mat4.h"
+#include "gszauer/Quat.h"
 
 class VecTest : public testing::Test {
 protected:
 };
 
+namespace {
+
+// easing curve sampled at compile time
+template <size_t N>
+constexpr std::array<float3, N> bakeCurve(const gszauer::Bezier<float3>& curve)
+{
+    std::array<float3, N> table{};
+    for (size_t i = 0; i < N; ++i)
+        table[i] = gszauer::interpolate(curve, float(i) / float(N - 1));
+    return table;
+}
+
+} // namespace
+
 TEST_F(VecTest, Constexpr) {
+    constexpr float3 a(1.f, 2.f, 3.f);
+    constexpr float3 b(4.f, 5.f, 6.f);
+    static_assert((a + b)[2] == 9.f);
+    static_assert((b / a)[1] == 2.5f);
+    static_assert(gszauer::dot(a, b) == 32.f);
+    static_assert(gszauer::cross(a, b) == float3(-3.f, 6.f, -3.f));
+    static_assert(gszauer::lerp(a, b, 0.5f) == float3(2.5f, 3.5f, 4.5f));
+
+    constexpr double4 v = double4(1, 2, 3, 4) + double4(10);
+    static_assert(v[0] == 11 && v[3] == 14);
+
+    constexpr gszauer::Bezier<float3> ease{
+        float3(0.f), float3(0.f, 1.f, 0.f), float3(1.f), float3(1.f, 0.f, 1.f) };
+    constexpr auto table = bakeCurve<5>(ease);
+    static_assert(table[0] == float3(0.f));
+    static_assert(table[4] == float3(1.f));
+    static_assert(table[2] == gszauer::interpolate(ease, 0.5f));
+
+    constexpr mat4 m = mat4(
+        1.f, 0.f, 0.f, 0.f,
+        0.f, 2.f, 0.f, 0.f,
+        0.f, 0.f, 3.f, 0.f,
+        1.f, 2.f, 3.f, 1.f) * mat4(2.f);
+    static_assert(m[1][1] == 4.f && m[3][2] == 6.f);
+    static_assert((m * vec4(1.f, 1.f, 1.f, 0.5f))[2] == 9.f);
+
+    // 180 degrees around z, then around x
+    constexpr quat rz(0.f, 0.f, 1.f, 0.f);
+    constexpr quat rx(1.f, 0.f, 0.f, 0.f);
+    constexpr quat q = rz * rx;
+    static_assert(q.x == 0.f && q.y == -1.f && q.z == 0.f && q.w == 0.f);
+    static_assert(rz * vec3(1.f, 2.f, 3.f) == vec3(-1.f, -2.f, 3.f));
+
+    EXPECT_EQ(table[1].x, gszauer::interpolate(ease, 0.25f).x);
 }
 
 TEST_F(VecTest, Basics) {